@@ -0,0 +1,346 @@
+/**
+ * @file cppli_bench.cpp
+ * @brief Micro-benchmarks for the parse, lookup, help and registration hot paths.
+ *
+ * Each benchmark repeats one operation until --min-time has elapsed and
+ * reports nanoseconds and heap allocations per operation. Allocations are
+ * counted by replacing the global operator new. Results are written as JSON
+ * (to stdout, or to --output) so they can be compared across releases:
+ *
+ * @code
+ * {"benchmarks": [{"name": "parse", "params": {"flags": 100, "args": 20},
+ *   "iterations": 81920, "ns_per_op": 912.4, "allocs_per_op": 3, "bytes_per_op": 164}]}
+ * @endcode
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cppli.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// The replacement operators below pair malloc with free, which GCC cannot see through.
+#if defined(__GNUC__) && ! defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+namespace {
+	std::atomic<std::uint64_t> allocation_count{0};
+	std::atomic<std::uint64_t> allocation_bytes{0};
+}// namespace
+
+void *operator new(std::size_t size) {
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+	if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+	return ::operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Keep a value alive so the optimizer cannot drop the work producing it.
+	 */
+	template <typename T>
+	void do_not_optimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void *sink;
+		sink = &value;
+#endif
+	}
+
+	struct Param {
+		std::string name;
+		std::size_t value;
+	};
+
+	struct Measurement {
+		std::string name;
+		std::vector<Param> params;
+		std::uint64_t iterations = 0;
+		double ns_per_op = 0;
+		double allocs_per_op = 0;
+		double bytes_per_op = 0;
+	};
+
+	struct Options {
+		std::chrono::nanoseconds min_time{std::chrono::milliseconds(200)};
+		std::string filter;
+	};
+
+	/**
+	 * @brief Run op in doubling batches until a batch takes at least min_time.
+	 */
+	template <typename Op>
+	Measurement measure(const Options &options, std::string name, std::vector<Param> params, Op &&op) {
+		Measurement result{std::move(name), std::move(params)};
+
+		op();// warm up caches and any lazily built state
+
+		for (std::uint64_t batch = 1;; batch *= 2) {
+			const auto allocs_before = allocation_count.load(std::memory_order_relaxed);
+			const auto bytes_before = allocation_bytes.load(std::memory_order_relaxed);
+			const auto start = Clock::now();
+			for (std::uint64_t i = 0; i < batch; ++i) {
+				op();
+			}
+			const auto elapsed = Clock::now() - start;
+
+			if (elapsed >= options.min_time || batch >= (std::uint64_t{1} << 40)) {
+				const auto count = static_cast<double>(batch);
+				result.iterations = batch;
+				result.ns_per_op = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / count;
+				result.allocs_per_op = static_cast<double>(allocation_count.load(std::memory_order_relaxed) - allocs_before) / count;
+				result.bytes_per_op = static_cast<double>(allocation_bytes.load(std::memory_order_relaxed) - bytes_before) / count;
+				return result;
+			}
+		}
+	}
+
+	std::string flag_name(std::size_t i) {
+		return "flag-" + std::to_string(i);
+	}
+
+	/**
+	 * @brief A parser with flag_count int flags named flag-0, flag-1, ...
+	 */
+	cli::Parser make_parser(std::size_t flag_count) {
+		cli::Parser parser("bench", "Benchmark parser", "1.0.0");
+		for (std::size_t i = 0; i < flag_count; ++i) {
+			parser.add_flag<int>(flag_name(i), "Benchmark flag").set_default_value(0);
+		}
+		return parser;
+	}
+
+	/**
+	 * @brief arg_count tokens of `--flag-N value` pairs cycling through the flags.
+	 */
+	std::vector<std::string> make_args(std::size_t flag_count, std::size_t arg_count) {
+		std::vector<std::string> args;
+		args.reserve(arg_count);
+		for (std::size_t i = 0; args.size() < arg_count; ++i) {
+			args.push_back("--" + flag_name(i % flag_count));
+			args.push_back(std::to_string(i));
+		}
+		args.resize(arg_count);
+		return args;
+	}
+
+	std::vector<std::string_view> as_views(const std::vector<std::string> &args) {
+		return {args.begin(), args.end()};
+	}
+
+	void bench_parse(const Options &options, std::vector<Measurement> &out) {
+		for (const std::size_t flags: {10, 100, 1000}) {
+			cli::Parser parser = make_parser(flags);
+			const cli::ParserSpec spec = parser.freeze();
+
+			for (const std::size_t arg_count: {2, 20, 200}) {
+				const auto args = make_args(flags, arg_count);
+				const auto views = as_views(args);
+				const std::span<const std::string_view> span(views);
+
+				out.push_back(measure(options, "parse", {{"flags", flags}, {"args", arg_count}}, [&] {
+					auto result = parser.parse(span);
+					do_not_optimize(result);
+				}));
+				out.push_back(measure(options, "spec_parse", {{"flags", flags}, {"args", arg_count}}, [&] {
+					auto result = spec.parse(span);
+					do_not_optimize(result);
+				}));
+			}
+		}
+	}
+
+	void bench_subcommand_depth(const Options &options, std::vector<Measurement> &out) {
+		for (const std::size_t depth: {1, 4, 16}) {
+			cli::Parser parser("bench");
+			std::vector<std::string> args;
+
+			cli::Subcommand *current = &parser.add_subcommand("level-0", "Level 0");
+			args.push_back("level-0");
+			for (std::size_t i = 1; i < depth; ++i) {
+				std::string name = "level-" + std::to_string(i);
+				current = &current->add_subcommand(name, "Nested level");
+				args.push_back(std::move(name));
+			}
+			current->add_flag<int>("value", "Leaf flag");
+			args.push_back("--value");
+			args.push_back("42");
+
+			const auto views = as_views(args);
+			const std::span<const std::string_view> span(views);
+			out.push_back(measure(options, "subcommand_parse", {{"depth", depth}}, [&] {
+				auto result = parser.parse(span);
+				do_not_optimize(result);
+			}));
+		}
+	}
+
+	void bench_lookup(const Options &options, std::vector<Measurement> &out) {
+		for (const std::size_t flags: {10, 1000}) {
+			cli::Parser parser = make_parser(flags);
+			const std::string present = flag_name(flags / 2);
+
+			out.push_back(measure(options, "get", {{"flags", flags}}, [&] {
+				auto value = parser.get<int>(present);
+				do_not_optimize(value);
+			}));
+			out.push_back(measure(options, "has", {{"flags", flags}}, [&] {
+				bool found = parser.has(present);
+				do_not_optimize(found);
+			}));
+			out.push_back(measure(options, "has_missing", {{"flags", flags}}, [&] {
+				bool found = parser.has("no-such-flag");
+				do_not_optimize(found);
+			}));
+		}
+	}
+
+	void bench_help(const Options &options, std::vector<Measurement> &out) {
+		for (const std::size_t flags: {10, 100, 1000}) {
+			cli::Parser parser = make_parser(flags);
+			auto &toggled = parser.add_flag<bool>("toggled", "Flag changed to force a re-render");
+
+			out.push_back(measure(options, "help_cached", {{"flags", flags}}, [&] {
+				std::string help = parser.generate_help();
+				do_not_optimize(help);
+			}));
+
+			std::vector<char> buffer(parser.generate_help().size());
+			out.push_back(measure(options, "help_format_to", {{"flags", flags}}, [&] {
+				char *end = parser.format_to(buffer.data());
+				do_not_optimize(end);
+			}));
+
+			bool required = false;
+			out.push_back(measure(options, "help_render", {{"flags", flags}}, [&] {
+				toggled.set_required(required = ! required);
+				std::string help = parser.generate_help();
+				do_not_optimize(help);
+			}));
+		}
+	}
+
+	void bench_registration(const Options &options, std::vector<Measurement> &out) {
+		for (const std::size_t flags: {10, 100, 1000}) {
+			std::vector<std::string> names;
+			for (std::size_t i = 0; i < flags; ++i) {
+				names.push_back(flag_name(i));
+			}
+
+			Measurement m = measure(options, "add_flag", {{"flags", flags}}, [&] {
+				cli::Parser parser("bench");
+				for (const auto &name: names) {
+					parser.add_flag<int>(name, "Benchmark flag");
+				}
+				do_not_optimize(parser);
+			});
+
+			// Report the cost of one add_flag<T> call.
+			const auto per_flag = static_cast<double>(flags);
+			m.ns_per_op /= per_flag;
+			m.allocs_per_op /= per_flag;
+			m.bytes_per_op /= per_flag;
+			out.push_back(std::move(m));
+		}
+	}
+
+	void write_json(std::FILE *stream, const std::vector<Measurement> &results) {
+		std::fputs("{\n  \"benchmarks\": [\n", stream);
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			const auto &m = results[i];
+			std::fprintf(stream, "    {\"name\": \"%s\", \"params\": {", m.name.c_str());
+			for (std::size_t p = 0; p < m.params.size(); ++p) {
+				std::fprintf(stream, "%s\"%s\": %zu", p == 0 ? "" : ", ", m.params[p].name.c_str(), m.params[p].value);
+			}
+			std::fprintf(stream, "}, \"iterations\": %llu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f}%s\n",
+						 static_cast<unsigned long long>(m.iterations), m.ns_per_op, m.allocs_per_op, m.bytes_per_op, i + 1 < results.size() ? "," : "");
+		}
+		std::fputs("  ]\n}\n", stream);
+	}
+}// namespace
+
+int main(int argc, char **argv) {
+	cli::Parser parser("cppli_bench", "Benchmarks for the cppli hot paths; prints JSON results");
+	parser.add_flag<std::chrono::milliseconds>("min-time", "Minimum measured time per benchmark").set_default_value(std::chrono::milliseconds(200));
+	parser.add_flag<std::string>("filter", "Only run suites (parse, subcommand, lookup, help, add_flag) whose name contains this text").set_short_name("f");
+	parser.add_flag<std::string>("output", "Write JSON here instead of stdout").set_short_name("o");
+	parser.add_help_flag();
+
+	auto parsed = parser.parse(argc, argv);
+	if (! parsed) {
+		std::fprintf(stderr, "%s\n", parsed.error().message().c_str());
+		return 1;
+	}
+	if (parser.has("help")) {
+		parser.write_help(stdout);
+		return 0;
+	}
+
+	Options options;
+	options.min_time = *parser.get<std::chrono::milliseconds>("min-time");
+	options.filter = parser.get<std::string>("filter").value_or("");
+
+	using Suite = void (*)(const Options &, std::vector<Measurement> &);
+	const std::pair<std::string_view, Suite> suites[] = {
+		{"parse", bench_parse},
+		{"subcommand", bench_subcommand_depth},
+		{"lookup", bench_lookup},
+		{"help", bench_help},
+		{"add_flag", bench_registration},
+	};
+
+	std::vector<Measurement> results;
+	for (const auto &[name, run]: suites) {
+		if (options.filter.empty() || name.find(options.filter) != std::string_view::npos) {
+			run(options, results);
+		}
+	}
+
+	std::FILE *stream = stdout;
+	if (auto path = parser.get<std::string>("output")) {
+		stream = std::fopen(path->c_str(), "w");
+		if (stream == nullptr) {
+			std::fprintf(stderr, "Cannot open %s\n", path->c_str());
+			return 1;
+		}
+	}
+	write_json(stream, results);
+	if (stream != stdout) {
+		std::fclose(stream);
+	}
+	return 0;
+}
@@ -1,12 +1,28 @@
 #ifndef CPPLI_HPP
 #define CPPLI_HPP
 
+#include "cppli_completion.hpp"
+#include "cppli_config.hpp"
+#include "cppli_dump.hpp"
 #include "cppli_error.hpp"
+#include "cppli_executor.hpp"
+#include "cppli_help.hpp"
+#include "cppli_memory.hpp"
+#include "cppli_name_table.hpp"
+#include "cppli_observer.hpp"
+#include "cppli_response_file.hpp"
+#include "cppli_snapshot.hpp"
+#include "cppli_spec.hpp"
+#include "cppli_storage.hpp"
 #include "cppli_subcommand.hpp"
 #include "cppli_types.hpp"
+#include "cppli_validators.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <iostream>
-#include <map>
 #include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -32,18 +48,51 @@ namespace cli {
 	 */
 	class Parser {
 	  public:
-		Parser(std::string app_name, std::string description = "", std::string version = "");
+		Parser(std::string app_name, detail::HelpText description = "", std::string version = "");
 
 		template <typename T = std::string>
-		TypedFlag<T> &add_flag(std::string long_name, std::string description);
+		TypedFlag<T> &add_flag(std::string long_name, detail::HelpText description);
 
 		Parser &add_help_flag();
 		Parser &add_version_flag();
 
 		template <typename T = std::string>
-		TypedPositional<T> &add_positional(std::string name, std::string description, bool required = true);
+		TypedPositional<T> &add_positional(std::string name, detail::HelpText description, bool required = true);
 
-		Parser &add_example(std::string description, std::string command);
+		Parser &add_example(detail::HelpText description, detail::HelpText command);
+
+		/**
+		 * @brief Capture every token after the positionals as one pass-through list.
+		 *
+		 * Parsing stops at the first token past the declared positionals (use
+		 * `--` to pass tokens that look like flags); that token and everything
+		 * after it are left unparsed and returned by get_rest(), for example to
+		 * hand a child command line to execvp. Without a rest positional, such
+		 * a token is an Error::too_many_positionals().
+		 *
+		 * Example:
+		 * @code
+		 * parser.add_rest_positional("command");
+		 * // myapp --verbose -- make -j8
+		 * auto child = parser.get_rest(); // {"make", "-j8"}
+		 * @endcode
+		 *
+		 * @param name Name shown in the usage line.
+		 * @return Parser& for chaining.
+		 */
+		Parser &add_rest_positional(std::string name);
+
+		/**
+		 * @brief Tokens captured by add_rest_positional(), empty if none.
+		 *
+		 * The views point into the arguments given to parse() (or into their
+		 * `@file` expansion, which the parser keeps alive), without copies. They
+		 * stay valid until the next parse() or reset(), as long as the
+		 * arguments passed to parse() do.
+		 */
+		[[nodiscard]] std::span<const std::string_view> get_rest() const noexcept {
+			return rest_;
+		}
 
 		/**
 		 * @brief Add a subcommand to the parser.
@@ -51,7 +100,29 @@ namespace cli {
 		 * @param description Brief description for help.
 		 * @return Subcommand& Reference for configuration.
 		 */
-		Subcommand &add_subcommand(std::string name, std::string description);
+		Subcommand &add_subcommand(std::string name, detail::HelpText description);
+
+		/**
+		 * @brief Add a subcommand whose flags are defined only when it is needed.
+		 *
+		 * Only the name and description are stored up front, which is enough
+		 * for the SUBCOMMANDS section of the help. The factory runs once, when
+		 * parse() selects the subcommand, get_subcommand() returns it, or
+		 * freeze() copies the tree.
+		 *
+		 * Example:
+		 * @code
+		 * parser.add_lazy_subcommand("build", "Build the project", [](cli::Subcommand &build) {
+		 *     build.add_flag<bool>("release", "Build in release mode");
+		 * });
+		 * @endcode
+		 *
+		 * @param name Subcommand name (used on command line).
+		 * @param description Brief description for help.
+		 * @param factory Called with the empty subcommand to add its flags, positionals and nested subcommands.
+		 * @return Parser& for chaining.
+		 */
+		Parser &add_lazy_subcommand(std::string name, detail::HelpText description, SubcommandFactory factory);
 
 		/**
 		 * @brief Set whether at least one subcommand is required.
@@ -60,12 +131,103 @@ namespace cli {
 		 */
 		Parser &require_subcommand(int count = -1);
 
+		/**
+		 * @brief Accept several subcommands in one invocation: `tool fetch origin build --release push`.
+		 *
+		 * A subcommand's arguments end at the first token past its positionals
+		 * that names another top-level subcommand, which then starts. Each
+		 * subcommand may appear once. Callbacks run after the whole command line
+		 * has parsed and every subcommand's requirements hold, in command-line
+		 * order (see set_executor and Subcommand::set_concurrent).
+		 *
+		 * With require_subcommand(count) and count > 0, exactly count
+		 * subcommands must be given.
+		 *
+		 * @param chain True (default true) to allow chaining.
+		 * @return Parser& for chaining.
+		 */
+		Parser &chain_subcommands(bool chain = true) noexcept {
+			chain_subcommands_ = chain;
+			return *this;
+		}
+
+		/**
+		 * @brief Accept unambiguous prefixes of long flags and subcommand names.
+		 *
+		 * With this set, `--verb` reads as `--verbose` and `rem` as `remote`
+		 * when no other name starts the same way; a prefix shared by several
+		 * flags fails with Error::ambiguous_flag. Exact names always win. The
+		 * setting covers every subcommand of this parser and is copied by
+		 * freeze().
+		 *
+		 * @param allow True (default true) to accept abbreviations.
+		 * @return Parser& for chaining.
+		 */
+		Parser &allow_abbreviations(bool allow = true) noexcept {
+			abbreviations_ = allow;
+			return *this;
+		}
+
+		[[nodiscard]] bool abbreviations_allowed() const noexcept {
+			return abbreviations_;
+		}
+
+		/**
+		 * @brief Run subcommand callbacks on an executor instead of inside parse().
+		 *
+		 * parse() then posts the callbacks and returns; wait on callbacks()
+		 * for them. Chained subcommands run as stages in command-line order:
+		 * each stage starts when the previous one has finished, and adjacent
+		 * subcommands marked Subcommand::set_concurrent share one stage. Posted
+		 * callbacks are not reported to the observer.
+		 *
+		 * The executor is not owned. It and this parser must outlive the
+		 * callbacks, and the parser must not be parsed again or reset() until
+		 * they have finished.
+		 *
+		 * @param executor Executor, or nullptr to run callbacks inside parse().
+		 * @return Parser& for chaining.
+		 */
+		Parser &set_executor(Executor *executor) noexcept {
+			executor_ = executor;
+			return *this;
+		}
+
+		/**
+		 * @brief Completion of the callbacks started by the last parse().
+		 */
+		[[nodiscard]] CallbackHandle callbacks() const noexcept {
+			return callbacks_;
+		}
+
 		/**
 		 * @brief Get the name of the selected subcommand, if any.
+		 *
+		 * With chained subcommands, this is the first of them.
+		 *
 		 * @return std::optional<std::string> Subcommand name or nullopt.
 		 */
 		[[nodiscard]] std::optional<std::string> get_selected_subcommand() const;
 
+		/**
+		 * @brief Names of every selected top-level subcommand, in command-line order.
+		 */
+		[[nodiscard]] std::vector<std::string_view> get_selected_subcommands() const;
+
+		/**
+		 * @brief Report parse stages (conversion, validation, callbacks...) to an observer.
+		 *
+		 * Subcommands without an observer of their own report to this one. The
+		 * observer is not owned and must outlive every parse() call that uses it.
+		 *
+		 * @param observer Observer, or nullptr to stop reporting.
+		 * @return Parser& for chaining.
+		 */
+		Parser &set_observer(ParseObserver *observer) noexcept {
+			observer_ = observer;
+			return *this;
+		}
+
 		/**
 		 * @brief Access a subcommand by name.
 		 * @param name Subcommand name.
@@ -73,12 +235,176 @@ namespace cli {
 		 */
 		[[nodiscard]] Subcommand *get_subcommand(std::string_view name);
 
+		/**
+		 * @brief Enable the hidden `__complete <words...>` mode used by completion scripts.
+		 *
+		 * When the first argument is `__complete`, parse() prints the candidates
+		 * for the last word (see complete()) one per line to stdout, sets
+		 * completion_requested() and returns ok() without parsing anything.
+		 *
+		 * Example:
+		 * @code
+		 * parser.add_completion();
+		 * auto result = parser.parse(argc, argv);
+		 * if (parser.completion_requested()) {
+		 *     return 0;
+		 * }
+		 * @endcode
+		 *
+		 * @return Parser& for chaining.
+		 */
+		Parser &add_completion();
+
+		/**
+		 * @brief Whether the last parse() answered a `__complete` request.
+		 */
+		[[nodiscard]] bool completion_requested() const noexcept {
+			return completion_requested_;
+		}
+
+		/**
+		 * @brief Completion candidates for the last of the typed words.
+		 *
+		 * Only the subcommands named along the typed path are visited (and,
+		 * if lazy, defined). The last word selects what is offered: flag
+		 * names after `-`, choices after a flag that takes a value or in
+		 * `--flag=`, and subcommand names otherwise.
+		 *
+		 * @param words Words after the program name; the last is the one being completed (may be empty).
+		 * @return std::vector<std::string> Sorted candidates starting with the last word.
+		 */
+		[[nodiscard]] std::vector<std::string> complete(std::span<const std::string_view> words);
+
+		/**
+		 * @brief Completion script for a shell that calls back into `app __complete`.
+		 * @param shell Target shell.
+		 * @return std::string Script to source from the shell's startup or completion directory.
+		 */
+		[[nodiscard]] std::string completion_script(CompletionShell shell) const;
+
 		[[nodiscard]] Result<void> parse(int argc, char **argv);
 		[[nodiscard]] Result<void> parse(const std::vector<std::string> &args);
 
+		/**
+		 * @brief Parse a sequence of C strings without copying them.
+		 *
+		 * Unlike parse(int, char **), the span is taken as-is: the first element
+		 * is treated as an argument, not as the program name.
+		 *
+		 * @param args Argument tokens (e.g. std::span(argv + 1, argc - 1)).
+		 * @return Result<void> ok() on success, err(Error) otherwise.
+		 */
+		[[nodiscard]] Result<void> parse(std::span<const char *const> args);
+
+		/**
+		 * @brief Parse a sequence of string views without copying them.
+		 *
+		 * Tokens are kept as views until ValueConverter<T>::from_string, so only
+		 * flags that store a std::string allocate.
+		 *
+		 * Every parse overload expands `@file` response-file arguments (before
+		 * any `--`): the file is memory-mapped and split with shell-style quoting
+		 * into views of the mapping, and its tokens are parsed in place of the
+		 * `@file` argument, including by subcommands. An `@name` that cannot be
+		 * opened is kept as a literal argument.
+		 *
+		 * The file's text is not copied, but the expanded command line is
+		 * still collected before parsing: one std::string_view (16 bytes on
+		 * 64-bit targets) per token, plus a copy of each token that needs
+		 * unescaping. For a file of many short tokens, that array can be
+		 * larger than the file itself. Expansion is not streamed into the
+		 * tokenizer, because parsing needs random access to the tokens for
+		 * flag values, subcommands and the rest positional.
+		 *
+		 * @param args Argument tokens; must outlive the call.
+		 * @return Result<void> ok() on success, err(Error) otherwise.
+		 */
+		[[nodiscard]] Result<void> parse(std::span<const std::string_view> args);
+
+		/**
+		 * @brief Fill flags from a key=value / INI config file.
+		 *
+		 * The file is memory-mapped and scanned once: each key is looked up in
+		 * the flag table and its value converted straight into the flag, with
+		 * nothing collected in between. Keys before any section are this
+		 * parser's flags; `[name]` switches to a subcommand's flags, and
+		 * `[remote.add]` to a nested one. Lines starting with `#` or `;` are
+		 * comments. A repeatable flag may appear on several lines.
+		 *
+		 * Call it before parse(): values from the file rank below the
+		 * environment (TypedFlag::set_env) and the command line, and above
+		 * defaults. reset() forgets them, like any parsed value.
+		 *
+		 * Example:
+		 * @code
+		 * // app.ini
+		 * //   port = 8080
+		 * //   [build]
+		 * //   target = "release"
+		 * if (auto loaded = parser.load_config("app.ini"); ! loaded) {
+		 *     std::cerr << loaded.error().message() << std::endl;
+		 * }
+		 * auto result = parser.parse(argc, argv);
+		 * @endcode
+		 *
+		 * @param path File to read.
+		 * @return Result<void> ok(), or an ErrorCode::ConfigError naming the file and line.
+		 */
+		[[nodiscard]] Result<void> load_config(const std::string &path);
+
+		/**
+		 * @brief Snapshot the current definition into an immutable ParserSpec.
+		 *
+		 * The spec copies every flag, positional, rest positional and
+		 * subcommand, so this Parser can keep being modified or be destroyed.
+		 * ParserSpec::parse() returns a separate ParseResult per call and is
+		 * safe to use from many threads. Captured rest tokens are read with
+		 * ParseResult::get_rest().
+		 *
+		 * Variables named by TypedFlag::set_env are read on every
+		 * ParserSpec::parse() call, ranking above defaults and below the command
+		 * line as they do for parse(). Values loaded with load_config() are
+		 * state of this Parser and are not frozen. chain_subcommands() and
+		 * require_subcommand() are frozen; the subcommands of a chain are
+		 * walked with ParseResult::get_next_subcommand().
+		 *
+		 * @return ParserSpec Frozen definition.
+		 */
+		[[nodiscard]] ParserSpec freeze() const;
+
+		/**
+		 * @brief Clear the state left by the previous parse() so the parser can be reused.
+		 *
+		 * Restores every flag's default, forgets positionals, the selected
+		 * subcommand and the help/version/completion requests, recursively
+		 * through subcommands. Definitions are untouched and container capacity
+		 * is kept, so a reset()/parse() loop over similar input settles into
+		 * reusing the same storage.
+		 *
+		 * Example:
+		 * @code
+		 * for (std::string line; std::getline(std::cin, line);) {
+		 *     parser.reset();
+		 *     auto result = parser.parse(split(line));
+		 *     // ...
+		 * }
+		 * @endcode
+		 */
+		void reset();
+
 		template <typename T = std::string>
 		[[nodiscard]] std::optional<T> get(std::string_view flag_name) const;
 
+		/**
+		 * @brief Get every value of a repeatable flag (see TypedFlag::set_multi).
+		 * @tparam T Element type.
+		 * @param flag_name Long name of the flag.
+		 * @return std::span<const T> View of the stored values (or the default); empty if absent or the type does not match.
+		 */
+		template <typename T = std::string>
+			requires(! std::is_same_v<T, bool>)
+		[[nodiscard]] std::span<const T> get_all(std::string_view flag_name) const;
+
 		[[nodiscard]] bool has(std::string_view flag_name) const;
 
 		template <typename T = std::string>
@@ -89,59 +415,104 @@ namespace cli {
 
 		void print_help(std::ostream &os = std::cout) const;
 		void print_version(std::ostream &os = std::cout) const;
+
+		/**
+		 * @brief Get the help text.
+		 *
+		 * The text is rendered once and cached until a flag, positional,
+		 * subcommand or example is added or changed, so calling this (or any
+		 * of the help writers below) on every error is cheap.
+		 *
+		 * @return std::string Formatted help output.
+		 */
 		[[nodiscard]] std::string generate_help() const;
 
 		/**
-		 * @brief Get the application name.
-		 * @return const std::string& Application name.
+		 * @brief Write the cached help text straight to a C stream.
+		 * @param stream Destination (default: stdout).
 		 */
-		[[nodiscard]] const std::string &app_name() const noexcept {
-			return app_name_;
+		void write_help(std::FILE *stream = stdout) const;
+
+		/**
+		 * @brief Copy the cached help text to an output iterator.
+		 * @param out Destination iterator, e.g. std::back_inserter(buffer).
+		 * @return OutputIt Iterator past the last character written.
+		 */
+		template <typename OutputIt>
+		OutputIt format_to(OutputIt out) const {
+			const std::string &text = help_text();
+			return std::copy(text.begin(), text.end(), out);
 		}
 
-	  private:
 		/**
-		 * @brief Type-erased container for any TypedFlag<T>.
-		 *
-		 * Internally stores a unique_ptr to the concrete flag along with function
-		 * wrappers to set, validate, and query the flag properties without knowing T.
-		 */
-		struct FlagStorage {
-			std::unique_ptr<void, void (*)(void *)> ptr;					///< owning pointer to TypedFlag<T>
-			std::function<Result<void>(std::string_view)> set_value;		///< set value from string
-			std::function<Result<void>()> validate;							///< run validation
-			std::function<bool()> has_value;								///< whether value is present
-			std::function<bool()> is_required;								///< whether flag is required
-			std::function<std::string()> get_short_name;					///< short name accessor
-			std::function<std::string()> get_description;					///< description accessor
-			std::function<std::string()> format_for_help;					///< prepared help line formatter
-			std::function<std::optional<std::string>()> get_value_as_string;///< get value as string
-			std::function<bool()> is_boolean;								///< whether this is a boolean flag
-
-			FlagStorage()
-				: ptr(nullptr, [](void *) {
-				  }) {
-			}
-		};
+		 * @brief Write the resolved values as `name=value` lines, including the selected subcommands'.
+		 *
+		 * Every flag that has a value (given or default) and every given
+		 * positional is written as one line. Repeatable flags list their values
+		 * separated by commas, and the selected subcommand's entries follow
+		 * prefixed with its name (`build.target=release`). Values are rendered
+		 * with std::to_chars; the library itself allocates nothing unless a
+		 * custom type only offers ValueConverter<T>::to_string.
+		 *
+		 * Example:
+		 * @code
+		 * char buffer[4096];
+		 * char *end = parser.dump_values(buffer); // caller ensures the buffer is large enough
+		 * std::fwrite(buffer, 1, end - buffer, log);
+		 * @endcode
+		 *
+		 * @param out Destination iterator.
+		 * @return OutputIt Iterator past the last character written.
+		 */
+		template <typename OutputIt>
+		OutputIt dump_values(OutputIt out) const {
+			detail::DumpState<OutputIt> state{out};
+			dump_level(state);
+			return state.out;
+		}
 
 		/**
-		 * @brief Type-erased container for any TypedPositional<T>.
+		 * @brief Write the same values as dump_values() as one JSON object.
+		 *
+		 * Numbers and booleans are bare, everything else is a string,
+		 * repeatable flags are arrays, and the selected subcommand is a nested
+		 * object under its name: `{"port":80,"build":{"target":"release"}}`.
+		 *
+		 * @param out Destination iterator.
+		 * @return OutputIt Iterator past the last character written.
 		 */
-		struct PositionalStorage {
-			std::unique_ptr<void, void (*)(void *)> ptr;					///< owning pointer to TypedPositional<T>
-			std::function<Result<void>(std::string_view)> set_value;		///< set value from string
-			std::function<bool()> has_value;								///< whether value is present
-			std::function<bool()> is_required;								///< whether positional is required
-			std::function<std::string()> get_name;							///< name accessor
-			std::function<std::string()> get_description;					///< description accessor
-			std::function<std::optional<std::string>()> get_value_as_string;///< get value as string
+		template <typename OutputIt>
+		OutputIt dump_values_json(OutputIt out) const {
+			detail::DumpState<OutputIt> state{out, true};
+			dump_level(state);
+			return state.out;
+		}
 
-			PositionalStorage()
-				: ptr(nullptr, [](void *) {
-				  }) {
-			}
-		};
+		/**
+		 * @brief Heap memory held by this parser and its subcommand tree, by category.
+		 *
+		 * The Parser object itself is not counted; every subcommand counts its
+		 * object and everything below it under MemoryStats::subcommands. A lazy
+		 * subcommand that was never used counts only its name and description.
+		 * Mapped response files from the last parse are not included.
+		 *
+		 * @return MemoryStats Breakdown at the time of the call.
+		 */
+		[[nodiscard]] MemoryStats memory_stats() const;
 
+		/**
+		 * @brief Get the application name.
+		 * @return const std::string& Application name.
+		 */
+		[[nodiscard]] const std::string &app_name() const noexcept {
+			return app_name_;
+		}
+
+	  private:
+		using FlagStorage = detail::FlagStorage;			///< TypedFlag<T> pointer + static vtable
+		using PositionalStorage = detail::PositionalStorage;///< TypedPositional<T> pointer + static vtable
+
+#ifndef CPPLI_MINIMAL
 		/**
 		 * @brief A help example line with a description and command.
 		 */
@@ -149,20 +520,64 @@ namespace cli {
 			std::string description;///< Brief explanation of the example.
 			std::string command;	///< Shell command shown in the help.
 		};
+#endif
 
 		std::string app_name_;
-		std::string description_;
+		detail::HelpText description_;
 		std::string version_;
-		std::map<std::string, FlagStorage> flags_;		  ///< map long-name -> flag
-		std::map<std::string, std::string> short_to_long_;///< map short-name -> long-name
+		detail::NameTable<FlagStorage> flags_;		  ///< long-name -> flag
+		std::unique_ptr<detail::ShortNameIndex> short_index_;///< short-name -> flag index, kept current by set_short_name
+		std::unique_ptr<detail::CommandPresence> presence_;	 ///< required/has-value bits, kept current by the flags and positionals
 		std::vector<PositionalStorage> positionals_;
+		detail::NameTable<std::uint32_t> positional_index_;///< positional name -> index into positionals_
+		std::optional<std::string> rest_name_;			   ///< set by add_rest_positional
+		std::span<const std::string_view> rest_;		   ///< tokens captured for rest_name_
+		std::vector<std::string_view> arg_views_;		   ///< views built by the parse overloads that take owned strings
+		std::optional<detail::ResponseFileExpander> response_files_;///< last parse's @file expansion, which rest_ may view
+#ifndef CPPLI_MINIMAL
 		std::vector<Example> examples_;
-		std::map<std::string, std::unique_ptr<Subcommand>> subcommands_;
+#endif
+		detail::NameTable<std::unique_ptr<Subcommand>> subcommands_;
 		std::optional<std::string> selected_subcommand_;///< name of selected subcommand
+		std::vector<Subcommand *> chain_;				///< selected subcommands in command-line order
+		ParseObserver *observer_ = nullptr;				///< stage events go here, if set
+		Executor *executor_ = nullptr;					///< runs callbacks, if set
+		CallbackHandle callbacks_;						///< callbacks posted by the last parse()
 		int required_subcommand_count_ = 0;				///< -1 = at least one, 0 = optional, >0 = exact count
 		bool parsed_ = false;							///< true after a successful parse
 		bool help_requested_ = false;					///< true if help path was taken
 		bool version_requested_ = false;				///< true if version path was taken
+		bool completion_enabled_ = false;				///< `__complete` handled by parse()
+		bool completion_requested_ = false;				///< true if the last parse() answered `__complete`
+		bool chain_subcommands_ = false;				///< several top-level subcommands per parse()
+		bool abbreviations_ = false;					///< unambiguous prefixes of long flags and subcommands match
+		std::uint64_t revision_ = 0;					///< bumped on changes shown in the help
+		mutable detail::HelpCache help_cache_;
+		mutable detail::LazyNameTrie flag_names_;	   ///< long names, for abbreviations and suggestions
+		mutable detail::LazyNameTrie subcommand_names_;///< subcommand names, likewise
+
+		/**
+		 * @brief Print complete(words) one per line to stdout.
+		 */
+		void write_completions(std::span<const std::string_view> words);
+
+		/**
+		 * @brief Body of parse(): expand, tokenize, store values, validate.
+		 * @param args Arguments as given to parse().
+		 * @param trace Observer context, or nullptr.
+		 * @return Result<void> ok() on success, err(Error) otherwise.
+		 */
+		[[nodiscard]] Result<void> parse_tokens(std::span<const std::string_view> args, const detail::ParseTrace *trace);
+
+		/**
+		 * @brief Check require_subcommand's count against the parse's subcommands.
+		 */
+		[[nodiscard]] Result<void> validate_subcommand_count() const;
+
+		/**
+		 * @brief Run the selected subcommands' callbacks, or post them to executor_.
+		 */
+		void run_callbacks(const detail::ParseTrace *trace);
 
 		/**
 		 * @brief Validate required flags and positionals after parsing.
@@ -171,152 +586,133 @@ namespace cli {
 		[[nodiscard]] Result<void> validate_requirements() const;
 
 		/**
-		 * @brief Format a single flag line for the help output.
-		 * @param flag Type-erased flag storage.
-		 * @param long_name The long name used for display.
-		 * @return std::string Formatted option line.
+		 * @brief Cached help text, re-rendered if the definition changed since.
+		 * @return const std::string& Help output, valid until the next change.
+		 */
+		[[nodiscard]] const std::string &help_text() const;
+
+		/**
+		 * @brief Render the help text from scratch.
+		 * @param out Buffer to append to.
+		 */
+		void render_help(std::string &out) const;
+
+		/**
+		 * @brief Body of dump_values() / dump_values_json().
 		 */
-		std::string format_flag_for_help(const FlagStorage &flag, const std::string &long_name) const;
+		template <typename OutputIt>
+		void dump_level(detail::DumpState<OutputIt> &state) const;
 	};
 
 	template <typename T>
-	TypedFlag<T> &Parser::add_flag(std::string long_name, std::string description) {
+	TypedFlag<T> &Parser::add_flag(std::string long_name, detail::HelpText description) {
 		auto flag = std::make_unique<TypedFlag<T>>(long_name, std::move(description));
 		auto *flag_ptr = flag.get();
 
-		FlagStorage storage;
-		storage.ptr = std::unique_ptr<void, void (*)(void *)>(flag.release(), [](void *p) {
-			delete static_cast<TypedFlag<T> *>(p);
-		});
-		storage.set_value = [flag_ptr](std::string_view str) {
-			return flag_ptr->set_value_from_string(str);
-		};
-		storage.validate = [flag_ptr]() {
-			return flag_ptr->validate();
-		};
-		storage.has_value = [flag_ptr]() {
-			return flag_ptr->has_value();
-		};
-		storage.is_required = [flag_ptr]() {
-			return flag_ptr->is_required();
-		};
-		storage.get_short_name = [flag_ptr]() {
-			return flag_ptr->short_name();
-		};
-		storage.get_description = [flag_ptr]() {
-			return flag_ptr->description();
-		};
-		storage.format_for_help = [this, flag_ptr, long_name = std::string(long_name)]() {
-			return this->format_flag_for_help(flags_.at(long_name), long_name);
-		};
-		storage.get_value_as_string = [flag_ptr]() -> std::optional<std::string> {
-			if (flag_ptr->has_value()) {
-				if constexpr (std::is_same_v<T, std::string>) {
-					return flag_ptr->value();
-				} else if constexpr (std::is_same_v<T, bool>) {
-					return flag_ptr->value() ? "true" : "false";
-				} else {
-					return std::to_string(*flag_ptr->value());
-				}
-			}
-			return std::nullopt;
-		};
-
-		storage.is_boolean = []() {
-			return std::is_same_v<T, bool>;
-		};
+		auto index = flags_.index_of(long_name);
+		if (index != detail::NameTable<FlagStorage>::npos) {
+			short_index_->remove(flags_.at(index).value.get_short_name(), static_cast<std::uint32_t>(index));
+		} else {
+			index = flags_.size();
+		}
 
-		auto *result_ptr = storage.ptr.get();
-		flags_[long_name] = std::move(storage);
-		return *static_cast<TypedFlag<T> *>(result_ptr);
+		flags_.insert_or_assign(std::move(long_name), FlagStorage(std::move(flag)));
+		flag_ptr->attach_short_index(*short_index_, static_cast<std::uint32_t>(index));
+		flag_ptr->attach_presence(presence_->flags, static_cast<std::uint32_t>(index));
+		return *flag_ptr;
 	}
 
 	template <typename T>
-	TypedPositional<T> &Parser::add_positional(std::string name, std::string description, bool required) {
-		auto pos = std::make_unique<TypedPositional<T>>(name, std::move(description), required);
+	TypedPositional<T> &Parser::add_positional(std::string name, detail::HelpText description, bool required) {
+		auto pos = std::make_unique<TypedPositional<T>>(std::move(name), std::move(description), required);
 		auto *pos_ptr = pos.get();
-
-		PositionalStorage storage;
-		storage.ptr = std::unique_ptr<void, void (*)(void *)>(pos.release(), [](void *p) {
-			delete static_cast<TypedPositional<T> *>(p);
-		});
-		storage.set_value = [pos_ptr](std::string_view str) {
-			return pos_ptr->set_value_from_string(str);
-		};
-		storage.has_value = [pos_ptr]() {
-			return pos_ptr->has_value();
-		};
-		storage.is_required = [pos_ptr]() {
-			return pos_ptr->is_required();
-		};
-		storage.get_name = [pos_ptr]() {
-			return pos_ptr->name();
-		};
-		storage.get_description = [pos_ptr]() {
-			return pos_ptr->description();
-		};
-		storage.get_value_as_string = [pos_ptr]() -> std::optional<std::string> {
-			if (pos_ptr->has_value()) {
-				if constexpr (std::is_same_v<T, std::string>) {
-					return pos_ptr->value();
-				} else if constexpr (std::is_same_v<T, bool>) {
-					return pos_ptr->value() ? "true" : "false";
-				} else {
-					return std::to_string(*pos_ptr->value());
-				}
-			}
-			return std::nullopt;
-		};
-
-		positionals_.push_back(std::move(storage));
-		return *static_cast<TypedPositional<T> *>(positionals_.back().ptr.get());
+		if (! positional_index_.contains(pos_ptr->name())) {
+			positional_index_.insert_or_assign(pos_ptr->name(), static_cast<std::uint32_t>(positionals_.size()));
+		}
+		pos_ptr->attach_presence(presence_->positionals, static_cast<std::uint32_t>(positionals_.size()));
+		positionals_.emplace_back(std::move(pos));
+		++revision_;
+		return *pos_ptr;
 	}
 
 	template <typename T>
 	std::optional<T> Parser::get(std::string_view flag_name) const {
-		auto it = flags_.find(std::string(flag_name));
-		if (it == flags_.end() || ! it->second.has_value()) {
+		const auto *storage = flags_.find(flag_name);
+		if (storage == nullptr) {
 			return std::nullopt;
 		}
 
-		auto *flag_ptr = static_cast<TypedFlag<T> *>(it->second.ptr.get());
-
-		if (! flag_ptr->has_value()) {
+		const auto *flag_ptr = storage->template get_if<T>();
+		if (flag_ptr == nullptr || ! flag_ptr->has_value()) {
 			return std::nullopt;
 		}
 
+		if constexpr (! std::is_same_v<T, bool>) {
+			if (flag_ptr->is_multi()) {
+				return flag_ptr->all_values().back();
+			}
+		}
+
 		return flag_ptr->value();
 	}
 
+	template <typename T>
+		requires(! std::is_same_v<T, bool>)
+	std::span<const T> Parser::get_all(std::string_view flag_name) const {
+		const auto *storage = flags_.find(flag_name);
+		if (storage == nullptr) {
+			return {};
+		}
+
+		const auto *flag_ptr = storage->template get_if<T>();
+		if (flag_ptr == nullptr || ! flag_ptr->is_multi()) {
+			return {};
+		}
+
+		return flag_ptr->all_values();
+	}
+
 	template <typename T>
 	std::optional<T> Parser::get_positional(size_t index) const {
 		if (index >= positionals_.size()) {
 			return std::nullopt;
 		}
 
-		auto *pos_ptr = static_cast<TypedPositional<T> *>(positionals_[index].ptr.get());
-
-		if (! pos_ptr->has_value()) {
+		const auto *pos_ptr = positionals_[index].template get_if<T>();
+		if (pos_ptr == nullptr || ! pos_ptr->has_value()) {
 			return std::nullopt;
 		}
 
 		return pos_ptr->value();
 	}
 
-	template <typename T>
-	std::optional<T> Parser::get_positional(std::string_view name) const {
-		for (const auto &pos_storage: positionals_) {
-			if (pos_storage.get_name() == name) {
-				auto *pos_ptr = static_cast<TypedPositional<T> *>(pos_storage.ptr.get());
-
-				if (! pos_ptr->has_value()) {
-					return std::nullopt;
-				}
+	template <typename OutputIt>
+	void Parser::dump_level(detail::DumpState<OutputIt> &state) const {
+		if (state.json) {
+			*state.out++ = '{';
+		}
+		detail::dump_entries(state, flags_, positionals_, nullptr);
 
-				return pos_ptr->value();
+		for (const Subcommand *sub: chain_) {
+			const detail::DumpPath path{sub->name_};
+			if (state.json) {
+				detail::dump_key(state, nullptr, path.name);
 			}
+			sub->dump_level(state, &path);
+		}
+
+		if (state.json) {
+			*state.out++ = '}';
+		}
+	}
+
+	template <typename T>
+	std::optional<T> Parser::get_positional(std::string_view name) const {
+		const auto *index = positional_index_.find(name);
+		if (index == nullptr) {
+			return std::nullopt;
 		}
-		return std::nullopt;
+		return get_positional<T>(*index);
 	}
 
 }// namespace cli
@@ -0,0 +1,72 @@
+#ifndef CPPLI_COMPLETION_HPP
+#define CPPLI_COMPLETION_HPP
+
+#include "cppli_name_table.hpp"
+#include "cppli_storage.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cli {
+
+	/**
+	 * @brief Shells that Parser::completion_script can generate a script for.
+	 */
+	enum class CompletionShell : std::uint8_t {
+		Bash,
+		Zsh,
+		Fish,
+	};
+
+	/**
+	 * @brief First argument that switches parse() into completion mode (see Parser::add_completion).
+	 */
+	inline constexpr std::string_view completion_command = "__complete";
+
+	namespace detail {
+
+		/**
+		 * @brief Sorted candidate list answering prefix queries with a binary search.
+		 *
+		 * Built per completion request for the one command level the typed
+		 * words end up in, so the cost does not depend on the rest of the tree.
+		 */
+		class PrefixIndex {
+		  public:
+			void add(std::string candidate) {
+				entries_.push_back(std::move(candidate));
+				sorted_ = false;
+			}
+
+			/**
+			 * @brief Candidates starting with prefix, sorted and without duplicates.
+			 */
+			[[nodiscard]] std::span<const std::string> matches(std::string_view prefix);
+
+		  private:
+			std::vector<std::string> entries_;
+			bool sorted_ = false;
+		};
+
+		/**
+		 * @brief Add `--long` and `-s` for every flag.
+		 */
+		void add_flag_candidates(PrefixIndex &index, const NameTable<FlagStorage> &flags);
+
+		/**
+		 * @brief Add the choices of flag, each prepended with lead (e.g. `--mode=`).
+		 */
+		void add_choice_candidates(PrefixIndex &index, const FlagStorage &flag, std::string_view lead);
+
+		/**
+		 * @brief Shell glue that forwards the words being completed to `app __complete`.
+		 */
+		[[nodiscard]] std::string completion_script(std::string_view app, CompletionShell shell);
+
+	}// namespace detail
+
+}// namespace cli
+
+#endif// CPPLI_COMPLETION_HPP
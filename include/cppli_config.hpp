@@ -0,0 +1,72 @@
+#ifndef CPPLI_CONFIG_HPP
+#define CPPLI_CONFIG_HPP
+
+#include "cppli_error.hpp"
+#include "cppli_name_table.hpp"
+#include "cppli_observer.hpp"
+#include "cppli_storage.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace cli::detail {
+
+	/**
+	 * @brief One meaningful line of a config file; views into the file contents.
+	 */
+	struct ConfigLine {
+		enum class Kind : std::uint8_t {
+			Section,  ///< `[name]`: key holds the name
+			Entry,	  ///< `key = value`
+			Malformed,///< value holds the reason
+		};
+
+		Kind kind;
+		std::string_view key;
+		std::string_view value;
+	};
+
+	/**
+	 * @brief Single-pass scanner over key=value / INI text.
+	 *
+	 * Blank lines and lines starting with `#` or `;` are skipped. Keys and
+	 * values are trimmed, and a value wrapped in matching single or double
+	 * quotes loses them (there are no escapes and no trailing comments). A
+	 * UTF-8 byte order mark is ignored.
+	 */
+	class ConfigScanner {
+	  public:
+		explicit ConfigScanner(std::string_view text) noexcept : text_(text) {
+			if (text_.starts_with("\xEF\xBB\xBF")) {
+				pos_ = 3;
+			}
+		}
+
+		/**
+		 * @brief Next section or entry, std::nullopt at end of input.
+		 */
+		[[nodiscard]] std::optional<ConfigLine> next() noexcept;
+
+		/**
+		 * @brief 1-based number of the line last returned by next().
+		 */
+		[[nodiscard]] std::size_t line() const noexcept {
+			return line_;
+		}
+
+	  private:
+		std::string_view text_;
+		std::size_t pos_ = 0;
+		std::size_t line_ = 0;
+	};
+
+	/**
+	 * @brief Set every flag with TypedFlag::set_env whose variable is set, as ValueSource::Environment.
+	 * @return Result<void> ok(), or the first value that failed to parse or validate.
+	 */
+	[[nodiscard]] Result<void> apply_environment(const NameTable<FlagStorage> &flags, const ParseTrace *trace);
+
+}// namespace cli::detail
+
+#endif// CPPLI_CONFIG_HPP
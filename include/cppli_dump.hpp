@@ -0,0 +1,159 @@
+#ifndef CPPLI_DUMP_HPP
+#define CPPLI_DUMP_HPP
+
+#include "cppli_name_table.hpp"
+#include "cppli_storage.hpp"
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace cli::detail {
+
+	/**
+	 * @brief Subcommand names above the level being dumped, linked through the stack.
+	 */
+	struct DumpPath {
+		std::string_view name;
+		const DumpPath *parent = nullptr;
+	};
+
+	/**
+	 * @brief Output position and separator state of one dump_values / dump_values_json call.
+	 */
+	template <typename OutputIt>
+	struct DumpState {
+		OutputIt out;
+		bool json = false;
+		bool first_entry = true;///< no member written yet in the current JSON object
+		bool first_value = true;///< no value written yet for the current name
+	};
+
+	template <typename OutputIt>
+	void dump_text(DumpState<OutputIt> &state, std::string_view text) {
+		state.out = std::copy(text.begin(), text.end(), state.out);
+	}
+
+	/**
+	 * @brief Write text as the inside of a JSON string.
+	 */
+	template <typename OutputIt>
+	void dump_escaped(DumpState<OutputIt> &state, std::string_view text) {
+		constexpr std::string_view hex = "0123456789abcdef";
+		for (const char c: text) {
+			switch (c) {
+				case '"':
+					dump_text(state, "\\\"");
+					break;
+				case '\\':
+					dump_text(state, "\\\\");
+					break;
+				case '\n':
+					dump_text(state, "\\n");
+					break;
+				case '\r':
+					dump_text(state, "\\r");
+					break;
+				case '\t':
+					dump_text(state, "\\t");
+					break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20) {
+						const char escape[] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xf], hex[c & 0xf]};
+						dump_text(state, std::string_view(escape, sizeof(escape)));
+					} else {
+						*state.out++ = c;
+					}
+			}
+		}
+	}
+
+	/**
+	 * @brief ValueSink::write for a DumpState: comma between values, quotes around JSON text.
+	 */
+	template <typename OutputIt>
+	void dump_sink_write(void *context, DumpKind kind, std::string_view first, std::string_view second) {
+		auto &state = *static_cast<DumpState<OutputIt> *>(context);
+		if (! state.first_value) {
+			*state.out++ = ',';
+		}
+		state.first_value = false;
+
+		if (state.json && kind == DumpKind::Text) {
+			*state.out++ = '"';
+			dump_escaped(state, first);
+			dump_escaped(state, second);
+			*state.out++ = '"';
+		} else {
+			dump_text(state, first);
+			dump_text(state, second);
+		}
+	}
+
+	template <typename OutputIt>
+	void dump_path(DumpState<OutputIt> &state, const DumpPath *path) {
+		if (path != nullptr) {
+			dump_path(state, path->parent);
+			dump_text(state, path->name);
+			*state.out++ = '.';
+		}
+	}
+
+	/**
+	 * @brief Start a member: `path.name=` as text, or `"name":` inside the current JSON object.
+	 */
+	template <typename OutputIt>
+	void dump_key(DumpState<OutputIt> &state, const DumpPath *path, std::string_view name) {
+		if (state.json) {
+			if (! state.first_entry) {
+				*state.out++ = ',';
+			}
+			state.first_entry = false;
+			*state.out++ = '"';
+			dump_escaped(state, name);
+			dump_text(state, "\":");
+		} else {
+			dump_path(state, path);
+			dump_text(state, name);
+			*state.out++ = '=';
+		}
+		state.first_value = true;
+	}
+
+	/**
+	 * @brief Write one `name=value` line (or JSON member) per flag and positional that has a value.
+	 *
+	 * Repeatable flags list every value, comma-separated, or as a JSON array.
+	 */
+	template <typename OutputIt>
+	void dump_entries(DumpState<OutputIt> &state, const NameTable<FlagStorage> &flags, const std::vector<PositionalStorage> &positionals, const DumpPath *path) {
+		const ValueSink sink{&state, &dump_sink_write<OutputIt>};
+
+		auto entry = [&](std::string_view name, bool multi, const auto &storage) {
+			dump_key(state, path, name);
+			if (state.json && multi) {
+				*state.out++ = '[';
+			}
+			storage.dump(sink);
+			if (state.json && multi) {
+				*state.out++ = ']';
+			}
+			if (! state.json) {
+				*state.out++ = '\n';
+			}
+		};
+
+		for (const auto &[name, flag]: flags) {
+			if (flag.has_value()) {
+				entry(name, flag.is_multi(), flag);
+			}
+		}
+		for (const auto &pos: positionals) {
+			if (pos.has_value()) {
+				entry(pos.get_name(), false, pos);
+			}
+		}
+	}
+
+}// namespace cli::detail
+
+#endif// CPPLI_DUMP_HPP
@@ -2,6 +2,10 @@
 #define CPPLI_ERROR_HPP
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <source_location>
 #include <stdexcept>
 #include <string>
@@ -23,6 +27,11 @@ namespace cli {
 		MissingFlagValue,		  ///< Flag expected a value but none was given
 		ValidationFailed,		  ///< User-provided validator rejected the value
 		ParserNotInitialized,	  ///< Reserved for future use
+		ResponseFileError,		  ///< An @file argument could not be expanded
+		SnapshotError,			  ///< A parse snapshot could not be written or loaded
+		ConfigError,			  ///< A config file could not be read or has an invalid line
+		SubcommandChainError,	  ///< Chained subcommands repeat one or miss require_subcommand's count
+		UnknownSubcommand,		  ///< A token was not a subcommand, but is close to the name of one
 	};
 
 	/**
@@ -30,21 +39,58 @@ namespace cli {
 	 *
 	 * Error carries both a machine-readable code and a human-readable message.
 	 * When compiled without NDEBUG, format() also includes file and line.
+	 *
+	 * The message is not built up front: an Error stores a static message
+	 * template plus up to two arguments (e.g. the flag name and the offending
+	 * value), copied inline when they fit in inline_capacity bytes and into
+	 * one shared, reference-counted block otherwise. Creating, copying and
+	 * inspecting code() therefore does not allocate in the common case;
+	 * message(), format() and format_to() render the text on demand. An
+	 * Error is 40 bytes on 64-bit targets, so a Result stays close to the
+	 * size of its value.
 	 */
 	class Error {
 	  public:
+		/**
+		 * @brief Bytes of argument text stored inside the Error before spilling to the heap.
+		 */
+		static constexpr std::size_t inline_capacity = 16;
+
 		/**
 		 * @brief Default constructor for "no error".
 		 */
 		Error() = default;
 
+		Error(const Error &other) noexcept {
+			take(other);
+			if (spilled_) {
+				spill_->references.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		Error(Error &&other) noexcept {
+			take(other);
+			other.spilled_ = false;
+		}
+
+		Error &operator=(Error other) noexcept {
+			release();
+			take(other);
+			other.spilled_ = false;
+			return *this;
+		}
+
+		~Error() {
+			release();
+		}
+
 		/**
 		 * @brief Construct an Error with code and message.
 		 * @param code The error category.
-		 * @param message Descriptive message.
+		 * @param message Descriptive message (copied).
 		 * @param location Source location (defaults to callsite).
 		 */
-		Error(ErrorCode code, std::string message, std::source_location location = std::source_location::current()) : code_(code), message_(std::move(message)), location_(location) {
+		Error(ErrorCode code, std::string_view message, std::source_location location = std::source_location::current()) : Error(code, nullptr, message, {}, location) {
 		}
 
 		/**
@@ -55,10 +101,52 @@ namespace cli {
 		}
 
 		/**
-		 * @brief Get the human-readable message.
+		 * @brief Render the human-readable message.
 		 */
-		[[nodiscard]] const std::string &message() const noexcept {
-			return message_;
+		[[nodiscard]] std::string message() const;
+
+		/**
+		 * @brief Write the message to an output iterator without allocating.
+		 *
+		 * Example:
+		 * @code
+		 * char buffer[256];
+		 * auto end = error.format_to(buffer); // caller ensures the buffer is large enough
+		 * @endcode
+		 *
+		 * @param out Output iterator over char.
+		 * @return OutputIt Iterator past the last character written.
+		 */
+		template <typename OutputIt>
+		OutputIt format_to(OutputIt out) const {
+			const std::string_view pattern = pattern_ != nullptr ? std::string_view(pattern_) : std::string_view("{}");
+			std::size_t next = 0;
+			for (std::size_t i = 0; i < pattern.size(); ++i) {
+				if (pattern[i] == '{' && i + 1 < pattern.size() && pattern[i + 1] == '}') {
+					const std::string_view arg = argument(next++);
+					out = std::copy(arg.begin(), arg.end(), out);
+					++i;
+				} else {
+					*out++ = pattern[i];
+				}
+			}
+			return out;
+		}
+
+		/**
+		 * @brief Raw message argument: 0 is the subject (flag, token or path), 1 the detail.
+		 * @return std::string_view The argument, or empty if absent.
+		 */
+		[[nodiscard]] std::string_view argument(std::size_t index) const noexcept {
+			const std::string_view text = spilled_ ? std::string_view(spill_->text) : std::string_view(inline_, total_size_);
+			const std::size_t first_size = spilled_ ? spill_->first_size : first_size_;
+			if (index == 0) {
+				return text.substr(0, first_size);
+			}
+			if (index == 1) {
+				return text.substr(first_size);
+			}
+			return {};
 		}
 
 		/**
@@ -81,6 +169,21 @@ namespace cli {
 		 */
 		[[nodiscard]] static Error unknown_flag(std::string_view flag_name);
 
+		/**
+		 * @brief Unknown flag name with the nearest known long name; plain unknown_flag if suggestion is empty.
+		 */
+		[[nodiscard]] static Error unknown_flag(std::string_view flag_name, std::string_view suggestion);
+
+		/**
+		 * @brief An abbreviated long flag matches more than one flag (see Parser::allow_abbreviations).
+		 */
+		[[nodiscard]] static Error ambiguous_flag(std::string_view flag_name);
+
+		/**
+		 * @brief A surplus argument is one edit or two away from a subcommand name.
+		 */
+		[[nodiscard]] static Error unknown_subcommand(std::string_view name, std::string_view suggestion);
+
 		/**
 		 * @brief Required flag was not provided.
 		 */
@@ -111,10 +214,87 @@ namespace cli {
 		 */
 		[[nodiscard]] static Error validation_failed(std::string_view name, std::string_view reason);
 
+		/**
+		 * @brief A built-in validator rejected a value.
+		 * @param name Flag or positional name, the pattern's one "{}".
+		 * @param pattern Message template with static storage duration, as the validators in cppli_validators.hpp return.
+		 */
+		[[nodiscard]] static Error validation_rejected(std::string_view name, const char *pattern);
+
+		/**
+		 * @brief A response file (@file) could not be expanded.
+		 */
+		[[nodiscard]] static Error response_file_error(std::string_view path, std::string_view reason);
+
+		/**
+		 * @brief A parse snapshot could not be written, or was rejected by ParseResultView::from_bytes.
+		 */
+		[[nodiscard]] static Error snapshot_error(std::string_view reason);
+
+		/**
+		 * @brief A config file given to Parser::load_config was rejected.
+		 * @param location Path, with `:line` for an error on a line.
+		 * @param reason What is wrong.
+		 */
+		[[nodiscard]] static Error config_error(std::string_view location, std::string_view reason);
+
+		/**
+		 * @brief A subcommand appeared twice in one chain (see Parser::chain_subcommands).
+		 */
+		[[nodiscard]] static Error repeated_subcommand(std::string_view name);
+
+		/**
+		 * @brief The number of chained subcommands differs from require_subcommand(count).
+		 */
+		[[nodiscard]] static Error subcommand_count(std::size_t expected, std::size_t given);
+
 	  private:
-		ErrorCode code_ = ErrorCode::None;
-		std::string message_;
+		/**
+		 * @brief Argument text that does not fit inline, shared by copies of the Error.
+		 */
+		struct Spill {
+			std::atomic<std::size_t> references{1};
+			std::size_t first_size = 0;///< length of argument 0
+			std::string text;		   ///< both arguments
+		};
+
+		const char *pattern_ = nullptr;///< static template; each "{}" takes the next argument, nullptr means "{}"
 		std::source_location location_;
+		ErrorCode code_ = ErrorCode::None;
+		std::uint8_t first_size_ = 0;///< length of argument 0, when inline
+		std::uint8_t total_size_ = 0;///< length of both arguments, when inline
+		bool spilled_ = false;		 ///< spill_ is active instead of inline_
+
+		union {
+			char inline_[inline_capacity]{};
+			Spill *spill_;
+		};
+
+		Error(ErrorCode code, const char *pattern, std::string_view first, std::string_view second, std::source_location location = std::source_location::current());
+
+		/**
+		 * @brief Copy other's fields and text, sharing its spill without touching the count.
+		 */
+		void take(const Error &other) noexcept {
+			pattern_ = other.pattern_;
+			location_ = other.location_;
+			code_ = other.code_;
+			first_size_ = other.first_size_;
+			total_size_ = other.total_size_;
+			spilled_ = other.spilled_;
+			if (spilled_) {
+				spill_ = other.spill_;
+			} else {
+				std::copy_n(other.inline_, total_size_, inline_);
+			}
+		}
+
+		void release() noexcept {
+			if (spilled_ && spill_->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				delete spill_;
+			}
+			spilled_ = false;
+		}
 	};
 
 	/**
@@ -142,7 +322,7 @@ namespace cli {
 		 */
 		Result()
 			requires std::is_same_v<T, void>
-			: has_value_(true) {
+		{
 		}
 
 		/**
@@ -150,34 +330,34 @@ namespace cli {
 		 */
 		Result(T value)
 			requires(! std::is_same_v<T, void>)
-			: storage_(std::move(value)), has_value_(true) {
+			: storage_(std::move(value)) {
 		}
 
 		/**
 		 * @brief Construct an error result.
 		 */
-		Result(Error error) : storage_(std::move(error)), has_value_(false) {
+		Result(Error error) : storage_(std::move(error)) {
 		}
 
 		/**
 		 * @brief True if result is ok.
 		 */
 		[[nodiscard]] bool has_value() const noexcept {
-			return has_value_;
+			return storage_.index() == 0;
 		}
 
 		/**
 		 * @brief Contextual boolean: true when ok.
 		 */
 		[[nodiscard]] explicit operator bool() const noexcept {
-			return has_value_;
+			return has_value();
 		}
 
 		/**
 		 * @brief Access the error. Throws if ok.
 		 */
 		[[nodiscard]] const Error &error() const {
-			if (has_value_) {
+			if (has_value()) {
 				throw std::logic_error("Attempted to access error on successful Result");
 			}
 			return std::get<Error>(storage_);
@@ -189,7 +369,7 @@ namespace cli {
 		[[nodiscard]] T &value()
 			requires(! std::is_same_v<T, void>)
 		{
-			if (! has_value_) {
+			if (! has_value()) {
 				throw std::logic_error("Attempted to access value on failed Result");
 			}
 			return std::get<T>(storage_);
@@ -201,7 +381,7 @@ namespace cli {
 		[[nodiscard]] const T &value() const
 			requires(! std::is_same_v<T, void>)
 		{
-			if (! has_value_) {
+			if (! has_value()) {
 				throw std::logic_error("Attempted to access value on failed Result");
 			}
 			return std::get<T>(storage_);
@@ -213,7 +393,7 @@ namespace cli {
 		[[nodiscard]] T value_or(T default_value) const
 			requires(! std::is_same_v<T, void>)
 		{
-			return has_value_ ? std::get<T>(storage_) : std::move(default_value);
+			return has_value() ? std::get<T>(storage_) : std::move(default_value);
 		}
 
 		/**
@@ -243,7 +423,6 @@ namespace cli {
 
 	  private:
 		std::conditional_t<std::is_same_v<T, void>, std::variant<std::monostate, Error>, std::variant<T, Error>> storage_;
-		bool has_value_;
 	};
 
 	/**
@@ -257,34 +436,34 @@ namespace cli {
 		/**
 		 * @brief Construct an ok() result.
 		 */
-		Result() : storage_(std::monostate{}), has_value_(true) {
+		Result() : storage_(std::monostate{}) {
 		}
 
 		/**
 		 * @brief Construct an error result.
 		 */
-		Result(Error error) : storage_(std::move(error)), has_value_(false) {
+		Result(Error error) : storage_(std::move(error)) {
 		}
 
 		/**
 		 * @brief True if ok.
 		 */
 		[[nodiscard]] bool has_value() const noexcept {
-			return has_value_;
+			return storage_.index() == 0;
 		}
 
 		/**
 		 * @brief Contextual boolean: true when ok.
 		 */
 		[[nodiscard]] explicit operator bool() const noexcept {
-			return has_value_;
+			return has_value();
 		}
 
 		/**
 		 * @brief Access the error. Throws if ok.
 		 */
 		[[nodiscard]] const Error &error() const {
-			if (has_value_) {
+			if (has_value()) {
 				throw std::logic_error("Attempted to access error on successful Result");
 			}
 			return std::get<Error>(storage_);
@@ -306,7 +485,6 @@ namespace cli {
 
 	  private:
 		std::variant<std::monostate, Error> storage_;
-		bool has_value_;
 	};
 
 }// namespace cli
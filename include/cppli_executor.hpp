@@ -0,0 +1,139 @@
+#ifndef CPPLI_EXECUTOR_HPP
+#define CPPLI_EXECUTOR_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cli {
+
+	/**
+	 * @brief Minimal task executor used for parallel work such as ParserSpec::parse_batch.
+	 *
+	 * Implement post() to plug in your own thread pool; bulk_execute() is built on
+	 * top of it.
+	 */
+	class Executor {
+	  public:
+		virtual ~Executor() = default;
+
+		/**
+		 * @brief Schedule a task to run asynchronously.
+		 * @param task Function to execute on some worker.
+		 */
+		virtual void post(std::function<void()> task) = 0;
+
+		/**
+		 * @brief Number of tasks the executor can run at the same time.
+		 */
+		[[nodiscard]] virtual std::size_t concurrency() const noexcept = 0;
+
+		/**
+		 * @brief Run fn(0) ... fn(count - 1), possibly in parallel, and wait for all of them.
+		 *
+		 * The calling thread takes part in the work, so this completes even when
+		 * every worker is busy (including when called from inside a posted task).
+		 * If fn throws, indices not yet started are skipped, the calls already
+		 * running are waited for, and the first exception is rethrown here.
+		 *
+		 * @param count Number of indices.
+		 * @param fn Function invoked once per index.
+		 */
+		void bulk_execute(std::size_t count, const std::function<void(std::size_t)> &fn);
+	};
+
+	/**
+	 * @brief Fixed-size pool of worker threads.
+	 *
+	 * Example:
+	 * @code
+	 * cli::ThreadExecutor pool;               // one worker per hardware thread
+	 * auto batch = spec.parse_batch(inputs, pool);
+	 * @endcode
+	 */
+	class ThreadExecutor : public Executor {
+	  public:
+		/**
+		 * @brief Start the workers.
+		 * @param threads Worker count; 0 means std::thread::hardware_concurrency().
+		 */
+		explicit ThreadExecutor(std::size_t threads = 0);
+
+		/**
+		 * @brief Finish queued tasks and join the workers.
+		 */
+		~ThreadExecutor() override;
+
+		ThreadExecutor(const ThreadExecutor &) = delete;
+		ThreadExecutor &operator=(const ThreadExecutor &) = delete;
+
+		void post(std::function<void()> task) override;
+
+		[[nodiscard]] std::size_t concurrency() const noexcept override {
+			return workers_.size();
+		}
+
+	  private:
+		std::vector<std::thread> workers_;
+		std::deque<std::function<void()>> queue_;
+		std::mutex mutex_;
+		std::condition_variable ready_;
+		bool stopping_ = false;
+
+		void run();
+	};
+
+	/**
+	 * @brief Completion of the subcommand callbacks started by one Parser::parse call.
+	 *
+	 * Copies share the same state. A default-constructed handle, and the
+	 * handle of a parse without an executor, are already done.
+	 *
+	 * Example:
+	 * @code
+	 * cli::ThreadExecutor pool;
+	 * parser.chain_subcommands().set_executor(&pool);
+	 * if (parser.parse(argc, argv)) {
+	 *     parser.callbacks().wait();
+	 * }
+	 * @endcode
+	 */
+	class CallbackHandle {
+	  public:
+		CallbackHandle() = default;
+
+		/**
+		 * @brief Block until every callback has finished or a stage failed.
+		 *
+		 * Rethrows the first exception thrown by a callback; later stages are
+		 * not started once one has thrown.
+		 */
+		void wait() const;
+
+		/**
+		 * @brief True once wait() would return without blocking.
+		 */
+		[[nodiscard]] bool done() const noexcept;
+
+	  private:
+		friend class Parser;
+
+		struct State;
+		std::shared_ptr<State> state_;
+
+		/**
+		 * @brief Post each stage's tasks to the executor, starting a stage once the previous one finished.
+		 * @param executor Runs the tasks; must outlive them.
+		 * @param stages Tasks in stage order; the tasks of one stage may run concurrently.
+		 */
+		[[nodiscard]] static CallbackHandle start(Executor &executor, std::vector<std::vector<std::function<void()>>> stages);
+	};
+
+}// namespace cli
+
+#endif// CPPLI_EXECUTOR_HPP
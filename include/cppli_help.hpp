@@ -0,0 +1,138 @@
+#ifndef CPPLI_HELP_HPP
+#define CPPLI_HELP_HPP
+
+#include "cppli_name_table.hpp"
+#include "cppli_storage.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace cli::detail {
+
+	inline constexpr std::string_view ansi_reset = "\033[0m";
+	inline constexpr std::string_view ansi_bold = "\033[1m";
+	inline constexpr std::string_view ansi_green = "\033[32m";
+
+#ifdef CPPLI_MINIMAL
+	/**
+	 * @brief Help and version output is never colored in a CPPLI_MINIMAL build.
+	 */
+	[[nodiscard]] constexpr bool color_enabled() noexcept {
+		return false;
+	}
+#else
+	/**
+	 * @brief Whether help and version output is colored.
+	 *
+	 * Checks once whether stdout is a terminal and caches the answer, so
+	 * cached help text and direct writes always agree.
+	 */
+	[[nodiscard]] bool color_enabled() noexcept;
+#endif
+
+	/**
+	 * @brief Append text wrapped in an ANSI style when color is enabled.
+	 */
+	void append_styled(std::string &out, std::string_view style, std::string_view text);
+
+	/**
+	 * @brief Append ` <name>` / ` [name]` for each positional of a usage line.
+	 */
+	void append_usage_positionals(std::string &out, std::span<const PositionalStorage> positionals);
+
+	/**
+	 * @brief Append ` [-- name...]` for a rest positional, if there is one.
+	 */
+	void append_usage_rest(std::string &out, const std::optional<std::string> &rest_name);
+
+#ifndef CPPLI_MINIMAL
+	/**
+	 * @brief Append the OPTIONS section, sorted by long name; nothing if there are no flags.
+	 */
+	void append_options(std::string &out, const NameTable<FlagStorage> &flags);
+
+	/**
+	 * @brief Append one `name - description` line per subcommand, sorted by name.
+	 */
+	template <typename SubcommandTable>
+	void append_subcommand_list(std::string &out, const SubcommandTable &subcommands) {
+		out += "SUBCOMMANDS:\n";
+		for (const auto &[name, sub]: subcommands.sorted()) {
+			out += "    ";
+			out += name;
+			if (! sub->description().empty()) {
+				out += " - ";
+				out += sub->description();
+			}
+			out += '\n';
+		}
+		out += '\n';
+	}
+
+	/**
+	 * @brief Append the EXAMPLES section; nothing if there are no examples.
+	 */
+	template <typename ExampleList>
+	void append_examples(std::string &out, const ExampleList &examples) {
+		if (examples.empty()) {
+			return;
+		}
+
+		out += "EXAMPLES:\n";
+		for (const auto &example: examples) {
+			out += "  ";
+			out += example.description;
+			out += "\n    $ ";
+			if (color_enabled()) {
+				out += ansi_green;
+			}
+			out += example.command;
+			out += "\n\n";
+			if (color_enabled()) {
+				out += ansi_reset;
+			}
+		}
+	}
+#endif
+
+	/**
+	 * @brief Write text to a C stream in one call.
+	 */
+	void write_text(std::FILE *stream, std::string_view text) noexcept;
+
+	/**
+	 * @brief Rendered help text plus the owner revision it was rendered for.
+	 *
+	 * Owners bump their revision whenever something shown in the help changes;
+	 * get() re-renders only when the revision differs from the cached one.
+	 * Not synchronized: same rules as the rest of a Parser's const interface.
+	 */
+	class HelpCache {
+	  public:
+		template <typename Render>
+		const std::string &get(std::uint64_t revision, Render &&render) {
+			if (! valid_ || revision_ != revision) {
+				text_.clear();
+				render(text_);
+				revision_ = revision;
+				valid_ = true;
+			}
+			return text_;
+		}
+
+		[[nodiscard]] std::size_t heap_bytes() const noexcept {
+			return detail::heap_bytes(text_);
+		}
+
+	  private:
+		std::string text_;
+		std::uint64_t revision_ = 0;
+		bool valid_ = false;
+	};
+
+}// namespace cli::detail
+
+#endif// CPPLI_HELP_HPP
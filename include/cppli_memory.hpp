@@ -0,0 +1,91 @@
+#ifndef CPPLI_MEMORY_HPP
+#define CPPLI_MEMORY_HPP
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cli {
+
+	/**
+	 * @brief Heap bytes held by a Parser, Subcommand, ParserSpec or ParseResult, by category.
+	 *
+	 * Each category counts allocated capacity, not used size: a vector of 10
+	 * ints with room for 16 counts 64 bytes. Strings count their heap buffer
+	 * only, so names short enough for the small-string buffer cost nothing
+	 * beyond the object that holds them. What a std::function's target
+	 * allocates is not observable; function_targets counts the ones that are
+	 * set instead, and is not part of total().
+	 *
+	 * Example:
+	 * @code
+	 * const cli::MemoryStats stats = parser.memory_stats();
+	 * std::printf("%zu bytes, %zu in subcommands\n", stats.total(), stats.subcommands);
+	 * @endcode
+	 */
+	struct MemoryStats {
+		std::size_t flags = 0;		 ///< TypedFlag / TypedPositional objects, their values and repeat buffers
+		std::size_t tables = 0;		 ///< name tables, short-name index, presence bits, name tries and lists
+		std::size_t strings = 0;	 ///< names, descriptions, environment names, examples and cached help text
+		std::size_t choices = 0;	 ///< set_choices / set_enum_choices vectors and their lookup index
+		std::size_t values = 0;		 ///< ParseResult value blocks, and per-parse state a Parser keeps
+		std::size_t subcommands = 0; ///< all of the above for subcommands and their subcommands, plus the objects
+		std::size_t function_targets = 0;///< validators, callbacks and lazy factories that are set, over the whole tree
+
+		/**
+		 * @brief Sum of the byte categories.
+		 */
+		[[nodiscard]] constexpr std::size_t total() const noexcept {
+			return flags + tables + strings + choices + values + subcommands;
+		}
+	};
+
+	namespace detail {
+
+		/**
+		 * @brief Heap bytes of a value held by a flag or result: string buffers and vector storage, recursively.
+		 */
+		template <typename T>
+		[[nodiscard]] std::size_t heap_bytes(const T &value) noexcept {
+			if constexpr (requires { typename T::traits_type; value.capacity(); value.data(); }) {
+				// A buffer inside the object itself is the small-string buffer.
+				const std::less<const void *> before;
+				const void *data = value.data();
+				if (! before(data, &value) && before(data, reinterpret_cast<const std::byte *>(&value) + sizeof(value))) {
+					return 0;
+				}
+				return (value.capacity() + 1) * sizeof(typename T::value_type);
+			} else if constexpr (requires { typename T::allocator_type; value.capacity(); value.begin(); }) {
+				std::size_t bytes = value.capacity() * sizeof(typename T::value_type);
+				for (const auto &element: value) {
+					bytes += heap_bytes(element);
+				}
+				return bytes;
+			} else {
+				return 0;
+			}
+		}
+
+		template <typename T>
+		[[nodiscard]] std::size_t heap_bytes(const std::optional<T> &value) noexcept {
+			return value.has_value() ? heap_bytes(*value) : 0;
+		}
+
+		/**
+		 * @brief Count a std::function in MemoryStats::function_targets if it is set.
+		 */
+		template <typename Signature>
+		void count_function(MemoryStats &stats, const std::function<Signature> &function) noexcept {
+			if (function) {
+				++stats.function_targets;
+			}
+		}
+
+	}// namespace detail
+
+}// namespace cli
+
+#endif// CPPLI_MEMORY_HPP
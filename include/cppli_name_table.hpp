@@ -0,0 +1,840 @@
+#ifndef CPPLI_NAME_TABLE_HPP
+#define CPPLI_NAME_TABLE_HPP
+
+#include "cppli_memory.hpp"
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cli::detail {
+
+	/**
+	 * @brief FNV-1a hash of a name, used by NameTable and the short-name index.
+	 */
+	[[nodiscard]] constexpr std::uint64_t hash_name(std::string_view name) noexcept {
+		std::uint64_t hash = 14695981039346656037ull;
+		for (char c: name) {
+			hash ^= static_cast<unsigned char>(c);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	/**
+	 * @brief Contiguous open-addressing hash table keyed by name.
+	 *
+	 * Entries live in one vector in insertion order; a power-of-two slot array
+	 * indexes them with linear probing. Lookups take a std::string_view and never
+	 * build a temporary std::string. A separate order index keeps entries sorted
+	 * by key so help output and validation can iterate alphabetically.
+	 *
+	 * Entries are never erased; insert_or_assign() replaces the value of an
+	 * existing key in place, mirroring std::map::operator[] assignment.
+	 *
+	 * @tparam V Mapped value type.
+	 */
+	template <typename V>
+	class NameTable {
+	  public:
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+		/**
+		 * @brief A key/value pair; supports structured bindings.
+		 */
+		struct Entry {
+			std::string key;
+			V value;
+		};
+
+		/**
+		 * @brief Iterable view over entries ordered by key.
+		 */
+		class SortedView {
+		  public:
+			class iterator {
+			  public:
+				iterator(const NameTable *table, const std::uint32_t *pos) : table_(table), pos_(pos) {
+				}
+
+				const Entry &operator*() const {
+					return table_->entries_[*pos_];
+				}
+
+				const Entry *operator->() const {
+					return &table_->entries_[*pos_];
+				}
+
+				iterator &operator++() {
+					++pos_;
+					return *this;
+				}
+
+				bool operator==(const iterator &other) const {
+					return pos_ == other.pos_;
+				}
+
+			  private:
+				const NameTable *table_;
+				const std::uint32_t *pos_;
+			};
+
+			explicit SortedView(const NameTable *table) : table_(table) {
+			}
+
+			[[nodiscard]] iterator begin() const {
+				return iterator(table_, table_->order_.data());
+			}
+
+			[[nodiscard]] iterator end() const {
+				return iterator(table_, table_->order_.data() + table_->order_.size());
+			}
+
+		  private:
+			const NameTable *table_;
+		};
+
+		/**
+		 * @brief Find the value stored under key.
+		 * @return Pointer to the value, or nullptr if absent.
+		 */
+		[[nodiscard]] V *find(std::string_view key) noexcept {
+			const auto index = find_index(key);
+			return index == npos ? nullptr : &entries_[index].value;
+		}
+
+		/**
+		 * @brief Find the value stored under key.
+		 * @return Pointer to the value, or nullptr if absent.
+		 */
+		[[nodiscard]] const V *find(std::string_view key) const noexcept {
+			const auto index = find_index(key);
+			return index == npos ? nullptr : &entries_[index].value;
+		}
+
+		/**
+		 * @brief Insertion index of key, or npos if absent.
+		 */
+		[[nodiscard]] std::size_t index_of(std::string_view key) const noexcept {
+			return find_index(key);
+		}
+
+		/**
+		 * @brief Entry at an insertion index returned by index_of().
+		 */
+		[[nodiscard]] Entry &at(std::size_t index) noexcept {
+			return entries_[index];
+		}
+
+		[[nodiscard]] const Entry &at(std::size_t index) const noexcept {
+			return entries_[index];
+		}
+
+		/**
+		 * @brief True if key is present.
+		 */
+		[[nodiscard]] bool contains(std::string_view key) const noexcept {
+			return find_index(key) != npos;
+		}
+
+		/**
+		 * @brief Insert a new entry or replace the value of an existing one.
+		 * @return V& Reference to the stored value (valid until the next insert).
+		 */
+		V &insert_or_assign(std::string key, V value) {
+			const auto hash = hash_name(key);
+			const auto existing = find_index(key, hash);
+			if (existing != npos) {
+				entries_[existing].value = std::move(value);
+				return entries_[existing].value;
+			}
+
+			if ((entries_.size() + 1) * 2 > slots_.size()) {
+				rehash(slots_.empty() ? 16 : slots_.size() * 2);
+			}
+
+			const auto index = static_cast<std::uint32_t>(entries_.size());
+			entries_.push_back({std::move(key), std::move(value)});
+			hashes_.push_back(hash);
+			place(index, hash);
+
+			auto pos = std::lower_bound(order_.begin(), order_.end(), entries_.back().key, [this](std::uint32_t i, const std::string &k) {
+				return entries_[i].key < k;
+			});
+			order_.insert(pos, index);
+
+			return entries_.back().value;
+		}
+
+		/**
+		 * @brief Remove all entries, keeping allocated capacity.
+		 */
+		void clear() noexcept {
+			entries_.clear();
+			hashes_.clear();
+			order_.clear();
+			std::fill(slots_.begin(), slots_.end(), 0u);
+		}
+
+		/**
+		 * @brief Reserve room for count entries without rehashing.
+		 */
+		void reserve(std::size_t count) {
+			entries_.reserve(count);
+			hashes_.reserve(count);
+			order_.reserve(count);
+			std::size_t wanted = 16;
+			while (wanted < count * 2) {
+				wanted *= 2;
+			}
+			if (wanted > slots_.size()) {
+				rehash(wanted);
+			}
+		}
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return entries_.size();
+		}
+
+		[[nodiscard]] bool empty() const noexcept {
+			return entries_.empty();
+		}
+
+		/** @name Insertion-order iteration */
+		///@{
+		[[nodiscard]] auto begin() noexcept {
+			return entries_.begin();
+		}
+		[[nodiscard]] auto end() noexcept {
+			return entries_.end();
+		}
+		[[nodiscard]] auto begin() const noexcept {
+			return entries_.begin();
+		}
+		[[nodiscard]] auto end() const noexcept {
+			return entries_.end();
+		}
+		///@}
+
+		/**
+		 * @brief Iterate entries ordered by key.
+		 */
+		[[nodiscard]] SortedView sorted() const noexcept {
+			return SortedView(this);
+		}
+
+		/**
+		 * @brief Bytes of the table's own arrays; key and value buffers are not included.
+		 */
+		[[nodiscard]] std::size_t heap_bytes() const noexcept {
+			return entries_.capacity() * sizeof(Entry) + hashes_.capacity() * sizeof(std::uint64_t) + (slots_.capacity() + order_.capacity()) * sizeof(std::uint32_t);
+		}
+
+	  private:
+		std::vector<Entry> entries_;		///< entries in insertion order
+		std::vector<std::uint64_t> hashes_; ///< cached hash per entry
+		std::vector<std::uint32_t> slots_;	///< 0 = empty, otherwise entry index + 1
+		std::vector<std::uint32_t> order_;	///< entry indices sorted by key
+
+		[[nodiscard]] std::size_t find_index(std::string_view key) const noexcept {
+			return find_index(key, hash_name(key));
+		}
+
+		[[nodiscard]] std::size_t find_index(std::string_view key, std::uint64_t hash) const noexcept {
+			if (slots_.empty()) {
+				return npos;
+			}
+
+			const std::size_t mask = slots_.size() - 1;
+			for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+				const auto stored = slots_[slot];
+				if (stored == 0) {
+					return npos;
+				}
+				const std::size_t index = stored - 1;
+				if (hashes_[index] == hash && entries_[index].key == key) {
+					return index;
+				}
+			}
+		}
+
+		void place(std::uint32_t index, std::uint64_t hash) noexcept {
+			const std::size_t mask = slots_.size() - 1;
+			std::size_t slot = hash & mask;
+			while (slots_[slot] != 0) {
+				slot = (slot + 1) & mask;
+			}
+			slots_[slot] = index + 1;
+		}
+
+		void rehash(std::size_t slot_count) {
+			slots_.assign(slot_count, 0u);
+			for (std::size_t i = 0; i < entries_.size(); ++i) {
+				place(static_cast<std::uint32_t>(i), hashes_[i]);
+			}
+		}
+	};
+
+	/**
+	 * @brief Compact trie over a NameTable's keys for abbreviations and "did you mean" suggestions.
+	 *
+	 * Nodes live in one vector and link to their first child and next sibling;
+	 * siblings are kept sorted by byte, so walks visit names in key order.
+	 * Every node counts the names below it, which makes complete() a single
+	 * walk down the prefix. closest() walks the trie with one edit-distance
+	 * row per depth and drops a branch as soon as its row exceeds the bound,
+	 * so only the paths near the input are visited, however many names there
+	 * are.
+	 *
+	 * Ids are NameTable insertion indices (NameTable::at).
+	 */
+	class NameTrie {
+	  public:
+		static constexpr std::uint32_t npos = ~std::uint32_t{0};
+
+		/**
+		 * @brief Result of complete(): the one matching id, or whether several names matched.
+		 */
+		struct Completion {
+			std::uint32_t id = npos;
+			bool ambiguous = false;
+		};
+
+		NameTrie() : nodes_(1) {
+		}
+
+		template <typename V>
+		explicit NameTrie(const NameTable<V> &table) : nodes_(1) {
+			std::uint32_t id = 0;
+			for (const auto &entry: table) {
+				insert(entry.key, id++);
+			}
+		}
+
+		/**
+		 * @brief Add name with id; name must not be present yet.
+		 */
+		void insert(std::string_view name, std::uint32_t id) {
+			std::uint32_t node = 0;
+			count(node, id);
+			for (const char c: name) {
+				node = child_or_insert(node, c);
+				count(node, id);
+			}
+			nodes_[node].id = id;
+		}
+
+		/**
+		 * @brief The name that prefix is the whole of, or else the only name that starts with it.
+		 */
+		[[nodiscard]] Completion complete(std::string_view prefix) const noexcept {
+			std::uint32_t node = 0;
+			for (const char c: prefix) {
+				node = child(node, c);
+				if (node == npos) {
+					return {};
+				}
+			}
+			if (nodes_[node].id != npos) {
+				return {nodes_[node].id};
+			}
+			if (nodes_[node].names == 1) {
+				return {nodes_[node].first_id};
+			}
+			return {npos, nodes_[node].names > 1};
+		}
+
+		/**
+		 * @brief Id of the name nearest to input, or npos if none is close enough.
+		 *
+		 * Distance counts insertions, deletions, substitutions and swaps of
+		 * adjacent characters. Up to one edit is allowed for inputs of five
+		 * characters or fewer, two for longer ones; ties go to the name that
+		 * sorts first.
+		 */
+		[[nodiscard]] std::uint32_t closest(std::string_view input) const {
+			Search search;
+			search.input = input;
+			search.bound = input.size() > 5 ? 2 : 1;
+			search.rows.resize(input.size() + 1);
+			for (std::size_t j = 0; j <= input.size(); ++j) {
+				search.rows[j] = static_cast<std::uint32_t>(j);
+			}
+			for (std::uint32_t next = nodes_[0].first_child; next != npos; next = nodes_[next].next_sibling) {
+				visit(search, next, 1);
+			}
+			return search.best_id;
+		}
+
+		[[nodiscard]] std::size_t heap_bytes() const noexcept {
+			return nodes_.capacity() * sizeof(Node);
+		}
+
+	  private:
+		struct Node {
+			std::uint32_t first_child = npos;
+			std::uint32_t next_sibling = npos;
+			std::uint32_t id = npos;	  ///< id of the name ending here
+			std::uint32_t first_id = npos;///< id of the first name inserted below
+			std::uint32_t names = 0;	  ///< names ending here or below
+			char label = 0;
+		};
+
+		struct Search {
+			std::string_view input;
+			std::uint32_t bound = 0;
+			std::vector<std::uint32_t> rows;///< one edit-distance row per depth, root first
+			std::vector<char> path;			///< labels from the root to the current node
+			std::uint32_t best_id = npos;
+			std::uint32_t best_distance = ~std::uint32_t{0};
+		};
+
+		std::vector<Node> nodes_;///< nodes_[0] is the root
+
+		void count(std::uint32_t node, std::uint32_t id) noexcept {
+			if (nodes_[node].names++ == 0) {
+				nodes_[node].first_id = id;
+			}
+		}
+
+		[[nodiscard]] std::uint32_t child(std::uint32_t node, char c) const noexcept {
+			for (std::uint32_t next = nodes_[node].first_child; next != npos && nodes_[next].label <= c; next = nodes_[next].next_sibling) {
+				if (nodes_[next].label == c) {
+					return next;
+				}
+			}
+			return npos;
+		}
+
+		std::uint32_t child_or_insert(std::uint32_t node, char c) {
+			std::uint32_t previous = npos;
+			std::uint32_t next = nodes_[node].first_child;
+			while (next != npos && nodes_[next].label < c) {
+				previous = next;
+				next = nodes_[next].next_sibling;
+			}
+			if (next != npos && nodes_[next].label == c) {
+				return next;
+			}
+
+			const auto inserted = static_cast<std::uint32_t>(nodes_.size());
+			Node fresh;
+			fresh.label = c;
+			fresh.next_sibling = next;
+			nodes_.push_back(fresh);
+			(previous == npos ? nodes_[node].first_child : nodes_[previous].next_sibling) = inserted;
+			return inserted;
+		}
+
+		void visit(Search &search, std::uint32_t node, std::size_t depth) const {
+			const std::size_t width = search.input.size() + 1;
+			const char c = nodes_[node].label;
+			search.rows.resize((depth + 1) * width);
+			search.path.resize(depth);
+			search.path[depth - 1] = c;
+
+			std::uint32_t *row = search.rows.data() + depth * width;
+			const std::uint32_t *above = row - width;
+			row[0] = static_cast<std::uint32_t>(depth);
+			std::uint32_t smallest = row[0];
+			for (std::size_t j = 1; j < width; ++j) {
+				const char wanted = search.input[j - 1];
+				row[j] = std::min({above[j] + 1, row[j - 1] + 1, above[j - 1] + (wanted == c ? 0u : 1u)});
+				if (depth > 1 && j > 1 && wanted == search.path[depth - 2] && search.input[j - 2] == c) {
+					row[j] = std::min(row[j], search.rows[(depth - 2) * width + j - 2] + 1);
+				}
+				smallest = std::min(smallest, row[j]);
+			}
+			if (smallest > search.bound) {
+				return;
+			}
+
+			const std::uint32_t distance = row[width - 1];
+			if (nodes_[node].id != npos && distance <= search.bound && distance < search.best_distance) {
+				search.best_id = nodes_[node].id;
+				search.best_distance = distance;
+			}
+			for (std::uint32_t next = nodes_[node].first_child; next != npos; next = nodes_[next].next_sibling) {
+				visit(search, next, depth + 1);
+			}
+		}
+	};
+
+	/**
+	 * @brief NameTrie kept for a growing NameTable; rebuilt on use after keys were added.
+	 *
+	 * Relies on NameTable entries never being erased, so the key count tells
+	 * whether the trie is current.
+	 */
+	class LazyNameTrie {
+	  public:
+		template <typename V>
+		[[nodiscard]] const NameTrie &get(const NameTable<V> &table) {
+			if (built_for_ != table.size()) {
+				trie_ = NameTrie(table);
+				built_for_ = table.size();
+			}
+			return trie_;
+		}
+
+		[[nodiscard]] std::size_t heap_bytes() const noexcept {
+			return trie_.heap_bytes();
+		}
+
+	  private:
+		NameTrie trie_;
+		std::size_t built_for_ = 0;
+	};
+
+	/**
+	 * @brief Insertion index of a looked-up name, see lookup_name().
+	 */
+	struct NameLookup {
+		std::size_t index = static_cast<std::size_t>(-1);
+		bool ambiguous = false;///< abbreviation of more than one name
+	};
+
+	/**
+	 * @brief Find name in table, or the one key it abbreviates when abbreviations is set.
+	 */
+	template <typename V>
+	[[nodiscard]] NameLookup lookup_name(const NameTable<V> &table, const NameTrie *abbreviations, std::string_view name) noexcept {
+		if (const auto index = table.index_of(name); index != NameTable<V>::npos || abbreviations == nullptr || name.empty()) {
+			return {index};
+		}
+		const auto completion = abbreviations->complete(name);
+		if (completion.id == NameTrie::npos) {
+			return {NameTable<V>::npos, completion.ambiguous};
+		}
+		return {completion.id};
+	}
+
+	/**
+	 * @brief Key of table nearest to name (see NameTrie::closest), or empty if none is close.
+	 */
+	template <typename V>
+	[[nodiscard]] std::string_view closest_name(const NameTable<V> &table, const NameTrie &names, std::string_view name) {
+		const auto id = names.closest(name);
+		return id == NameTrie::npos ? std::string_view{} : std::string_view(table.at(id).key);
+	}
+
+	/**
+	 * @brief Short-name -> flag index lookup, maintained as short names change.
+	 *
+	 * Single-character names (the common case) resolve through a 256-entry
+	 * table indexed by the character; longer aliases fall back to a NameTable.
+	 * Flags registered with a Parser or Subcommand are attached to its index, so
+	 * TypedFlag<T>::set_short_name() updates it in place and parsing never has to
+	 * re-index the flag table.
+	 *
+	 * The index also counts changes to its attached flags (revision()), which
+	 * owners use to invalidate cached help text.
+	 */
+	class ShortNameIndex {
+	  public:
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+		/**
+		 * @brief Make name resolve to flag_index; an empty name is ignored.
+		 */
+		void add(std::string_view name, std::uint32_t flag_index) {
+			++revision_;
+			if (name.size() == 1) {
+				single_[static_cast<unsigned char>(name[0])] = flag_index + 1;
+			} else if (! name.empty()) {
+				multi_.insert_or_assign(std::string(name), flag_index + 1);
+			}
+		}
+
+		/**
+		 * @brief Stop resolving name, if it currently resolves to flag_index.
+		 */
+		void remove(std::string_view name, std::uint32_t flag_index) noexcept {
+			++revision_;
+			if (name.size() == 1) {
+				auto &slot = single_[static_cast<unsigned char>(name[0])];
+				if (slot == flag_index + 1) {
+					slot = 0;
+				}
+			} else if (auto *slot = multi_.find(name); slot != nullptr && *slot == flag_index + 1) {
+				*slot = 0;
+			}
+		}
+
+		/**
+		 * @brief Replace old_name with new_name for flag_index.
+		 */
+		void rename(std::string_view old_name, std::string_view new_name, std::uint32_t flag_index) {
+			remove(old_name, flag_index);
+			add(new_name, flag_index);
+		}
+
+		/**
+		 * @brief Flag index for a short name (without dash), or npos.
+		 */
+		[[nodiscard]] std::size_t find(std::string_view name) const noexcept {
+			std::uint32_t stored = 0;
+			if (name.size() == 1) {
+				stored = single_[static_cast<unsigned char>(name[0])];
+			} else if (const auto *slot = multi_.find(name); slot != nullptr) {
+				stored = *slot;
+			}
+			return stored == 0 ? npos : stored - 1;
+		}
+
+		/**
+		 * @brief Record a change to an attached flag that does not touch its short name.
+		 */
+		void touch() noexcept {
+			++revision_;
+		}
+
+		/**
+		 * @brief Number of changes so far; differs whenever an attached flag changed.
+		 */
+		[[nodiscard]] std::uint64_t revision() const noexcept {
+			return revision_;
+		}
+
+		/**
+		 * @brief Heap bytes of the multi-character alias table, keys included.
+		 */
+		[[nodiscard]] std::size_t heap_bytes() const noexcept {
+			std::size_t bytes = multi_.heap_bytes();
+			for (const auto &entry: multi_) {
+				bytes += detail::heap_bytes(entry.key);
+			}
+			return bytes;
+		}
+
+	  private:
+		std::array<std::uint32_t, 256> single_{};///< 0 = none, otherwise flag index + 1
+		NameTable<std::uint32_t> multi_;		 ///< multi-character aliases, same encoding
+		std::uint64_t revision_ = 0;
+	};
+
+	/**
+	 * @brief Link from a registered flag back to its owner's ShortNameIndex.
+	 *
+	 * Copies and moves are detached, so a cloned flag (e.g. in a ParserSpec)
+	 * never updates the index of the Parser it was copied from.
+	 */
+	struct ShortNameHook {
+		ShortNameIndex *index = nullptr;
+		std::uint32_t flag_index = 0;
+
+		ShortNameHook() = default;
+		ShortNameHook(const ShortNameHook &) noexcept {
+		}
+		ShortNameHook &operator=(const ShortNameHook &) noexcept {
+			index = nullptr;
+			return *this;
+		}
+	};
+
+	/**
+	 * @brief Required and has-value bits of a command's flags or positionals, by registration index.
+	 *
+	 * Attached flags and positionals keep their bits current, so checking a
+	 * command's requirements compares a few words instead of calling two
+	 * type-erased functions per flag.
+	 */
+	class PresenceBits {
+	  public:
+		/**
+		 * @brief Make room for index; called once when a flag or positional is attached.
+		 */
+		void reserve_index(std::uint32_t index) {
+			const std::size_t words = index / 64 + 1;
+			if (required_.size() < words) {
+				required_.resize(words, 0);
+				present_.resize(words, 0);
+			}
+		}
+
+		/**
+		 * @brief Record the state of an attached member; index must have been reserved.
+		 */
+		void update(std::uint32_t index, bool required, bool present) noexcept {
+			const std::uint64_t bit = std::uint64_t{1} << (index % 64);
+			required_[index / 64] = required ? required_[index / 64] | bit : required_[index / 64] & ~bit;
+			present_[index / 64] = present ? present_[index / 64] | bit : present_[index / 64] & ~bit;
+		}
+
+		[[nodiscard]] bool present(std::size_t index) const noexcept {
+			return index / 64 < present_.size() && (present_[index / 64] >> (index % 64)) & 1u;
+		}
+
+		/**
+		 * @brief True if every required member has a value.
+		 */
+		[[nodiscard]] bool satisfied() const noexcept {
+			for (std::size_t word = 0; word < required_.size(); ++word) {
+				if ((required_[word] & ~present_[word]) != 0) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		[[nodiscard]] std::size_t heap_bytes() const noexcept {
+			return (required_.capacity() + present_.capacity()) * sizeof(std::uint64_t);
+		}
+
+	  private:
+		std::vector<std::uint64_t> required_;
+		std::vector<std::uint64_t> present_;
+	};
+
+	/**
+	 * @brief Presence bits of one command level: flags and positionals are indexed separately.
+	 */
+	struct CommandPresence {
+		PresenceBits flags;
+		PresenceBits positionals;
+
+		[[nodiscard]] bool satisfied() const noexcept {
+			return flags.satisfied() && positionals.satisfied();
+		}
+
+		[[nodiscard]] std::size_t heap_bytes() const noexcept {
+			return flags.heap_bytes() + positionals.heap_bytes();
+		}
+	};
+
+	/**
+	 * @brief Link from a registered flag or positional to its owner's PresenceBits.
+	 *
+	 * Copies are detached, like ShortNameHook.
+	 */
+	struct PresenceHook {
+		PresenceBits *bits = nullptr;
+		std::uint32_t index = 0;
+
+		PresenceHook() = default;
+		PresenceHook(const PresenceHook &) noexcept {
+		}
+		PresenceHook &operator=(const PresenceHook &) noexcept {
+			bits = nullptr;
+			return *this;
+		}
+
+		void update(bool required, bool present) const noexcept {
+			if (bits != nullptr) {
+				bits->update(index, required, present);
+			}
+		}
+	};
+
+	/**
+	 * @brief Hash used by ChoiceIndex: FNV-1a for strings, a 64-bit mix for integers and enums.
+	 */
+	template <typename T>
+	[[nodiscard]] std::uint64_t hash_choice(const T &value) noexcept {
+		if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+			return hash_name(value);
+		} else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+			auto x = static_cast<std::uint64_t>(value);
+			x ^= x >> 33;
+			x *= 0xff51afd7ed558ccdull;
+			x ^= x >> 33;
+			return x;
+		} else {
+			return std::hash<T>{}(value);
+		}
+	}
+
+	/**
+	 * @brief True if ChoiceIndex can hash T; other types are always scanned linearly.
+	 */
+	template <typename T>
+	concept hashable_choice = std::is_convertible_v<const T &, std::string_view> || std::is_integral_v<T> || std::is_enum_v<T> ||
+							  requires(const T &value) {
+								  { std::hash<T>{}(value) } -> std::convertible_to<std::size_t>;
+							  };
+
+	/**
+	 * @brief Open-addressing index over a flag's allowed values.
+	 *
+	 * Only the slot array lives here; the values stay in the caller's choices
+	 * vector, which is passed to every call, so copying a flag copies a valid
+	 * index. Sets of up to linear_limit values, and types without a hash, are
+	 * scanned linearly instead.
+	 */
+	template <typename T>
+	class ChoiceIndex {
+	  public:
+		static constexpr std::size_t linear_limit = 8;
+
+		/**
+		 * @brief Rebuild the index for choices (call after every change to it).
+		 */
+		void build(const std::vector<T> &choices) {
+			slots_.clear();
+			if constexpr (hashable_choice<T>) {
+				if (choices.size() <= linear_limit) {
+					return;
+				}
+
+				std::size_t slot_count = 16;
+				while (slot_count < choices.size() * 2) {
+					slot_count *= 2;
+				}
+				slots_.assign(slot_count, 0u);
+
+				const std::size_t mask = slot_count - 1;
+				for (std::size_t i = 0; i < choices.size(); ++i) {
+					std::size_t slot = hash_choice(choices[i]) & mask;
+					while (slots_[slot] != 0) {
+						slot = (slot + 1) & mask;
+					}
+					slots_[slot] = static_cast<std::uint32_t>(i + 1);
+				}
+			}
+		}
+
+		/**
+		 * @brief True if value equals one of choices.
+		 */
+		[[nodiscard]] bool contains(const std::vector<T> &choices, const T &value) const {
+			if constexpr (hashable_choice<T>) {
+				if (! slots_.empty()) {
+					const std::size_t mask = slots_.size() - 1;
+					for (std::size_t slot = hash_choice(value) & mask;; slot = (slot + 1) & mask) {
+						const auto stored = slots_[slot];
+						if (stored == 0) {
+							return false;
+						}
+						if (choices[stored - 1] == value) {
+							return true;
+						}
+					}
+				}
+			}
+
+			for (const auto &choice: choices) {
+				if (choice == value) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		[[nodiscard]] std::size_t heap_bytes() const noexcept {
+			return slots_.capacity() * sizeof(std::uint32_t);
+		}
+
+	  private:
+		std::vector<std::uint32_t> slots_;///< 0 = empty, otherwise choice index + 1
+	};
+
+}// namespace cli::detail
+
+#endif// CPPLI_NAME_TABLE_HPP
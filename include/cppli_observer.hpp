@@ -0,0 +1,203 @@
+#ifndef CPPLI_OBSERVER_HPP
+#define CPPLI_OBSERVER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace cli {
+
+	/**
+	 * @brief A timed step of Parser::parse, reported to a ParseObserver.
+	 *
+	 * Stages nest: Parse contains the others, and Subcommand contains the
+	 * Convert/Validate stages of that subcommand's values. Time spent
+	 * tokenizing and looking up flags is the part of Parse (or Subcommand) not
+	 * covered by a nested stage.
+	 */
+	enum class ParseStage : std::uint8_t {
+		Parse,		  ///< a whole Parser::parse call
+		ResponseFiles,///< expanding `@file` arguments
+		Subcommand,	  ///< parsing one subcommand's arguments
+		Convert,	  ///< ValueConverter<T>::from_string (or enum name lookup) for one value
+		Validate,	  ///< choices and Validator<T> for one value
+		Requirements, ///< validate_requirements() of a command level
+		Callback,	  ///< a subcommand callback run by invoke_callback()
+	};
+
+	inline constexpr std::size_t parse_stage_count = 7;
+
+	/**
+	 * @brief Lower-case name of a stage, e.g. "convert", for logs and trace exports.
+	 */
+	[[nodiscard]] constexpr std::string_view to_string(ParseStage stage) noexcept {
+		constexpr std::array<std::string_view, parse_stage_count> names = {"parse", "response_files", "subcommand", "convert", "validate", "requirements", "callback"};
+		return names[static_cast<std::size_t>(stage)];
+	}
+
+	/**
+	 * @brief One finished stage.
+	 *
+	 * The views are valid only during the on_stage_end() call.
+	 */
+	struct ParseEvent {
+		ParseStage stage;
+		std::string_view command;		 ///< app name or subcommand name the stage ran for
+		std::string_view name;			 ///< flag long name or positional name; empty for whole-command stages
+		std::chrono::nanoseconds elapsed;///< wall time of the stage
+		std::uint64_t allocations;		 ///< ParseObserver::allocation_count() delta over the stage
+		bool failed;					 ///< the stage returned an error (e.g. a value was rejected)
+	};
+
+	/**
+	 * @brief Receives stage events from Parser::parse (see Parser::set_observer).
+	 *
+	 * Without an observer, parsing only pays a null-pointer check per stage.
+	 * The library cannot see global heap allocations itself; override
+	 * allocation_count() with the application's counter (a replaced operator
+	 * new, allocator statistics, ...) to get per-stage allocation deltas.
+	 */
+	class ParseObserver {
+	  public:
+		virtual ~ParseObserver() = default;
+
+		/**
+		 * @brief Called when a stage starts.
+		 */
+		virtual void on_stage_begin(ParseStage stage, std::string_view command, std::string_view name) {
+			(void) stage;
+			(void) command;
+			(void) name;
+		}
+
+		/**
+		 * @brief Called when a stage ends, with its elapsed time and outcome.
+		 */
+		virtual void on_stage_end(const ParseEvent &event) = 0;
+
+		/**
+		 * @brief Running allocation count used for ParseEvent::allocations; 0 by default.
+		 */
+		[[nodiscard]] virtual std::uint64_t allocation_count() const noexcept {
+			return 0;
+		}
+	};
+
+	/**
+	 * @brief Observer that sums events per stage, ready to export.
+	 *
+	 * Example:
+	 * @code
+	 * cli::ParseStats stats;
+	 * parser.set_observer(&stats);
+	 * auto result = parser.parse(argc, argv);
+	 * auto convert = stats[cli::ParseStage::Convert];
+	 * std::printf("%llu conversions took %lld ns\n", convert.count, convert.elapsed.count());
+	 * @endcode
+	 */
+	class ParseStats : public ParseObserver {
+	  public:
+		struct Totals {
+			std::uint64_t count = 0;			 ///< stages finished
+			std::uint64_t failures = 0;			 ///< stages that returned an error
+			std::uint64_t allocations = 0;		 ///< summed allocation deltas
+			std::chrono::nanoseconds elapsed{0}; ///< summed wall time
+		};
+
+		void on_stage_end(const ParseEvent &event) override {
+			auto &totals = totals_[static_cast<std::size_t>(event.stage)];
+			++totals.count;
+			totals.failures += event.failed ? 1 : 0;
+			totals.allocations += event.allocations;
+			totals.elapsed += event.elapsed;
+		}
+
+		[[nodiscard]] const Totals &operator[](ParseStage stage) const noexcept {
+			return totals_[static_cast<std::size_t>(stage)];
+		}
+
+		/**
+		 * @brief Values rejected by conversion or validation, plus failed requirement checks.
+		 */
+		[[nodiscard]] std::uint64_t validation_failures() const noexcept {
+			return (*this)[ParseStage::Convert].failures + (*this)[ParseStage::Validate].failures + (*this)[ParseStage::Requirements].failures;
+		}
+
+		void reset() noexcept {
+			totals_ = {};
+		}
+
+	  private:
+		std::array<Totals, parse_stage_count> totals_{};
+	};
+
+	namespace detail {
+
+		/**
+		 * @brief An observer plus the command name its events are attributed to.
+		 *
+		 * Passed down the parse as a pointer; nullptr means no observer.
+		 */
+		class ParseTrace {
+		  public:
+			ParseTrace(ParseObserver &observer, std::string_view command) noexcept : observer_(&observer), command_(command) {
+			}
+
+			[[nodiscard]] ParseObserver &observer() const noexcept {
+				return *observer_;
+			}
+
+			/**
+			 * @brief Run fn as one stage; fn returns a Result.
+			 */
+			template <typename Fn>
+			auto run(ParseStage stage, std::string_view name, Fn &&fn) const {
+				observer_->on_stage_begin(stage, command_, name);
+				const auto allocations = observer_->allocation_count();
+				const auto start = std::chrono::steady_clock::now();
+
+				auto result = fn();
+
+				const ParseEvent event{stage, command_, name, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start),
+									   observer_->allocation_count() - allocations, ! result.has_value()};
+				observer_->on_stage_end(event);
+				return result;
+			}
+
+		  private:
+			ParseObserver *observer_;
+			std::string_view command_;
+		};
+
+		/**
+		 * @brief Run fn as a stage of trace, or just run it if there is no trace.
+		 */
+		template <typename Fn>
+		auto traced(const ParseTrace *trace, ParseStage stage, std::string_view name, Fn &&fn) {
+			if (trace == nullptr) [[likely]] {
+				return fn();
+			}
+			return trace->run(stage, name, fn);
+		}
+
+		/**
+		 * @brief Trace for a command level: its own observer, else the parent's, else none.
+		 */
+		[[nodiscard]] inline std::optional<ParseTrace> make_trace(ParseObserver *own, const ParseTrace *parent, std::string_view command) noexcept {
+			if (own != nullptr) {
+				return ParseTrace(*own, command);
+			}
+			if (parent != nullptr) {
+				return ParseTrace(parent->observer(), command);
+			}
+			return std::nullopt;
+		}
+
+	}// namespace detail
+
+}// namespace cli
+
+#endif// CPPLI_OBSERVER_HPP
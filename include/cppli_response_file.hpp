@@ -0,0 +1,119 @@
+#ifndef CPPLI_RESPONSE_FILE_HPP
+#define CPPLI_RESPONSE_FILE_HPP
+
+#include "cppli_error.hpp"
+#include <cstddef>
+#include <deque>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cli::detail {
+
+	/**
+	 * @brief Read-only memory mapping of a whole file.
+	 *
+	 * Move-only. An empty file maps to an empty view without calling mmap.
+	 */
+	class MappedFile {
+	  public:
+		MappedFile() = default;
+		MappedFile(MappedFile &&other) noexcept;
+		MappedFile &operator=(MappedFile &&other) noexcept;
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+		~MappedFile();
+
+		/**
+		 * @brief Map a file, or return std::nullopt if it cannot be opened or mapped.
+		 */
+		[[nodiscard]] static std::optional<MappedFile> open(const std::string &path);
+
+		[[nodiscard]] std::string_view contents() const noexcept {
+			return {static_cast<const char *>(data_), size_};
+		}
+
+	  private:
+		const void *data_ = nullptr;
+		std::size_t size_ = 0;
+
+		void unmap() noexcept;
+	};
+
+	/**
+	 * @brief Lazy shell-style tokenizer over a response file's contents.
+	 *
+	 * Tokens are separated by whitespace. Single quotes are literal, double
+	 * quotes allow backslash escapes of `"`, `\`, `$` and `` ` ``, and an
+	 * unquoted backslash escapes the next character. Tokens that need no
+	 * unescaping are returned as views into the input; the rest are built in
+	 * @p scratch, whose elements are never moved. An unterminated quote runs to
+	 * the end of the input.
+	 */
+	class ResponseFileTokenizer {
+	  public:
+		ResponseFileTokenizer(std::string_view text, std::pmr::deque<std::pmr::string> &scratch) : text_(text), scratch_(scratch) {
+		}
+
+		/**
+		 * @brief Next token, std::nullopt at end of input.
+		 */
+		[[nodiscard]] std::optional<std::string_view> next();
+
+	  private:
+		std::string_view text_;
+		std::size_t pos_ = 0;
+		std::pmr::deque<std::pmr::string> &scratch_;
+	};
+
+	/**
+	 * @brief Expands `@file` arguments in place for one parse call.
+	 *
+	 * Arguments that do not start with '@' are passed through unchanged, so a
+	 * command line without response files costs one scan and no allocation.
+	 * As with GCC, an `@name` that cannot be opened is kept as a literal
+	 * argument. Expansion stops after a top-level `--`. Response files may
+	 * reference further response files up to a fixed nesting depth.
+	 *
+	 * The expander owns the mappings, so the returned views are valid for as
+	 * long as it lives. Its token list and unescaped tokens are allocated from
+	 * the given memory resource. The token list holds one view per expanded
+	 * token, so its size grows with the token count, not the file size (see
+	 * Parser::parse).
+	 */
+	class ResponseFileExpander {
+	  public:
+		explicit ResponseFileExpander(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+			: files_(resource), scratch_(resource), tokens_(resource) {
+		}
+
+		/**
+		 * @brief Return @p args with response files expanded.
+		 * @return The original span if there was nothing to expand.
+		 */
+		[[nodiscard]] Result<std::span<const std::string_view>> expand(std::span<const std::string_view> args);
+
+	  private:
+		static constexpr int max_depth = 16;
+
+		std::pmr::vector<MappedFile> files_;
+		std::pmr::deque<std::pmr::string> scratch_;
+		std::pmr::vector<std::string_view> tokens_;
+		bool after_double_dash_ = false;
+
+		[[nodiscard]] Result<void> append(std::string_view arg, int depth);
+	};
+
+	/**
+	 * @brief True if the argument looks like a response-file reference.
+	 */
+	[[nodiscard]] constexpr bool is_response_file_arg(std::string_view arg) noexcept {
+		return arg.size() > 1 && arg[0] == '@';
+	}
+
+}// namespace cli::detail
+
+#endif// CPPLI_RESPONSE_FILE_HPP
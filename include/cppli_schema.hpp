@@ -0,0 +1,374 @@
+#ifndef CPPLI_SCHEMA_HPP
+#define CPPLI_SCHEMA_HPP
+
+#include "cppli_error.hpp"
+#include "cppli_name_table.hpp"
+#include "cppli_tokenizer.hpp"
+#include "cppli_types.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cli {
+
+	/**
+	 * @brief Compile-time flag declaration for Schema.
+	 *
+	 * The long name, value type and description are template arguments; the
+	 * short name is the only aggregate member so a declaration reads
+	 * `Flag<"port", int>{'p'}`. Runtime options (required, default, choices,
+	 * validator) are configured on the TypedFlag<T> returned by Schema::flag().
+	 *
+	 * @tparam Name Long name without dashes.
+	 * @tparam T Value type; must have a ValueConverter<T> specialization.
+	 * @tparam Description Help text passed to TypedFlag<T>.
+	 */
+	template <FixedString Name, typename T, FixedString Description = "">
+	struct Flag {
+		using value_type = T;
+		static constexpr std::string_view name = Name.view();
+		static constexpr std::string_view description = Description.view();
+
+		char short_name = '\0';///< single-character alias, or '\0' for none
+	};
+
+	namespace detail {
+
+		template <typename>
+		inline constexpr bool is_schema_flag = false;
+
+		template <FixedString Name, typename T, FixedString Description>
+		inline constexpr bool is_schema_flag<Flag<Name, T, Description>> = true;
+
+		/**
+		 * @brief Secondary hash used by the displacement step of SchemaIndex.
+		 */
+		[[nodiscard]] constexpr std::uint64_t mix_hash(std::uint64_t hash, std::uint64_t seed) noexcept {
+			hash ^= (seed + 1) * 0x9E3779B97F4A7C15ull;
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 33;
+			return hash;
+		}
+
+		/**
+		 * @brief Perfect hash over N long names plus a direct short-name table.
+		 *
+		 * Built entirely at compile time with hash-and-displace: names are grouped
+		 * into N buckets by hash_name(), and each bucket gets the first seed that
+		 * sends all its names to free slots of a table twice the size of N.
+		 * A lookup is two hashes, one slot load and a single string compare.
+		 */
+		template <std::size_t N>
+		struct SchemaIndex {
+			static constexpr std::size_t table_size = std::bit_ceil(N * 2);
+			static constexpr std::size_t empty = N;
+
+			std::array<std::string_view, N> names{};
+			std::array<std::uint32_t, N> seeds{};
+			std::array<std::size_t, table_size> slots{};
+			std::array<std::size_t, 256> shorts{};
+
+			constexpr SchemaIndex(const std::array<std::string_view, N> &long_names, const std::array<char, N> &short_names) : names(long_names) {
+				slots.fill(empty);
+				shorts.fill(empty);
+
+				for (std::size_t i = 0; i < N; ++i) {
+					if (short_names[i] != '\0') {
+						shorts[static_cast<unsigned char>(short_names[i])] = i;
+					}
+				}
+
+				std::array<std::uint64_t, N> hashes{};
+				std::array<std::size_t, N> bucket_size{};
+				for (std::size_t i = 0; i < N; ++i) {
+					hashes[i] = hash_name(names[i]);
+					++bucket_size[hashes[i] % N];
+				}
+
+				std::array<std::size_t, N> order{};
+				for (std::size_t b = 0; b < N; ++b) {
+					order[b] = b;
+				}
+				std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+					return bucket_size[a] > bucket_size[b];
+				});
+
+				for (std::size_t bucket: order) {
+					if (bucket_size[bucket] == 0) {
+						break;
+					}
+
+					for (std::uint32_t seed = 0;; ++seed) {
+						std::array<std::size_t, N> taken{};
+						std::size_t count = 0;
+						bool fits = true;
+
+						for (std::size_t i = 0; i < N && fits; ++i) {
+							if (hashes[i] % N != bucket) {
+								continue;
+							}
+							const std::size_t slot = mix_hash(hashes[i], seed) & (table_size - 1);
+							fits = slots[slot] == empty && std::find(taken.begin(), taken.begin() + count, slot) == taken.begin() + count;
+							taken[count++] = slot;
+						}
+
+						if (fits) {
+							seeds[bucket] = seed;
+							std::size_t next = 0;
+							for (std::size_t i = 0; i < N; ++i) {
+								if (hashes[i] % N == bucket) {
+									slots[taken[next++]] = i;
+								}
+							}
+							break;
+						}
+					}
+				}
+			}
+
+			/**
+			 * @brief Index of the flag with this long name, or N if unknown.
+			 */
+			[[nodiscard]] constexpr std::size_t find(std::string_view name) const noexcept {
+				const auto hash = hash_name(name);
+				const std::size_t index = slots[mix_hash(hash, seeds[hash % N]) & (table_size - 1)];
+				return index != empty && names[index] == name ? index : empty;
+			}
+
+			/**
+			 * @brief Index of the flag with this short name, or N if unknown.
+			 */
+			[[nodiscard]] constexpr std::size_t find_short(char name) const noexcept {
+				return shorts[static_cast<unsigned char>(name)];
+			}
+		};
+
+	}// namespace detail
+
+	/**
+	 * @brief A whole CLI declared as one compile-time description.
+	 *
+	 * Long names resolve through a perfect hash and short names through a
+	 * 256-entry table, both generated from the template arguments. Values live
+	 * in a std::tuple of TypedFlag<T>, so get<"port">() is a member load with no
+	 * string compare and no type erasure.
+	 *
+	 * Example:
+	 * @code
+	 * cli::Schema<cli::Flag<"port", int, "Port number">{'p'},
+	 *             cli::Flag<"verbose", bool>{'v'}> schema;
+	 * schema.flag<"port">().set_required().set_choices({80, 443, 8080});
+	 *
+	 * auto result = schema.parse(argc, argv);
+	 * if (result) {
+	 *     int port = *schema.get<"port">();
+	 * }
+	 * @endcode
+	 *
+	 * Non-flag tokens are collected as views into the parsed arguments and are
+	 * available through positionals().
+	 *
+	 * @tparam Flags One or more Flag<...>{...} declarations.
+	 */
+	template <auto... Flags>
+	class Schema {
+		static_assert(sizeof...(Flags) > 0, "Schema needs at least one flag");
+		static_assert((detail::is_schema_flag<std::remove_cvref_t<decltype(Flags)>> && ...), "Schema arguments must be cli::Flag<...>{...}");
+
+		static constexpr std::size_t flag_count = sizeof...(Flags);
+
+		static constexpr std::array<std::string_view, flag_count> long_names = {std::remove_cvref_t<decltype(Flags)>::name...};
+		static constexpr std::array<char, flag_count> short_names = {Flags.short_name...};
+		static constexpr std::array<bool, flag_count> boolean_flags = {std::is_same_v<typename std::remove_cvref_t<decltype(Flags)>::value_type, bool>...};
+		static constexpr detail::SchemaIndex<flag_count> index{long_names, short_names};
+		static constexpr auto flag_ids = []<std::size_t... I>(std::index_sequence<I...>) {
+			return std::array<std::size_t, flag_count>{I...};
+		}(std::make_index_sequence<flag_count>{});///< the "flag" objects run_tokenizer hands back to the handler
+
+		static constexpr bool names_unique() {
+			for (std::size_t i = 0; i < flag_count; ++i) {
+				for (std::size_t j = i + 1; j < flag_count; ++j) {
+					if (long_names[i] == long_names[j] || (short_names[i] != '\0' && short_names[i] == short_names[j])) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+		static_assert(names_unique(), "Schema flag names must be unique");
+
+		template <FixedString Name>
+		static constexpr std::size_t index_of() {
+			constexpr std::size_t i = index.find(Name.view());
+			static_assert(i < flag_count, "No flag with this name in the Schema");
+			return i;
+		}
+
+	  public:
+		/**
+		 * @brief Construct the TypedFlag<T> for every declared flag.
+		 */
+		Schema() : flags_(make_flag<Flags>()...) {
+		}
+
+		/**
+		 * @brief Access the TypedFlag<T> for configuration (required, default, choices...).
+		 */
+		template <FixedString Name>
+		[[nodiscard]] auto &flag() noexcept {
+			return std::get<index_of<Name>()>(flags_);
+		}
+
+		template <FixedString Name>
+		[[nodiscard]] const auto &flag() const noexcept {
+			return std::get<index_of<Name>()>(flags_);
+		}
+
+		/**
+		 * @brief Typed value of a flag, resolved entirely at compile time.
+		 */
+		template <FixedString Name>
+		[[nodiscard]] const auto &get() const noexcept {
+			return std::get<index_of<Name>()>(flags_).value();
+		}
+
+		/**
+		 * @brief True if the flag has a value (parsed or defaulted).
+		 */
+		template <FixedString Name>
+		[[nodiscard]] bool has() const noexcept {
+			return std::get<index_of<Name>()>(flags_).has_value();
+		}
+
+		/**
+		 * @brief Non-flag tokens from the last parse, as views into its arguments.
+		 */
+		[[nodiscard]] const std::vector<std::string_view> &positionals() const noexcept {
+			return positionals_;
+		}
+
+		/**
+		 * @brief Parse argc/argv, skipping the program name.
+		 */
+		[[nodiscard]] Result<void> parse(int argc, char **argv) {
+			std::vector<std::string_view> views(argv + (argc > 0 ? 1 : 0), argv + argc);
+			return parse(std::span<const std::string_view>(views));
+		}
+
+		/**
+		 * @brief Parse a sequence of string views with the tokenizer Parser::parse uses.
+		 *
+		 * Token shapes, `--name=value`, `--`, boolean literals and short-flag
+		 * bundles such as `-vp8080` behave exactly as they do for a Parser.
+		 */
+		[[nodiscard]] Result<void> parse(std::span<const std::string_view> args) {
+			positionals_.clear();
+
+			Handler handler{*this};
+			auto consumed = detail::run_tokenizer(args, 0, handler);
+			if (! consumed) {
+				return Result<void>::err(consumed.error());
+			}
+
+			return validate_requirements(std::make_index_sequence<flag_count>{});
+		}
+
+	  private:
+		std::tuple<TypedFlag<typename std::remove_cvref_t<decltype(Flags)>::value_type>...> flags_;
+		std::vector<std::string_view> positionals_;
+
+		/**
+		 * @brief run_tokenizer handler: flags are indices into the declaration, every other token is a positional.
+		 */
+		struct Handler {
+			Schema &schema;
+
+			[[nodiscard]] detail::FlagMatch<std::size_t> find_long(std::string_view name) const {
+				return match(index.find(name));
+			}
+
+			[[nodiscard]] detail::FlagMatch<std::size_t> find_short(std::string_view name) const {
+				return match(name.size() == 1 ? index.find_short(name[0]) : flag_count);
+			}
+
+			[[nodiscard]] bool is_boolean(std::size_t flag_index) const {
+				return boolean_flags[flag_index];
+			}
+
+			Result<void> set_flag(std::string_view, std::size_t flag_index, std::string_view value) {
+				return schema.set_value(flag_index, value);
+			}
+
+			Result<std::optional<std::size_t>> subcommand(std::string_view, std::size_t) const {
+				return Result<std::optional<std::size_t>>::ok(std::nullopt);
+			}
+
+			Result<bool> positional(std::string_view arg) {
+				schema.positionals_.push_back(arg);
+				return Result<bool>::ok(true);
+			}
+
+			[[nodiscard]] bool fallthrough() const {
+				return false;
+			}
+
+			[[nodiscard]] std::string_view suggest_long(std::string_view) const {
+				return {};
+			}
+
+		  private:
+			[[nodiscard]] static detail::FlagMatch<std::size_t> match(std::size_t flag_index) {
+				if (flag_index == flag_count) {
+					return {{}, nullptr, false};
+				}
+				return {long_names[flag_index], &flag_ids[flag_index], false};
+			}
+		};
+
+		template <auto Spec>
+		static auto make_flag() {
+			using Decl = std::remove_cvref_t<decltype(Spec)>;
+			TypedFlag<typename Decl::value_type> flag{std::string(Decl::name), std::string(Decl::description)};
+			if (Spec.short_name != '\0') {
+				flag.set_short_name(std::string(1, Spec.short_name));
+			}
+			return flag;
+		}
+
+		template <std::size_t I>
+		static Result<void> set_at(Schema &self, std::string_view str) {
+			return std::get<I>(self.flags_).set_value_from_string(str);
+		}
+
+		Result<void> set_value(std::size_t flag_index, std::string_view str) {
+			using Setter = Result<void> (*)(Schema &, std::string_view);
+			static constexpr auto setters = []<std::size_t... I>(std::index_sequence<I...>) {
+				return std::array<Setter, flag_count>{&set_at<I>...};
+			}(std::make_index_sequence<flag_count>{});
+			return setters[flag_index](*this, str);
+		}
+
+		template <std::size_t... I>
+		Result<void> validate_requirements(std::index_sequence<I...>) const {
+			std::size_t missing = flag_count;
+			((missing == flag_count && std::get<I>(flags_).is_required() && ! std::get<I>(flags_).has_value() ? (missing = I, 0) : 0), ...);
+			if (missing != flag_count) {
+				return Result<void>::err(Error::missing_required_flag(long_names[missing]));
+			}
+			return Result<void>::ok();
+		}
+	};
+
+}// namespace cli
+
+#endif// CPPLI_SCHEMA_HPP
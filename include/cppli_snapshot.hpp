@@ -0,0 +1,336 @@
+#ifndef CPPLI_SNAPSHOT_HPP
+#define CPPLI_SNAPSHOT_HPP
+
+#include "cppli_error.hpp"
+#include "cppli_spec.hpp"
+#include "cppli_storage.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace cli {
+
+	namespace detail {
+
+		inline constexpr std::uint32_t snapshot_magic = 0x494c5043;///< "CPLI" in little-endian byte order
+		inline constexpr std::uint16_t snapshot_version = 2;
+		inline constexpr std::uint32_t snapshot_none = ~std::uint32_t{0};///< SnapshotLevel::selected without a subcommand
+
+		/**
+		 * @brief Start of every snapshot.
+		 */
+		struct SnapshotHeader {
+			std::uint32_t magic;
+			std::uint16_t version;
+			std::uint16_t reserved;
+			std::uint32_t size;///< bytes of the whole snapshot
+			std::uint32_t reserved2;
+			std::uint64_t spec_hash;///< ParserSpec::hash() of the writer
+			std::uint64_t reserved3;
+		};
+		static_assert(sizeof(SnapshotHeader) % snapshot_alignment == 0);
+
+		/**
+		 * @brief One command level, followed by an offset per presence bit (0 if absent).
+		 *
+		 * Offsets are from the start of the snapshot. The root level follows the
+		 * header; each selected subcommand's level follows its parent's entries,
+		 * and the next subcommand of a chain follows the levels below it.
+		 */
+		struct SnapshotLevel {
+			std::uint32_t entry_count;///< SpecCommand::bit_count()
+			std::uint32_t selected;	  ///< index into SpecCommand::subcommands, or snapshot_none
+			std::uint32_t next;		  ///< offset of the selected subcommand's level
+			std::uint8_t help_requested;
+			std::uint8_t version_requested;
+			std::uint16_t reserved;
+			std::uint32_t chained;	   ///< index into the parent's SpecCommand::subcommands of the next chained subcommand, or snapshot_none
+			std::uint32_t chained_next;///< offset of the next chained subcommand's level
+			std::uint64_t reserved2;
+		};
+		static_assert(sizeof(SnapshotLevel) % snapshot_alignment == 0);
+
+		/**
+		 * @brief Type a flag or positional must hold for a view lookup of T (string_view reads std::string).
+		 */
+		template <typename T>
+		using snapshot_stored_t = std::conditional_t<std::is_same_v<T, std::string_view>, std::string, T>;
+
+	}// namespace detail
+
+	/**
+	 * @brief Read-only view of a snapshot written by ParseResult::serialize.
+	 *
+	 * from_bytes() checks the snapshot once against the spec (version, spec
+	 * hash and every offset), after which lookups read values straight out of
+	 * the bytes: trivially copyable values are copied out (or viewed, for
+	 * get_all), string flags can be read as std::string_view without copying,
+	 * and values stored as text go back through the flag's own conversion.
+	 * Lookups mirror ParseResult, including defaults of repeatable flags.
+	 *
+	 * The view borrows both the bytes and the spec, which must outlive it.
+	 *
+	 * Example:
+	 * @code
+	 * // parent
+	 * std::vector<std::byte> bytes(result.serialized_size());
+	 * (void) result.serialize(bytes);
+	 * // worker, same binary
+	 * auto view = cli::ParseResultView::from_bytes(spec, bytes);
+	 * if (view) {
+	 *     int port = view.value().get<int>("port").value_or(80);
+	 * }
+	 * @endcode
+	 */
+	class ParseResultView {
+	  public:
+		/**
+		 * @brief Validate a snapshot and view its root level.
+		 * @param spec Spec of the same definition as the writer's (equal hash()).
+		 * @param bytes Snapshot; must be aligned to 16 bytes, as operator new and std::vector storage are.
+		 */
+		[[nodiscard]] static Result<ParseResultView> from_bytes(const ParserSpec &spec, std::span<const std::byte> bytes);
+
+		/**
+		 * @brief Get flag value by name; std::string_view reads a std::string flag in place.
+		 */
+		template <typename T = std::string>
+		[[nodiscard]] std::optional<T> get(std::string_view flag_name) const;
+
+		/**
+		 * @brief All values of a repeatable flag of a trivially copyable type, viewed in place.
+		 */
+		template <typename T>
+			requires(detail::snapshot_raw<T> && ! std::is_same_v<T, bool>)
+		[[nodiscard]] std::span<const T> get_all(std::string_view flag_name) const;
+
+		/**
+		 * @brief Number of values of a T flag: the repeat count (or default count) for repeatable flags, else 0 or 1.
+		 */
+		template <typename T = std::string>
+		[[nodiscard]] std::size_t count(std::string_view flag_name) const;
+
+		/**
+		 * @brief Value index of a flag, for repeatable flags of any type; see count().
+		 */
+		template <typename T = std::string>
+		[[nodiscard]] std::optional<T> get_at(std::string_view flag_name, std::size_t index) const;
+
+		/**
+		 * @brief True if the flag was given or has a default.
+		 */
+		[[nodiscard]] bool has(std::string_view flag_name) const;
+
+		/**
+		 * @brief Get positional argument by index.
+		 */
+		template <typename T = std::string>
+		[[nodiscard]] std::optional<T> get_positional(std::size_t index) const;
+
+		/**
+		 * @brief Get positional argument by name.
+		 */
+		template <typename T = std::string>
+		[[nodiscard]] std::optional<T> get_positional(std::string_view name) const;
+
+		/**
+		 * @brief Name of the selected subcommand at this level, if any.
+		 */
+		[[nodiscard]] std::optional<std::string_view> get_selected_subcommand() const;
+
+		/**
+		 * @brief View of the selected subcommand's level, if one was selected.
+		 */
+		[[nodiscard]] std::optional<ParseResultView> get_subcommand() const;
+
+		/**
+		 * @brief In a chain, view of the subcommand given after this one; see ParseResult::get_next_subcommand().
+		 */
+		[[nodiscard]] std::optional<ParseResultView> get_next_subcommand() const;
+
+		[[nodiscard]] bool help_requested() const noexcept {
+			return level().help_requested != 0;
+		}
+
+		[[nodiscard]] bool version_requested() const noexcept {
+			return level().version_requested != 0;
+		}
+
+	  private:
+		const detail::SpecCommand *command_;
+		const detail::SpecCommand *parent_;///< command this level was selected from, nullptr at the root
+		const std::byte *bytes_;
+		std::size_t level_;///< offset of this view's SnapshotLevel
+
+		ParseResultView(const detail::SpecCommand *command, const detail::SpecCommand *parent, const std::byte *bytes, std::size_t level) noexcept
+			: command_(command), parent_(parent), bytes_(bytes), level_(level) {
+		}
+
+		[[nodiscard]] static Result<void> check_level(const detail::SpecCommand &command, const detail::SpecCommand *parent, std::span<const std::byte> bytes, std::size_t offset);
+
+		template <typename T>
+		[[nodiscard]] const T &at(std::size_t offset) const noexcept {
+			return *reinterpret_cast<const T *>(bytes_ + offset);
+		}
+
+		[[nodiscard]] const detail::SnapshotLevel &level() const noexcept {
+			return at<detail::SnapshotLevel>(level_);
+		}
+
+		/**
+		 * @brief Entry of a presence bit, or nullptr if the value is absent.
+		 */
+		[[nodiscard]] const detail::SnapshotEntry *entry(std::uint32_t bit) const noexcept {
+			std::uint32_t offset;
+			std::memcpy(&offset, bytes_ + level_ + sizeof(detail::SnapshotLevel) + bit * sizeof(std::uint32_t), sizeof(offset));
+			return offset == 0 ? nullptr : &at<detail::SnapshotEntry>(offset);
+		}
+
+		/**
+		 * @brief Value index of an entry as T; source converts text values that are not strings.
+		 */
+		template <typename T, typename Source>
+		[[nodiscard]] static std::optional<T> decode(const detail::SnapshotEntry &entry, std::size_t index, const Source &source);
+	};
+
+	template <typename T, typename Source>
+	std::optional<T> ParseResultView::decode(const detail::SnapshotEntry &entry, std::size_t index, const Source &source) {
+		using Stored = detail::snapshot_stored_t<T>;
+		const auto *base = reinterpret_cast<const std::byte *>(&entry);
+
+		if constexpr (detail::snapshot_raw<Stored>) {
+			if (entry.kind != detail::SnapshotKind::Raw || entry.value_size != sizeof(T)) {
+				return std::nullopt;
+			}
+			T value;
+			std::memcpy(&value, base + sizeof(entry) + index * sizeof(T), sizeof(T));
+			return value;
+		} else {
+			if (entry.kind != detail::SnapshotKind::Text) {
+				return std::nullopt;
+			}
+			detail::SnapshotText where;
+			std::memcpy(&where, base + sizeof(entry) + index * sizeof(where), sizeof(where));
+			const std::string_view text(reinterpret_cast<const char *>(base + where.offset), where.size);
+
+			if constexpr (std::is_constructible_v<T, std::string_view> && std::is_convertible_v<const Stored &, std::string_view>) {
+				return T(text);
+			} else {
+				auto parsed = source.parse_value(text);
+				if (! parsed) {
+					return std::nullopt;
+				}
+				return std::move(parsed.value());
+			}
+		}
+	}
+
+	template <typename T>
+	std::optional<T> ParseResultView::get(std::string_view flag_name) const {
+		return get_at<T>(flag_name, std::size_t(-1));
+	}
+
+	template <typename T>
+	std::optional<T> ParseResultView::get_at(std::string_view flag_name, std::size_t index) const {
+		using Stored = detail::snapshot_stored_t<T>;
+
+		const auto *flag = command_->flags.find(flag_name);
+		if (flag == nullptr) {
+			return std::nullopt;
+		}
+		const auto *typed = flag->storage.template get_if<Stored>();
+		if (typed == nullptr) {
+			return std::nullopt;
+		}
+
+		const detail::SnapshotEntry *found = entry(flag->bit);
+		if (found == nullptr) {
+			if constexpr (! std::is_same_v<Stored, bool>) {
+				if (flag->multi) {// absent repeatable flag: its default, as ParseResult::values_of reads it
+					const auto values = typed->all_values();
+					const std::size_t i = index == std::size_t(-1) ? values.size() - 1 : index;
+					if (i >= values.size()) {
+						return std::nullopt;
+					}
+					return T(values[i]);
+				}
+			}
+			return std::nullopt;
+		}
+
+		const std::size_t i = index == std::size_t(-1) ? std::size_t(found->count) - 1 : index;
+		if (i >= found->count) {
+			return std::nullopt;
+		}
+		return decode<T>(*found, i, *typed);
+	}
+
+	template <typename T>
+	std::size_t ParseResultView::count(std::string_view flag_name) const {
+		using Stored = detail::snapshot_stored_t<T>;
+
+		const auto *flag = command_->flags.find(flag_name);
+		if (flag == nullptr || flag->storage.template get_if<Stored>() == nullptr) {
+			return 0;
+		}
+		if (const auto *found = entry(flag->bit); found != nullptr) {
+			return found->count;
+		}
+		if constexpr (! std::is_same_v<Stored, bool>) {
+			if (flag->multi) {
+				return flag->storage.template get_if<Stored>()->all_values().size();
+			}
+		}
+		return 0;
+	}
+
+	template <typename T>
+		requires(detail::snapshot_raw<T> && ! std::is_same_v<T, bool>)
+	std::span<const T> ParseResultView::get_all(std::string_view flag_name) const {
+		const auto *flag = command_->flags.find(flag_name);
+		if (flag == nullptr || ! flag->multi || flag->storage.template get_if<T>() == nullptr) {
+			return {};
+		}
+
+		const detail::SnapshotEntry *found = entry(flag->bit);
+		if (found == nullptr) {
+			return flag->storage.template get_if<T>()->all_values();
+		}
+		if (found->kind != detail::SnapshotKind::Raw || found->value_size != sizeof(T)) {
+			return {};
+		}
+		return {reinterpret_cast<const T *>(reinterpret_cast<const std::byte *>(found) + sizeof(*found)), found->count};
+	}
+
+	template <typename T>
+	std::optional<T> ParseResultView::get_positional(std::size_t index) const {
+		if (index >= command_->positionals.size()) {
+			return std::nullopt;
+		}
+
+		const auto &pos = command_->positionals[index];
+		const auto *typed = pos.storage.template get_if<detail::snapshot_stored_t<T>>();
+		const detail::SnapshotEntry *found = entry(pos.bit);
+		if (typed == nullptr || found == nullptr) {
+			return std::nullopt;
+		}
+		return decode<T>(*found, 0, *typed);
+	}
+
+	template <typename T>
+	std::optional<T> ParseResultView::get_positional(std::string_view name) const {
+		const auto *index = command_->positional_index.find(name);
+		if (index == nullptr) {
+			return std::nullopt;
+		}
+		return get_positional<T>(*index);
+	}
+
+}// namespace cli
+
+#endif// CPPLI_SNAPSHOT_HPP
@@ -0,0 +1,506 @@
+#ifndef CPPLI_SPEC_HPP
+#define CPPLI_SPEC_HPP
+
+#include "cppli_error.hpp"
+#include "cppli_executor.hpp"
+#include "cppli_name_table.hpp"
+#include "cppli_storage.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace cli {
+
+	class ParserSpec;
+	class ParseResultView;
+
+	namespace detail {
+
+		/**
+		 * @brief A frozen flag: private copy of the TypedFlag<T> plus its value slot.
+		 */
+		struct SpecFlag {
+			FlagStorage storage;		  ///< cloned flag (options, default, validator)
+			std::size_t offset = 0;		  ///< byte offset of the value in ParseResult's block
+			std::uint32_t bit = 0;		  ///< presence bit index
+			bool multi = false;			  ///< repeatable: the slot holds a std::pmr::vector<T>
+			bool default_fallback = false;///< repeatable with a default, read from the flag when absent
+		};
+
+		/**
+		 * @brief A frozen positional: private copy of the TypedPositional<T> plus its value slot.
+		 */
+		struct SpecPositional {
+			PositionalStorage storage;
+			std::size_t offset = 0;
+			std::uint32_t bit = 0;
+		};
+
+		/**
+		 * @brief Immutable description of one command level (root or subcommand).
+		 *
+		 * Built once by Parser::freeze(); never modified afterwards, so any number
+		 * of threads may parse against it concurrently.
+		 */
+		struct SpecCommand {
+			std::string name;
+			NameTable<SpecFlag> flags;
+			ShortNameIndex short_names;///< short-name -> index into flags
+			std::vector<SpecPositional> positionals;
+			NameTable<std::uint32_t> positional_index;///< positional name -> index into positionals
+			NameTable<std::unique_ptr<SpecCommand>> subcommands;
+			std::vector<std::uint64_t> required;///< presence bits that must be set
+			std::size_t block_size = 0;			///< bytes of value storage per result
+			std::size_t presence_offset = 0;	///< presence words start here, after the values
+			std::size_t allocation_size = 0;	///< values plus presence words
+			std::uint64_t hash = 0;				///< structural hash of this level and below, set by finish()
+			NameTrie flag_names;	  ///< long names, for abbreviations and suggestions; built by finish()
+			NameTrie subcommand_names;///< subcommand names, likewise
+			int required_subcommand_count = 0;///< Parser::require_subcommand: 0 none, -1 at least one, n exactly n
+			bool chain = false;				  ///< Parser::chain_subcommands
+			bool fallthrough = false;
+			bool rest = false;///< add_rest_positional: surplus tokens are captured, not rejected
+			bool is_root = false;
+			bool abbreviations = false;///< Parser::allow_abbreviations
+
+			/**
+			 * @brief Copy a flag into the spec and reserve its value slot.
+			 */
+			void add_flag(const std::string &long_name, const FlagStorage &flag);
+
+			/**
+			 * @brief Copy a positional into the spec and reserve its value slot.
+			 */
+			void add_positional(const PositionalStorage &pos);
+
+			/**
+			 * @brief Number of presence bits (flags followed by positionals).
+			 */
+			[[nodiscard]] std::size_t bit_count() const noexcept {
+				return flags.size() + positionals.size();
+			}
+
+			/**
+			 * @brief Assign presence bits, the required mask, the result layout, the name tries and the hash once all members are added.
+			 *
+			 * Subcommands must be finished first, since their hashes feed this one.
+			 */
+			void finish();
+
+			/**
+			 * @brief Add this level's memory to stats, and that of its subcommands under MemoryStats::subcommands.
+			 */
+			void add_memory(MemoryStats &stats) const;
+
+		  private:
+			std::size_t reserve_slot(std::size_t size, std::size_t align);
+		};
+
+	}// namespace detail
+
+	/**
+	 * @brief Values produced by one ParserSpec::parse call.
+	 *
+	 * A ParseResult owns the parsed values of one command level and their
+	 * presence bitset in a single aligned block; the selected subcommand (if
+	 * any) has its own nested ParseResult. It refers to the ParserSpec that
+	 * produced it, which must outlive it.
+	 *
+	 * All of a result's memory (the block, nested results, the buffers of
+	 * repeatable flags and allocator-aware values such as std::pmr::string)
+	 * comes from the memory resource passed to ParserSpec::parse, so it must
+	 * also outlive the result.
+	 *
+	 * ParseResult is move-only.
+	 */
+	class ParseResult {
+	  public:
+		/**
+		 * @brief Empty result: every lookup returns std::nullopt.
+		 */
+		ParseResult() = default;
+
+		ParseResult(ParseResult &&other) noexcept;
+		ParseResult &operator=(ParseResult &&other) noexcept;
+		ParseResult(const ParseResult &) = delete;
+		ParseResult &operator=(const ParseResult &) = delete;
+		~ParseResult();
+
+		/**
+		 * @brief Get flag value by name.
+		 * @return std::optional<T> Value if present and type matches.
+		 */
+		template <typename T = std::string>
+		[[nodiscard]] std::optional<T> get(std::string_view flag_name) const;
+
+		/**
+		 * @brief All values of a repeatable flag (see TypedFlag::set_multi).
+		 *
+		 * The span points into storage owned by this result and stays valid as
+		 * long as it does. If the flag never appeared, it holds the default, if
+		 * any. Empty if the flag is unknown, not repeatable, or of another type.
+		 */
+		template <typename T = std::string>
+			requires(! std::is_same_v<T, bool>)
+		[[nodiscard]] std::span<const T> get_all(std::string_view flag_name) const;
+
+		/**
+		 * @brief True if the flag was given or has a default.
+		 */
+		[[nodiscard]] bool has(std::string_view flag_name) const;
+
+		/**
+		 * @brief Get positional argument by index.
+		 */
+		template <typename T = std::string>
+		[[nodiscard]] std::optional<T> get_positional(size_t index) const;
+
+		/**
+		 * @brief Get positional argument by name.
+		 */
+		template <typename T = std::string>
+		[[nodiscard]] std::optional<T> get_positional(std::string_view name) const;
+
+		/**
+		 * @brief Name of the selected subcommand at this level, if any.
+		 */
+		[[nodiscard]] std::optional<std::string_view> get_selected_subcommand() const;
+
+		/**
+		 * @brief Tokens captured by this level's rest positional (see Parser::add_rest_positional), empty if none.
+		 *
+		 * The tokens and their text are copied into the result, so they stay
+		 * valid as long as it does, independent of the parsed arguments. They
+		 * are not part of a snapshot (see serialize()).
+		 */
+		[[nodiscard]] std::span<const std::string_view> get_rest() const noexcept {
+			return {rest_, rest_size_};
+		}
+
+		/**
+		 * @brief Result for the selected subcommand, or nullptr if none was selected.
+		 */
+		[[nodiscard]] const ParseResult *get_subcommand() const noexcept {
+			return subcommand_;
+		}
+
+		/**
+		 * @brief In a chain (see Parser::chain_subcommands), the result of the subcommand given after this one.
+		 *
+		 * Call it on get_subcommand() of the root result and walk on from
+		 * there. nullptr when this was the last subcommand of the chain, or
+		 * the parser does not chain. Snapshots keep the whole chain (see
+		 * ParseResultView::get_next_subcommand()).
+		 */
+		[[nodiscard]] const ParseResult *get_next_subcommand() const noexcept {
+			return next_;
+		}
+
+		/**
+		 * @brief True if --help was given at this level or below.
+		 */
+		[[nodiscard]] bool help_requested() const noexcept {
+			return help_requested_;
+		}
+
+		/**
+		 * @brief True if --version was given.
+		 */
+		[[nodiscard]] bool version_requested() const noexcept {
+			return version_requested_;
+		}
+
+		/**
+		 * @brief Write a binary snapshot of the values and the selected subcommand path.
+		 *
+		 * The snapshot is read back, without parsing or allocating, by
+		 * ParseResultView::from_bytes against a ParserSpec with the same
+		 * hash(), typically in a worker process running the same binary. It
+		 * is versioned, uses native byte order, and starts every entry on a
+		 * 16-byte boundary. Trivially copyable values are stored as their
+		 * bytes. Strings are stored as text, and other types as their
+		 * command-line text. Call it on the root result returned by
+		 * ParserSpec::parse.
+		 *
+		 * @param out Destination; see serialized_size() for the bytes needed.
+		 * @return Result<size_t> Bytes written, or an error if out is too small.
+		 */
+		[[nodiscard]] Result<std::size_t> serialize(std::span<std::byte> out) const;
+
+		/**
+		 * @brief Bytes serialize() needs for this result.
+		 */
+		[[nodiscard]] std::size_t serialized_size() const;
+
+		/**
+		 * @brief Memory held by this result: the value block and the heap buffers of present values.
+		 *
+		 * Everything is reported under MemoryStats::values, except nested
+		 * results, which go under MemoryStats::subcommands. The bytes come from
+		 * the resource passed to ParserSpec::parse.
+		 */
+		[[nodiscard]] MemoryStats memory_stats() const;
+
+	  private:
+		friend class ParserSpec;
+
+		const detail::SpecCommand *command_ = nullptr;
+		std::pmr::memory_resource *resource_ = nullptr;
+		std::byte *block_ = nullptr;	   ///< value slots then presence words, laid out by SpecCommand
+		std::uint64_t *present_ = nullptr; ///< presence bits (flags, then positionals), inside block_
+		ParseResult *subcommand_ = nullptr;///< allocated from resource_
+		ParseResult *next_ = nullptr;	   ///< next subcommand of a chain, allocated from resource_
+		std::string_view *rest_ = nullptr; ///< rest tokens followed by their text, one allocation from resource_
+		std::size_t rest_size_ = 0;
+		std::size_t rest_bytes_ = 0;
+		bool help_requested_ = false;
+		bool version_requested_ = false;
+
+		ParseResult(const detail::SpecCommand *command, std::pmr::memory_resource *resource);
+
+		/**
+		 * @brief Create the nested result for a selected subcommand.
+		 */
+		ParseResult &select_subcommand(const detail::SpecCommand *command);
+
+		/**
+		 * @brief Create the result for the subcommand chained after this one.
+		 */
+		ParseResult &chain_subcommand(const detail::SpecCommand *command);
+
+		/**
+		 * @brief Copy the rest positional's tokens and their text into one block from resource_.
+		 */
+		void capture_rest(std::span<const std::string_view> tokens);
+
+		[[nodiscard]] bool test(std::uint32_t bit) const noexcept {
+			return (present_[bit / 64] >> (bit % 64)) & 1u;
+		}
+
+		void set(std::uint32_t bit) noexcept {
+			present_[bit / 64] |= std::uint64_t{1} << (bit % 64);
+		}
+
+		void clear(std::uint32_t bit) noexcept {
+			present_[bit / 64] &= ~(std::uint64_t{1} << (bit % 64));
+		}
+
+		[[nodiscard]] void *slot(std::size_t offset) const noexcept {
+			return block_ + offset;
+		}
+
+		template <typename T>
+		[[nodiscard]] const T &value_at(std::size_t offset) const noexcept {
+			return *std::launder(static_cast<const T *>(slot(offset)));
+		}
+
+		template <typename T>
+		[[nodiscard]] std::span<const T> values_of(const detail::SpecFlag &flag) const noexcept {
+			if (test(flag.bit)) {
+				return value_at<std::pmr::vector<T>>(flag.offset);
+			}
+			return flag.storage.template get_if<T>()->all_values();
+		}
+
+		void release() noexcept;
+
+		/**
+		 * @brief Append this level, the selected subcommand's, then the next chained subcommand's, to a snapshot.
+		 * @param parent Command this level was selected from, which also holds the chained subcommands; nullptr at the root.
+		 */
+		void write_snapshot(detail::SnapshotWriter &out, const detail::SpecCommand *parent) const;
+	};
+
+	/**
+	 * @brief Outcome of ParserSpec::parse_batch, index-aligned with the inputs.
+	 *
+	 * Entry i of results and errors belongs to input i. A failed input leaves an
+	 * empty ParseResult and a non-None Error; a successful one has
+	 * ErrorCode::None.
+	 */
+	struct BatchResult {
+		std::vector<ParseResult> results;
+		std::vector<Error> errors;
+		std::size_t failures = 0;
+
+		/**
+		 * @brief True if input i parsed successfully.
+		 */
+		[[nodiscard]] bool ok(std::size_t i) const noexcept {
+			return errors[i].code() == ErrorCode::None;
+		}
+
+		[[nodiscard]] std::size_t size() const noexcept {
+			return results.size();
+		}
+	};
+
+	/**
+	 * @brief Immutable, thread-safe snapshot of a Parser definition.
+	 *
+	 * Produced by Parser::freeze(). The spec holds private copies of every flag,
+	 * positional and subcommand, so the Parser can be modified or destroyed
+	 * afterwards. parse() is const and keeps all per-call state in the returned
+	 * ParseResult, so one spec can be shared by any number of threads without
+	 * locking (user validators must themselves be safe to call concurrently).
+	 * Subcommand callbacks are not invoked.
+	 *
+	 * Copying a ParserSpec is cheap and shares the underlying definition.
+	 *
+	 * Example:
+	 * @code
+	 * const cli::ParserSpec spec = parser.freeze();
+	 * // on any thread:
+	 * auto result = spec.parse(args);
+	 * if (result) {
+	 *     int port = result.value().get<int>("port").value_or(80);
+	 * }
+	 * @endcode
+	 */
+	class ParserSpec {
+	  public:
+		[[nodiscard]] Result<ParseResult> parse(int argc, char **argv) const;
+		[[nodiscard]] Result<ParseResult> parse(const std::vector<std::string> &args) const;
+		[[nodiscard]] Result<ParseResult> parse(std::span<const char *const> args) const;
+		[[nodiscard]] Result<ParseResult> parse(std::span<const std::string_view> args) const;
+
+		/**
+		 * @brief Parse with all per-call memory taken from a caller-supplied resource.
+		 *
+		 * The result's values, nested subcommand results and response-file
+		 * buffers are allocated from @p resource. With a
+		 * std::pmr::monotonic_buffer_resource, a request handler can parse, use
+		 * the result, destroy it and release() the arena in O(1). The other
+		 * overloads use std::pmr::get_default_resource().
+		 *
+		 * @param args Argument tokens; must outlive the call.
+		 * @param resource Memory resource; must outlive the returned ParseResult.
+		 */
+		[[nodiscard]] Result<ParseResult> parse(std::span<const std::string_view> args, std::pmr::memory_resource *resource) const;
+
+		/**
+		 * @brief Parse many independent command lines in parallel.
+		 *
+		 * Inputs are split into contiguous chunks and handed to the executor;
+		 * each input is parsed exactly as parse() would. The returned vectors are
+		 * allocated once up front and written in place.
+		 *
+		 * @param inputs Argument lists (program name excluded), which must stay alive for the call.
+		 * @param executor Executor that runs the chunks.
+		 * @return BatchResult Per-input results and errors.
+		 */
+		[[nodiscard]] BatchResult parse_batch(std::span<const std::vector<std::string_view>> inputs, Executor &executor) const;
+
+		/**
+		 * @brief Structural hash of the definition: names, value types and layout of every level.
+		 *
+		 * Snapshots (see ParseResult::serialize) only load into a spec with the same hash.
+		 */
+		[[nodiscard]] std::uint64_t hash() const noexcept {
+			return root_->hash;
+		}
+
+		/**
+		 * @brief Memory held by the shared definition (see Parser::memory_stats).
+		 *
+		 * Copies of a spec share it, so it is reported once per definition,
+		 * not per copy.
+		 */
+		[[nodiscard]] MemoryStats memory_stats() const;
+
+	  private:
+		friend class Parser;
+		friend class ParseResultView;
+
+		std::shared_ptr<const detail::SpecCommand> root_;
+
+		explicit ParserSpec(std::shared_ptr<const detail::SpecCommand> root) : root_(std::move(root)) {
+		}
+
+		[[nodiscard]] static Result<size_t> parse_command(const detail::SpecCommand &command, ParseResult &result, std::span<const std::string_view> args, size_t start_index);
+		[[nodiscard]] static Result<void> validate_requirements(const ParseResult &result);
+
+		/**
+		 * @brief Mirrors Parser::validate_subcommand_count for the root result.
+		 */
+		[[nodiscard]] static Result<void> validate_subcommand_count(const ParseResult &result);
+	};
+
+	template <typename T>
+	std::optional<T> ParseResult::get(std::string_view flag_name) const {
+		if (command_ == nullptr) {
+			return std::nullopt;
+		}
+
+		const auto *flag = command_->flags.find(flag_name);
+		if (flag == nullptr || flag->storage.template get_if<T>() == nullptr) {
+			return std::nullopt;
+		}
+
+		if constexpr (! std::is_same_v<T, bool>) {
+			if (flag->multi) {
+				const auto values = values_of<T>(*flag);
+				if (values.empty()) {
+					return std::nullopt;
+				}
+				return values.back();
+			}
+		}
+
+		if (! test(flag->bit)) {
+			return std::nullopt;
+		}
+		return value_at<T>(flag->offset);
+	}
+
+	template <typename T>
+		requires(! std::is_same_v<T, bool>)
+	std::span<const T> ParseResult::get_all(std::string_view flag_name) const {
+		if (command_ == nullptr) {
+			return {};
+		}
+
+		const auto *flag = command_->flags.find(flag_name);
+		if (flag == nullptr || ! flag->multi || flag->storage.template get_if<T>() == nullptr) {
+			return {};
+		}
+		return values_of<T>(*flag);
+	}
+
+	template <typename T>
+	std::optional<T> ParseResult::get_positional(size_t index) const {
+		if (command_ == nullptr || index >= command_->positionals.size()) {
+			return std::nullopt;
+		}
+
+		const auto &pos = command_->positionals[index];
+		if (pos.storage.template get_if<T>() == nullptr || ! test(pos.bit)) {
+			return std::nullopt;
+		}
+		return value_at<T>(pos.offset);
+	}
+
+	template <typename T>
+	std::optional<T> ParseResult::get_positional(std::string_view name) const {
+		if (command_ == nullptr) {
+			return std::nullopt;
+		}
+
+		const auto *index = command_->positional_index.find(name);
+		if (index == nullptr) {
+			return std::nullopt;
+		}
+		return get_positional<T>(*index);
+	}
+
+}// namespace cli
+
+#endif// CPPLI_SPEC_HPP
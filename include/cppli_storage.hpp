@@ -0,0 +1,910 @@
+#ifndef CPPLI_STORAGE_HPP
+#define CPPLI_STORAGE_HPP
+
+#include "cppli_error.hpp"
+#include "cppli_types.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cli::detail {
+
+	/**
+	 * @brief Unique address per type, used to check the T requested by get<T>().
+	 */
+	template <typename T>
+	inline constexpr char type_tag = 0;
+
+	/**
+	 * @brief Render one value for get_value_as_string().
+	 *
+	 * Uses ValueConverter<T>::to_string when the converter provides one.
+	 */
+	template <typename T>
+	[[nodiscard]] std::string value_text(const T &value) {
+		if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::pmr::string>) {
+			return std::string(value);
+		} else if constexpr (std::is_same_v<T, bool>) {
+			return value ? "true" : "false";
+		} else if constexpr (requires { ValueConverter<T>::to_string(value); }) {
+			return ValueConverter<T>::to_string(value);
+		} else {
+			return std::to_string(value);
+		}
+	}
+
+	/**
+	 * @brief How a dumped value is written by dump_values_json(): bare, as true/false, or quoted.
+	 */
+	enum class DumpKind : std::uint8_t {
+		Number,
+		Boolean,
+		Text,
+	};
+
+	/**
+	 * @brief Type-erased receiver for dump_value(); each value arrives as first followed by second.
+	 */
+	struct ValueSink {
+		void *context;
+		void (*write)(void *context, DumpKind kind, std::string_view first, std::string_view second);
+
+		void operator()(DumpKind kind, std::string_view first, std::string_view second = {}) const {
+			write(context, kind, first, second);
+		}
+	};
+
+	template <typename T>
+	inline constexpr bool is_duration = false;
+
+	template <typename Rep, typename Period>
+	inline constexpr bool is_duration<std::chrono::duration<Rep, Period>> = true;
+
+	/**
+	 * @brief Hand one value to a sink as the text value_text() would produce.
+	 *
+	 * Strings, booleans, numbers, enums, durations and ByteSize are rendered
+	 * with std::to_chars into a stack buffer; only other types fall back to
+	 * value_text() and its std::string.
+	 */
+	template <typename T>
+	void dump_value(const T &value, const ValueSink &sink) {
+		if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::pmr::string>) {
+			sink(DumpKind::Text, value);
+		} else if constexpr (std::is_same_v<T, bool>) {
+			sink(DumpKind::Boolean, value ? "true" : "false");
+		} else if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+			char buffer[64];
+			if constexpr (std::is_enum_v<T>) {
+				const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<std::underlying_type_t<T>>(value));
+				sink(DumpKind::Number, std::string_view(buffer, end));
+			} else {
+				const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+				bool finite = true;
+				if constexpr (std::is_floating_point_v<T>) {
+					finite = std::isfinite(value);// inf and nan are not JSON numbers
+				}
+				sink(finite ? DumpKind::Number : DumpKind::Text, std::string_view(buffer, end));
+			}
+		} else if constexpr (is_duration<T>) {
+			char buffer[64];
+			const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value.count());
+			sink(DumpKind::Text, std::string_view(buffer, end), duration_suffix<typename T::period>());
+		} else if constexpr (std::is_same_v<T, ByteSize>) {
+			char buffer[32];
+			const auto [count, suffix] = byte_size_parts(value.bytes);
+			const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), count);
+			sink(DumpKind::Text, std::string_view(buffer, end), suffix);
+		} else {
+			sink(DumpKind::Text, value_text(value));
+		}
+	}
+
+	/**
+	 * @brief Render an optional value for get_value_as_string().
+	 */
+	template <typename T>
+	[[nodiscard]] std::optional<std::string> value_to_string(const std::optional<T> &value) {
+		if (! value.has_value()) {
+			return std::nullopt;
+		}
+		return value_text(*value);
+	}
+
+	/**
+	 * @brief Construct a T in a raw value slot, passing resource to allocator-aware types.
+	 *
+	 * Types such as std::pmr::string or std::pmr::vector end up allocating from
+	 * the parse's memory resource; other types ignore it.
+	 */
+	template <typename T, typename... Args>
+	T *construct_in_slot(void *slot, std::pmr::memory_resource *resource, Args &&...args) {
+		return std::uninitialized_construct_using_allocator(static_cast<T *>(slot), std::pmr::polymorphic_allocator<>(resource), std::forward<Args>(args)...);
+	}
+
+	/**
+	 * @brief Parse str through a flag or positional into an external value slot.
+	 *
+	 * The slot is raw storage for a T owned by a ParseResult; constructed tells
+	 * whether it already holds a live T (assign) or not (construct from resource).
+	 */
+	template <typename T, typename Arg>
+	Result<void> parse_into_slot(const Arg &arg, std::string_view str, void *slot, bool constructed, std::pmr::memory_resource *resource) {
+		auto parsed = arg.parse_value(str);
+		if (! parsed) {
+			return Result<void>::err(parsed.error());
+		}
+		if (constructed) {
+			*std::launder(static_cast<T *>(slot)) = std::move(parsed.value());
+		} else {
+			construct_in_slot<T>(slot, resource, std::move(parsed.value()));
+		}
+		return Result<void>::ok();
+	}
+
+	/**
+	 * @brief Render one value of a flag, using its choice name for mapped enums.
+	 */
+	template <typename T>
+	[[nodiscard]] std::string flag_value_text(const TypedFlag<T> &flag, const T &value) {
+		if constexpr (std::is_enum_v<T>) {
+			if (auto name = flag.choice_name(value)) {
+				return std::string(*name);
+			}
+		}
+		return value_text(value);
+	}
+
+	/**
+	 * @brief Hand one value of a flag to a sink, using its choice name for mapped enums.
+	 */
+	template <typename T>
+	void dump_flag_value(const TypedFlag<T> &flag, const T &value, const ValueSink &sink) {
+		if constexpr (std::is_enum_v<T>) {
+			if (auto name = flag.choice_name(value)) {
+				sink(DumpKind::Text, *name);
+				return;
+			}
+		}
+		dump_value(value, sink);
+	}
+
+	/**
+	 * @brief Render the values of a repeatable flag, joined by its delimiter.
+	 */
+	template <typename T>
+	[[nodiscard]] std::optional<std::string> values_to_string(const TypedFlag<T> &flag) {
+		const auto values = flag.all_values();
+		if (values.empty()) {
+			return std::nullopt;
+		}
+
+		std::string joined;
+		for (const auto &value: values) {
+			if (! joined.empty()) {
+				joined += flag.delimiter() != '\0' ? flag.delimiter() : ',';
+			}
+			joined += flag_value_text(flag, value);
+		}
+		return joined;
+	}
+
+	/**
+	 * @brief Append the values in str to a std::pmr::vector<T> value slot (repeatable flags).
+	 *
+	 * On failure a slot constructed by this call is destroyed again, so the
+	 * caller only records the slot as live on success.
+	 */
+	template <typename T>
+	Result<void> append_into_slot(const TypedFlag<T> &flag, std::string_view str, void *slot, bool constructed, std::pmr::memory_resource *resource) {
+		if (! constructed) {
+			construct_in_slot<std::pmr::vector<T>>(slot, resource);
+		}
+		auto &values = *std::launder(static_cast<std::pmr::vector<T> *>(slot));
+
+		auto result = flag.parse_values(str, [&values](T &&value) {
+			values.push_back(std::move(value));
+		});
+		if (! result && ! constructed) {
+			std::destroy_at(&values);
+		}
+		return result;
+	}
+
+	/** @name Snapshot encoding (see ParseResult::serialize) */
+	///@{
+	inline constexpr std::size_t snapshot_alignment = 16;///< every entry and level starts on this boundary
+
+	/**
+	 * @brief How the values of one snapshot entry are stored.
+	 */
+	enum class SnapshotKind : std::uint8_t {
+		Raw, ///< the T objects' bytes, for trivially copyable T
+		Text,///< one string per value: the value itself for string types, its command-line text otherwise
+	};
+
+	/**
+	 * @brief Header of one flag or positional in a snapshot, followed by its values.
+	 */
+	struct SnapshotEntry {
+		SnapshotKind kind;
+		std::uint8_t reserved[3];
+		std::uint32_t count;	 ///< number of values (1 unless repeatable)
+		std::uint32_t value_size;///< sizeof(T) for Raw entries
+		std::uint32_t reserved2;
+	};
+	static_assert(sizeof(SnapshotEntry) == snapshot_alignment);
+
+	/**
+	 * @brief Where one Text value lives, relative to the start of its entry.
+	 */
+	struct SnapshotText {
+		std::uint32_t offset;
+		std::uint32_t size;
+	};
+
+	template <typename T>
+	inline constexpr bool snapshot_raw = std::is_trivially_copyable_v<T> && ! std::is_pointer_v<T>;
+
+	/**
+	 * @brief Bounded byte sink for ParseResult::serialize.
+	 *
+	 * Writes only while there is room but always advances, so serializing into
+	 * a buffer that is too small still yields the size that was needed.
+	 */
+	class SnapshotWriter {
+	  public:
+		explicit SnapshotWriter(std::span<std::byte> out) noexcept : out_(out) {
+		}
+
+		[[nodiscard]] std::size_t position() const noexcept {
+			return pos_;
+		}
+
+		[[nodiscard]] bool fits() const noexcept {
+			return pos_ <= out_.size();
+		}
+
+		void write(const void *data, std::size_t size) noexcept {
+			write_at(pos_, data, size);
+			pos_ += size;
+		}
+
+		/**
+		 * @brief Overwrite bytes written earlier, e.g. an offset known only later.
+		 */
+		void write_at(std::size_t at, const void *data, std::size_t size) noexcept {
+			if (size != 0 && at + size <= out_.size()) {
+				std::memcpy(out_.data() + at, data, size);
+			}
+		}
+
+		/**
+		 * @brief Append size zero bytes.
+		 */
+		void zeros(std::size_t size) noexcept {
+			if (pos_ < out_.size()) {
+				std::memset(out_.data() + pos_, 0, std::min(size, out_.size() - pos_));
+			}
+			pos_ += size;
+		}
+
+		void align(std::size_t alignment = snapshot_alignment) noexcept {
+			zeros((alignment - pos_ % alignment) % alignment);
+		}
+
+	  private:
+		std::span<std::byte> out_;
+		std::size_t pos_ = 0;
+	};
+
+	/**
+	 * @brief Append one entry holding values; text renders a value that is not stored raw.
+	 */
+	template <typename T, typename Text>
+	void snapshot_values(SnapshotWriter &out, std::span<const T> values, Text &&text) {
+		out.align();
+		const std::size_t start = out.position();
+
+		SnapshotEntry entry{};
+		entry.count = static_cast<std::uint32_t>(values.size());
+		if constexpr (snapshot_raw<T>) {
+			entry.kind = SnapshotKind::Raw;
+			entry.value_size = static_cast<std::uint32_t>(sizeof(T));
+			out.write(&entry, sizeof(entry));
+			out.write(values.data(), values.size_bytes());
+		} else {
+			entry.kind = SnapshotKind::Text;
+			out.write(&entry, sizeof(entry));
+			const std::size_t table = out.position();
+			out.zeros(values.size() * sizeof(SnapshotText));
+
+			for (std::size_t i = 0; i < values.size(); ++i) {
+				auto write_text = [&](std::string_view value) {
+					const SnapshotText where{static_cast<std::uint32_t>(out.position() - start), static_cast<std::uint32_t>(value.size())};
+					out.write_at(table + i * sizeof(SnapshotText), &where, sizeof(where));
+					out.write(value.data(), value.size());
+				};
+				if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+					write_text(values[i]);
+				} else {
+					write_text(text(values[i]));
+				}
+			}
+		}
+	}
+	///@}
+
+	/**
+	 * @brief Per-type operations for a type-erased TypedFlag<T>.
+	 *
+	 * One constexpr instance exists per T (see flag_ops<T>); every FlagStorage
+	 * holding a TypedFlag<T> points at the same table.
+	 *
+	 * The value_* members and parse_into/default_into/destroy_value operate on
+	 * value slots outside the flag, as laid out by ParserSpec. A repeatable
+	 * flag's slot holds a std::pmr::vector<T> instead of a T.
+	 */
+	struct FlagOps {
+		void (*destroy)(void *flag);
+		void *(*clone)(const void *flag);
+		Result<void> (*set_value)(void *flag, std::string_view str, ValueSource source, const ParseTrace *trace);
+		void (*reset)(void *flag);
+		Result<void> (*validate)(const void *flag);
+		bool (*has_value)(const void *flag);
+		bool (*is_required)(const void *flag);
+		bool (*is_multi)(const void *flag);
+		bool (*has_default)(const void *flag);
+		const std::string &(*short_name)(const void *flag);
+		const std::string &(*description)(const void *flag);
+		const std::string &(*env_name)(const void *flag);
+		std::optional<std::string> (*value_as_string)(const void *flag);
+		void (*choice_texts)(const void *flag, std::vector<std::string> &out);
+		Result<void> (*parse_into)(const void *flag, std::string_view str, void *slot, bool constructed, std::pmr::memory_resource *resource);
+		bool (*default_into)(const void *flag, void *slot, std::pmr::memory_resource *resource);
+		void (*destroy_value)(const void *flag, void *slot);
+		void (*snapshot)(const void *flag, const void *slot, SnapshotWriter &out);
+		void (*dump)(const void *flag, const ValueSink &sink);
+		void (*memory)(const void *flag, MemoryStats &stats);
+		std::size_t (*value_memory)(const void *flag, const void *slot);///< heap bytes of a slot's value
+		std::size_t value_size;		  ///< sizeof(T)
+		std::size_t value_align;	  ///< alignof(T)
+		std::size_t multi_value_size; ///< sizeof(std::pmr::vector<T>)
+		std::size_t multi_value_align;///< alignof(std::pmr::vector<T>)
+		bool is_boolean;			  ///< whether this is a boolean flag
+		const void *type;			  ///< &type_tag<T>
+	};
+
+	template <typename T>
+	inline constexpr FlagOps flag_ops = {
+		[](void *flag) {
+			delete static_cast<TypedFlag<T> *>(flag);
+		},
+		[](const void *flag) -> void * {
+			return new TypedFlag<T>(*static_cast<const TypedFlag<T> *>(flag));
+		},
+		[](void *flag, std::string_view str, ValueSource source, const ParseTrace *trace) {
+			return static_cast<TypedFlag<T> *>(flag)->set_value_from(str, source, trace);
+		},
+		[](void *flag) {
+			static_cast<TypedFlag<T> *>(flag)->reset();
+		},
+		[](const void *flag) {
+			return static_cast<const TypedFlag<T> *>(flag)->validate();
+		},
+		[](const void *flag) {
+			return static_cast<const TypedFlag<T> *>(flag)->has_value();
+		},
+		[](const void *flag) {
+			return static_cast<const TypedFlag<T> *>(flag)->is_required();
+		},
+		[](const void *flag) {
+			return static_cast<const TypedFlag<T> *>(flag)->is_multi();
+		},
+		[](const void *flag) {
+			return static_cast<const TypedFlag<T> *>(flag)->default_value().has_value();
+		},
+		[](const void *flag) -> const std::string & {
+			return static_cast<const TypedFlag<T> *>(flag)->short_name();
+		},
+		[](const void *flag) -> const std::string & {
+			return static_cast<const TypedFlag<T> *>(flag)->description();
+		},
+		[](const void *flag) -> const std::string & {
+			return static_cast<const TypedFlag<T> *>(flag)->env_name();
+		},
+		[](const void *flag) {
+			const auto &typed = *static_cast<const TypedFlag<T> *>(flag);
+			if constexpr (! std::is_same_v<T, bool>) {
+				if (typed.is_multi()) {
+					return values_to_string(typed);
+				}
+			}
+			if (! typed.value().has_value()) {
+				return std::optional<std::string>();
+			}
+			return std::optional<std::string>(flag_value_text(typed, *typed.value()));
+		},
+		[](const void *flag, std::vector<std::string> &out) {
+			const auto &typed = *static_cast<const TypedFlag<T> *>(flag);
+			for (const auto &choice: typed.choices()) {
+				out.push_back(flag_value_text(typed, choice));
+			}
+		},
+		[](const void *flag, std::string_view str, void *slot, bool constructed, std::pmr::memory_resource *resource) {
+			const auto &typed = *static_cast<const TypedFlag<T> *>(flag);
+			if (typed.is_multi()) {
+				return append_into_slot<T>(typed, str, slot, constructed, resource);
+			}
+			return parse_into_slot<T>(typed, str, slot, constructed, resource);
+		},
+		[](const void *flag, void *slot, std::pmr::memory_resource *resource) {
+			const auto &typed = *static_cast<const TypedFlag<T> *>(flag);
+			if (typed.is_multi() || ! typed.default_value().has_value()) {
+				return false;
+			}
+			construct_in_slot<T>(slot, resource, *typed.default_value());
+			return true;
+		},
+		[](const void *flag, void *slot) {
+			if (static_cast<const TypedFlag<T> *>(flag)->is_multi()) {
+				std::destroy_at(std::launder(static_cast<std::pmr::vector<T> *>(slot)));
+			} else {
+				std::destroy_at(std::launder(static_cast<T *>(slot)));
+			}
+		},
+		[](const void *flag, const void *slot, SnapshotWriter &out) {
+			const auto &typed = *static_cast<const TypedFlag<T> *>(flag);
+			auto text = [&typed](const T &value) {
+				return flag_value_text(typed, value);
+			};
+			if constexpr (! std::is_same_v<T, bool>) {
+				if (typed.is_multi()) {
+					const auto &values = *std::launder(static_cast<const std::pmr::vector<T> *>(slot));
+					snapshot_values<T>(out, std::span<const T>(values), text);
+					return;
+				}
+			}
+			snapshot_values<T>(out, std::span<const T>(std::launder(static_cast<const T *>(slot)), 1), text);
+		},
+		[](const void *flag, const ValueSink &sink) {
+			const auto &typed = *static_cast<const TypedFlag<T> *>(flag);
+			if constexpr (! std::is_same_v<T, bool>) {
+				if (typed.is_multi()) {
+					for (const T &value: typed.all_values()) {
+						dump_flag_value(typed, value, sink);
+					}
+					return;
+				}
+			}
+			if (typed.value().has_value()) {
+				dump_flag_value(typed, *typed.value(), sink);
+			}
+		},
+		[](const void *flag, MemoryStats &stats) {
+			static_cast<const TypedFlag<T> *>(flag)->add_memory(stats);
+		},
+		[](const void *flag, const void *slot) {
+			if (static_cast<const TypedFlag<T> *>(flag)->is_multi()) {
+				return heap_bytes(*std::launder(static_cast<const std::pmr::vector<T> *>(slot)));
+			}
+			return heap_bytes(*std::launder(static_cast<const T *>(slot)));
+		},
+		sizeof(T),
+		alignof(T),
+		sizeof(std::pmr::vector<T>),
+		alignof(std::pmr::vector<T>),
+		std::is_same_v<T, bool>,
+		&type_tag<T>,
+	};
+
+	/**
+	 * @brief Per-type operations for a type-erased TypedPositional<T>.
+	 */
+	struct PositionalOps {
+		void (*destroy)(void *pos);
+		void *(*clone)(const void *pos);
+		Result<void> (*set_value)(void *pos, std::string_view str, const ParseTrace *trace);
+		void (*reset)(void *pos);
+		bool (*has_value)(const void *pos);
+		bool (*is_required)(const void *pos);
+		const std::string &(*name)(const void *pos);
+		const std::string &(*description)(const void *pos);
+		std::optional<std::string> (*value_as_string)(const void *pos);
+		Result<void> (*parse_into)(const void *pos, std::string_view str, void *slot, bool constructed, std::pmr::memory_resource *resource);
+		void (*destroy_value)(void *slot);
+		void (*snapshot)(const void *slot, SnapshotWriter &out);
+		void (*dump)(const void *pos, const ValueSink &sink);
+		void (*memory)(const void *pos, MemoryStats &stats);
+		std::size_t (*value_memory)(const void *slot);///< heap bytes of a slot's value
+		std::size_t value_size; ///< sizeof(T)
+		std::size_t value_align;///< alignof(T)
+		const void *type;		///< &type_tag<T>
+	};
+
+	template <typename T>
+	inline constexpr PositionalOps positional_ops = {
+		[](void *pos) {
+			delete static_cast<TypedPositional<T> *>(pos);
+		},
+		[](const void *pos) -> void * {
+			return new TypedPositional<T>(*static_cast<const TypedPositional<T> *>(pos));
+		},
+		[](void *pos, std::string_view str, const ParseTrace *trace) {
+			return static_cast<TypedPositional<T> *>(pos)->set_value_from_string(str, trace);
+		},
+		[](void *pos) {
+			static_cast<TypedPositional<T> *>(pos)->reset();
+		},
+		[](const void *pos) {
+			return static_cast<const TypedPositional<T> *>(pos)->has_value();
+		},
+		[](const void *pos) {
+			return static_cast<const TypedPositional<T> *>(pos)->is_required();
+		},
+		[](const void *pos) -> const std::string & {
+			return static_cast<const TypedPositional<T> *>(pos)->name();
+		},
+		[](const void *pos) -> const std::string & {
+			return static_cast<const TypedPositional<T> *>(pos)->description();
+		},
+		[](const void *pos) {
+			return value_to_string(static_cast<const TypedPositional<T> *>(pos)->value());
+		},
+		[](const void *pos, std::string_view str, void *slot, bool constructed, std::pmr::memory_resource *resource) {
+			return parse_into_slot<T>(*static_cast<const TypedPositional<T> *>(pos), str, slot, constructed, resource);
+		},
+		[](void *slot) {
+			std::destroy_at(std::launder(static_cast<T *>(slot)));
+		},
+		[](const void *slot, SnapshotWriter &out) {
+			snapshot_values<T>(out, std::span<const T>(std::launder(static_cast<const T *>(slot)), 1), [](const T &value) {
+				return value_text(value);
+			});
+		},
+		[](const void *pos, const ValueSink &sink) {
+			if (const auto &value = static_cast<const TypedPositional<T> *>(pos)->value(); value.has_value()) {
+				dump_value(*value, sink);
+			}
+		},
+		[](const void *pos, MemoryStats &stats) {
+			static_cast<const TypedPositional<T> *>(pos)->add_memory(stats);
+		},
+		[](const void *slot) {
+			return heap_bytes(*std::launder(static_cast<const T *>(slot)));
+		},
+		sizeof(T),
+		alignof(T),
+		&type_tag<T>,
+	};
+
+	/**
+	 * @brief Owning handle to a flag of any type: object pointer plus static vtable.
+	 *
+	 * Two pointers in size regardless of T; moving it never moves the flag, so
+	 * TypedFlag<T>& references returned by add_flag stay valid.
+	 */
+	class FlagStorage {
+	  public:
+		FlagStorage() = default;
+
+		template <typename T>
+		explicit FlagStorage(std::unique_ptr<TypedFlag<T>> flag) : ptr_(flag.release()), ops_(&flag_ops<T>) {
+		}
+
+		FlagStorage(FlagStorage &&other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)), ops_(other.ops_) {
+		}
+
+		FlagStorage &operator=(FlagStorage &&other) noexcept {
+			if (this != &other) {
+				destroy();
+				ptr_ = std::exchange(other.ptr_, nullptr);
+				ops_ = other.ops_;
+			}
+			return *this;
+		}
+
+		FlagStorage(const FlagStorage &) = delete;
+		FlagStorage &operator=(const FlagStorage &) = delete;
+
+		~FlagStorage() {
+			destroy();
+		}
+
+		/**
+		 * @brief Typed access; nullptr if the flag does not hold a TypedFlag<T>.
+		 */
+		template <typename T>
+		[[nodiscard]] TypedFlag<T> *get_if() const noexcept {
+			return ops_ != nullptr && ops_->type == &type_tag<T> ? static_cast<TypedFlag<T> *>(ptr_) : nullptr;
+		}
+
+		[[nodiscard]] void *get() const noexcept {
+			return ptr_;
+		}
+
+		Result<void> set_value(std::string_view str, const ParseTrace *trace = nullptr) const {
+			return ops_->set_value(ptr_, str, ValueSource::CommandLine, trace);
+		}
+
+		/**
+		 * @brief Set a value from the environment or a config file (see TypedFlag::set_value_from).
+		 */
+		Result<void> set_value_from(std::string_view str, ValueSource source, const ParseTrace *trace = nullptr) const {
+			return ops_->set_value(ptr_, str, source, trace);
+		}
+
+		/**
+		 * @brief Forget the parsed value and restore the default (see Parser::reset).
+		 */
+		void reset() const {
+			ops_->reset(ptr_);
+		}
+
+		[[nodiscard]] Result<void> validate() const {
+			return ops_->validate(ptr_);
+		}
+
+		[[nodiscard]] bool has_value() const {
+			return ops_->has_value(ptr_);
+		}
+
+		[[nodiscard]] bool is_required() const {
+			return ops_->is_required(ptr_);
+		}
+
+		[[nodiscard]] bool is_multi() const {
+			return ops_->is_multi(ptr_);
+		}
+
+		[[nodiscard]] bool has_default() const {
+			return ops_->has_default(ptr_);
+		}
+
+		[[nodiscard]] const std::string &get_short_name() const {
+			return ops_->short_name(ptr_);
+		}
+
+		[[nodiscard]] const std::string &get_description() const {
+			return ops_->description(ptr_);
+		}
+
+		[[nodiscard]] const std::string &get_env_name() const {
+			return ops_->env_name(ptr_);
+		}
+
+		[[nodiscard]] std::optional<std::string> get_value_as_string() const {
+			return ops_->value_as_string(ptr_);
+		}
+
+		[[nodiscard]] bool is_boolean() const noexcept {
+			return ops_->is_boolean;
+		}
+
+		/**
+		 * @brief Append each allowed choice as it is typed on the command line.
+		 */
+		void append_choices(std::vector<std::string> &out) const {
+			ops_->choice_texts(ptr_, out);
+		}
+
+		/**
+		 * @brief Deep copy of the flag (options, default, validator, current value).
+		 */
+		[[nodiscard]] FlagStorage clone() const {
+			return FlagStorage(ops_->clone(ptr_), ops_);
+		}
+
+		/** @name External value slots (see ParserSpec) */
+		///@{
+		Result<void> parse_into(void *slot, std::string_view str, bool constructed, std::pmr::memory_resource *resource) const {
+			return ops_->parse_into(ptr_, str, slot, constructed, resource);
+		}
+		bool default_into(void *slot, std::pmr::memory_resource *resource) const {
+			return ops_->default_into(ptr_, slot, resource);
+		}
+		void destroy_value(void *slot) const {
+			ops_->destroy_value(ptr_, slot);
+		}
+		void snapshot(const void *slot, SnapshotWriter &out) const {
+			ops_->snapshot(ptr_, slot, out);
+		}
+		/**
+		 * @brief Hand the current value (or default), or every value if repeatable, to a sink.
+		 */
+		void dump(const ValueSink &sink) const {
+			ops_->dump(ptr_, sink);
+		}
+
+		/**
+		 * @brief Add the flag's memory to stats (see MemoryStats).
+		 */
+		void add_memory(MemoryStats &stats) const {
+			ops_->memory(ptr_, stats);
+		}
+
+		/**
+		 * @brief Heap bytes of the value in a ParseResult slot.
+		 */
+		[[nodiscard]] std::size_t value_memory(const void *slot) const {
+			return ops_->value_memory(ptr_, slot);
+		}
+
+		[[nodiscard]] std::size_t value_size() const {
+			return is_multi() ? ops_->multi_value_size : ops_->value_size;
+		}
+		[[nodiscard]] std::size_t value_align() const {
+			return is_multi() ? ops_->multi_value_align : ops_->value_align;
+		}
+		///@}
+
+	  private:
+		void *ptr_ = nullptr;		  ///< owned TypedFlag<T>
+		const FlagOps *ops_ = nullptr;///< &flag_ops<T>
+
+		FlagStorage(void *ptr, const FlagOps *ops) : ptr_(ptr), ops_(ops) {
+		}
+
+		/**
+		 * @brief Delete the owned flag; the handle is empty afterwards.
+		 */
+		void destroy() noexcept {
+			if (ptr_ != nullptr) {
+				ops_->destroy(ptr_);
+				ptr_ = nullptr;
+			}
+		}
+	};
+
+	/**
+	 * @brief Owning handle to a positional of any type: object pointer plus static vtable.
+	 */
+	class PositionalStorage {
+	  public:
+		PositionalStorage() = default;
+
+		template <typename T>
+		explicit PositionalStorage(std::unique_ptr<TypedPositional<T>> pos) : ptr_(pos.release()), ops_(&positional_ops<T>) {
+		}
+
+		PositionalStorage(PositionalStorage &&other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)), ops_(other.ops_) {
+		}
+
+		PositionalStorage &operator=(PositionalStorage &&other) noexcept {
+			if (this != &other) {
+				destroy();
+				ptr_ = std::exchange(other.ptr_, nullptr);
+				ops_ = other.ops_;
+			}
+			return *this;
+		}
+
+		PositionalStorage(const PositionalStorage &) = delete;
+		PositionalStorage &operator=(const PositionalStorage &) = delete;
+
+		~PositionalStorage() {
+			destroy();
+		}
+
+		/**
+		 * @brief Typed access; nullptr if the slot does not hold a TypedPositional<T>.
+		 */
+		template <typename T>
+		[[nodiscard]] TypedPositional<T> *get_if() const noexcept {
+			return ops_ != nullptr && ops_->type == &type_tag<T> ? static_cast<TypedPositional<T> *>(ptr_) : nullptr;
+		}
+
+		[[nodiscard]] void *get() const noexcept {
+			return ptr_;
+		}
+
+		Result<void> set_value(std::string_view str, const ParseTrace *trace = nullptr) const {
+			return ops_->set_value(ptr_, str, trace);
+		}
+
+		/**
+		 * @brief Forget the parsed value (see Parser::reset).
+		 */
+		void reset() const {
+			ops_->reset(ptr_);
+		}
+
+		[[nodiscard]] bool has_value() const {
+			return ops_->has_value(ptr_);
+		}
+
+		[[nodiscard]] bool is_required() const {
+			return ops_->is_required(ptr_);
+		}
+
+		[[nodiscard]] const std::string &get_name() const {
+			return ops_->name(ptr_);
+		}
+
+		[[nodiscard]] const std::string &get_description() const {
+			return ops_->description(ptr_);
+		}
+
+		[[nodiscard]] std::optional<std::string> get_value_as_string() const {
+			return ops_->value_as_string(ptr_);
+		}
+
+		/**
+		 * @brief Deep copy of the positional (options, validator, current value).
+		 */
+		[[nodiscard]] PositionalStorage clone() const {
+			return PositionalStorage(ops_->clone(ptr_), ops_);
+		}
+
+		/** @name External value slots (see ParserSpec) */
+		///@{
+		Result<void> parse_into(void *slot, std::string_view str, bool constructed, std::pmr::memory_resource *resource) const {
+			return ops_->parse_into(ptr_, str, slot, constructed, resource);
+		}
+		void destroy_value(void *slot) const {
+			ops_->destroy_value(slot);
+		}
+		void snapshot(const void *slot, SnapshotWriter &out) const {
+			ops_->snapshot(slot, out);
+		}
+		void dump(const ValueSink &sink) const {
+			ops_->dump(ptr_, sink);
+		}
+
+		/**
+		 * @brief Add the positional's memory to stats (see MemoryStats).
+		 */
+		void add_memory(MemoryStats &stats) const {
+			ops_->memory(ptr_, stats);
+		}
+
+		/**
+		 * @brief Heap bytes of the value in a ParseResult slot.
+		 */
+		[[nodiscard]] std::size_t value_memory(const void *slot) const {
+			return ops_->value_memory(slot);
+		}
+
+		[[nodiscard]] std::size_t value_size() const noexcept {
+			return ops_->value_size;
+		}
+		[[nodiscard]] std::size_t value_align() const noexcept {
+			return ops_->value_align;
+		}
+		///@}
+
+	  private:
+		void *ptr_ = nullptr;				///< owned TypedPositional<T>
+		const PositionalOps *ops_ = nullptr;///< &positional_ops<T>
+
+		PositionalStorage(void *ptr, const PositionalOps *ops) : ptr_(ptr), ops_(ops) {
+		}
+
+		/**
+		 * @brief Delete the owned positional; the handle is empty afterwards.
+		 */
+		void destroy() noexcept {
+			if (ptr_ != nullptr) {
+				ops_->destroy(ptr_);
+				ptr_ = nullptr;
+			}
+		}
+	};
+
+}// namespace cli::detail
+
+#endif// CPPLI_STORAGE_HPP
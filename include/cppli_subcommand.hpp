@@ -1,13 +1,22 @@
 #ifndef CPPLI_SUBCOMMAND_HPP
 #define CPPLI_SUBCOMMAND_HPP
 
+#include "cppli_dump.hpp"
 #include "cppli_error.hpp"
+#include "cppli_help.hpp"
+#include "cppli_name_table.hpp"
+#include "cppli_observer.hpp"
+#include "cppli_spec.hpp"
+#include "cppli_storage.hpp"
 #include "cppli_types.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <functional>
 #include <iostream>
-#include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -16,6 +25,12 @@ namespace cli {
 
 	// Forward declaration
 	class Parser;
+	class Subcommand;
+
+	/**
+	 * @brief Defines a lazily registered subcommand (see Parser::add_lazy_subcommand).
+	 */
+	using SubcommandFactory = std::function<void(Subcommand &)>;
 
 	/**
 	 * @brief Represents a subcommand with its own flags, positionals, and nested subcommands.
@@ -47,7 +62,7 @@ namespace cli {
 		 * @param parent Pointer to parent Parser (for accessing global state).
 		 * @param parent_subcommand Pointer to parent Subcommand (for nested subcommands).
 		 */
-		Subcommand(std::string name, std::string description, Parser *parent = nullptr, Subcommand *parent_subcommand = nullptr);
+		Subcommand(std::string name, detail::HelpText description, Parser *parent = nullptr, Subcommand *parent_subcommand = nullptr);
 
 		/**
 		 * @brief Add a typed flag to this subcommand.
@@ -57,7 +72,7 @@ namespace cli {
 		 * @return TypedFlag<T>& Reference for chaining configuration.
 		 */
 		template <typename T = std::string>
-		TypedFlag<T> &add_flag(std::string long_name, std::string description);
+		TypedFlag<T> &add_flag(std::string long_name, detail::HelpText description);
 
 		/**
 		 * @brief Add a typed positional argument to this subcommand.
@@ -68,7 +83,7 @@ namespace cli {
 		 * @return TypedPositional<T>& Reference for chaining configuration.
 		 */
 		template <typename T = std::string>
-		TypedPositional<T> &add_positional(std::string name, std::string description, bool required = true);
+		TypedPositional<T> &add_positional(std::string name, detail::HelpText description, bool required = true);
 
 		/**
 		 * @brief Add a nested subcommand.
@@ -76,7 +91,16 @@ namespace cli {
 		 * @param description Brief description.
 		 * @return Subcommand& Reference to the created subcommand.
 		 */
-		Subcommand &add_subcommand(std::string name, std::string description);
+		Subcommand &add_subcommand(std::string name, detail::HelpText description);
+
+		/**
+		 * @brief Add a nested subcommand defined on first use (see Parser::add_lazy_subcommand).
+		 * @param name Subcommand name.
+		 * @param description Brief description.
+		 * @param factory Called once with the empty subcommand to define it.
+		 * @return Subcommand& This subcommand, for chaining.
+		 */
+		Subcommand &add_lazy_subcommand(std::string name, detail::HelpText description, SubcommandFactory factory);
 
 		/**
 		 * @brief Set a callback to be invoked when this subcommand is selected.
@@ -85,6 +109,21 @@ namespace cli {
 		 */
 		Subcommand &set_callback(std::function<void()> callback);
 
+		/**
+		 * @brief Let this callback run alongside adjacent concurrent ones on the Parser's executor.
+		 *
+		 * In `tool fetch-a fetch-b build`, marking both fetches concurrent runs
+		 * them in one stage, while build waits for both. Without an executor
+		 * (see Parser::set_executor) callbacks always run one after another.
+		 *
+		 * @param concurrent True (default true) to share a stage with concurrent neighbours.
+		 * @return Subcommand& for chaining.
+		 */
+		Subcommand &set_concurrent(bool concurrent = true) noexcept {
+			concurrent_ = concurrent;
+			return *this;
+		}
+
 		/**
 		 * @brief Add help flag to this subcommand.
 		 * @return Subcommand& for chaining.
@@ -97,7 +136,21 @@ namespace cli {
 		 * @param command Example command line.
 		 * @return Subcommand& for chaining.
 		 */
-		Subcommand &add_example(std::string description, std::string command);
+		Subcommand &add_example(detail::HelpText description, detail::HelpText command);
+
+		/**
+		 * @brief Capture every token after this subcommand's positionals (see Parser::add_rest_positional).
+		 * @param name Name shown in the usage line.
+		 * @return Subcommand& for chaining.
+		 */
+		Subcommand &add_rest_positional(std::string name);
+
+		/**
+		 * @brief Tokens captured by add_rest_positional(), valid until the Parser's next parse() or reset().
+		 */
+		[[nodiscard]] std::span<const std::string_view> get_rest() const noexcept {
+			return rest_;
+		}
 
 		/**
 		 * @brief Set whether this subcommand allows unknown flags to fallthrough to parent.
@@ -106,6 +159,19 @@ namespace cli {
 		 */
 		Subcommand &set_fallthrough(bool allow = true);
 
+		/**
+		 * @brief Report this subcommand's parse stages to its own observer.
+		 *
+		 * Without one, events go to the parent's observer (see Parser::set_observer).
+		 *
+		 * @param observer Observer, or nullptr to use the parent's.
+		 * @return Subcommand& for chaining.
+		 */
+		Subcommand &set_observer(ParseObserver *observer) noexcept {
+			observer_ = observer;
+			return *this;
+		}
+
 		/**
 		 * @brief Get flag value by name.
 		 * @tparam T Expected type.
@@ -115,6 +181,16 @@ namespace cli {
 		template <typename T = std::string>
 		[[nodiscard]] std::optional<T> get(std::string_view flag_name) const;
 
+		/**
+		 * @brief Get every value of a repeatable flag (see TypedFlag::set_multi).
+		 * @tparam T Element type.
+		 * @param flag_name Long name of the flag.
+		 * @return std::span<const T> View of the stored values (or the default); empty if absent or the type does not match.
+		 */
+		template <typename T = std::string>
+			requires(! std::is_same_v<T, bool>)
+		[[nodiscard]] std::span<const T> get_all(std::string_view flag_name) const;
+
 		/**
 		 * @brief Check if flag was provided.
 		 * @param flag_name Long name of the flag.
@@ -146,6 +222,36 @@ namespace cli {
 		 */
 		[[nodiscard]] std::optional<std::string> get_selected_subcommand() const;
 
+		/**
+		 * @brief Write this subcommand's resolved values, then its selected subcommand's (see Parser::dump_values).
+		 * @param out Destination iterator.
+		 * @return OutputIt Iterator past the last character written.
+		 */
+		template <typename OutputIt>
+		OutputIt dump_values(OutputIt out) const {
+			detail::DumpState<OutputIt> state{out};
+			dump_level(state, nullptr);
+			return state.out;
+		}
+
+		/**
+		 * @brief Write this subcommand's resolved values as one JSON object (see Parser::dump_values_json).
+		 * @param out Destination iterator.
+		 * @return OutputIt Iterator past the last character written.
+		 */
+		template <typename OutputIt>
+		OutputIt dump_values_json(OutputIt out) const {
+			detail::DumpState<OutputIt> state{out, true};
+			dump_level(state, nullptr);
+			return state.out;
+		}
+
+		/**
+		 * @brief Heap memory held by this subcommand and its subcommands (see Parser::memory_stats).
+		 * @return MemoryStats Breakdown, without this Subcommand object itself.
+		 */
+		[[nodiscard]] MemoryStats memory_stats() const;
+
 		/**
 		 * @brief Access a nested subcommand by name.
 		 * @param name Subcommand name.
@@ -179,6 +285,10 @@ namespace cli {
 
 		/**
 		 * @brief Generate help text specific to this subcommand.
+		 *
+		 * Rendered once per full_chain setting and cached until this
+		 * subcommand's definition changes (see Parser::generate_help).
+		 *
 		 * @param full_chain If true, include parent command names.
 		 * @return std::string Formatted help output.
 		 */
@@ -192,52 +302,41 @@ namespace cli {
 		void print_help(std::ostream &os = std::cout, bool full_chain = true) const;
 
 		/**
-		 * @brief Invoke the callback if set.
+		 * @brief Write the cached help text straight to a C stream.
+		 * @param stream Destination (default: stdout).
+		 * @param full_chain Include parent command names.
 		 */
-		void invoke_callback() const;
-
-	  private:
-		friend class Parser;
+		void write_help(std::FILE *stream = stdout, bool full_chain = true) const;
 
 		/**
-		 * @brief Type-erased flag storage (same as in Parser).
+		 * @brief Copy the cached help text to an output iterator.
+		 * @param out Destination iterator, e.g. std::back_inserter(buffer).
+		 * @param full_chain Include parent command names.
+		 * @return OutputIt Iterator past the last character written.
 		 */
-		struct FlagStorage {
-			std::unique_ptr<void, void (*)(void *)> ptr;
-			std::function<Result<void>(std::string_view)> set_value;
-			std::function<Result<void>()> validate;
-			std::function<bool()> has_value;
-			std::function<bool()> is_required;
-			std::function<std::string()> get_short_name;
-			std::function<std::string()> get_description;
-			std::function<std::string()> format_for_help;
-			std::function<std::optional<std::string>()> get_value_as_string;
-			std::function<bool()> is_boolean;
+		template <typename OutputIt>
+		OutputIt format_to(OutputIt out, bool full_chain = true) const {
+			const std::string &text = help_text(full_chain);
+			return std::copy(text.begin(), text.end(), out);
+		}
 
-			FlagStorage()
-				: ptr(nullptr, [](void *) {
-				  }) {
-			}
-		};
+		/**
+		 * @brief Invoke the callback if set.
+		 */
+		void invoke_callback() const;
 
 		/**
-		 * @brief Type-erased positional storage (same as in Parser).
+		 * @brief Clear parse state here and in nested subcommands (see Parser::reset).
 		 */
-		struct PositionalStorage {
-			std::unique_ptr<void, void (*)(void *)> ptr;
-			std::function<Result<void>(std::string_view)> set_value;
-			std::function<bool()> has_value;
-			std::function<bool()> is_required;
-			std::function<std::string()> get_name;
-			std::function<std::string()> get_description;
-			std::function<std::optional<std::string>()> get_value_as_string;
+		void reset();
 
-			PositionalStorage()
-				: ptr(nullptr, [](void *) {
-				  }) {
-			}
-		};
+	  private:
+		friend class Parser;
+
+		using FlagStorage = detail::FlagStorage;
+		using PositionalStorage = detail::PositionalStorage;
 
+#ifndef CPPLI_MINIMAL
 		/**
 		 * @brief Example usage line.
 		 */
@@ -245,167 +344,173 @@ namespace cli {
 			std::string description;
 			std::string command;
 		};
+#endif
 
 		std::string name_;
-		std::string description_;
+		detail::HelpText description_;
 		Parser *parent_;
 		Subcommand *parent_subcommand_;
-		std::map<std::string, FlagStorage> flags_;
-		std::map<std::string, std::string> short_to_long_;
+		detail::NameTable<FlagStorage> flags_;
+		std::unique_ptr<detail::ShortNameIndex> short_index_;
+		std::unique_ptr<detail::CommandPresence> presence_;///< required/has-value bits, kept current by the flags and positionals
 		std::vector<PositionalStorage> positionals_;
-		std::map<std::string, std::unique_ptr<Subcommand>> subcommands_;
+		detail::NameTable<std::uint32_t> positional_index_;///< positional name -> index into positionals_
+		std::optional<std::string> rest_name_;
+		std::span<const std::string_view> rest_;///< points into the Parser's argument storage
+		detail::NameTable<std::unique_ptr<Subcommand>> subcommands_;
+#ifndef CPPLI_MINIMAL
 		std::vector<Example> examples_;
+#endif
 		std::optional<std::string> selected_subcommand_;
 		std::function<void()> callback_;
+		SubcommandFactory factory_;///< set until a lazy subcommand is defined
+		ParseObserver *observer_ = nullptr;
 		bool parsed_ = false;
 		bool help_requested_ = false;
 		bool fallthrough_ = false;
+		bool concurrent_ = false;	///< shares an executor stage with adjacent concurrent subcommands
+		std::uint64_t revision_ = 0;///< bumped on changes shown in the help
+		mutable detail::HelpCache help_cache_[2];///< indexed by full_chain
+		mutable detail::LazyNameTrie flag_names_;	   ///< long names, for abbreviations and suggestions
+		mutable detail::LazyNameTrie subcommand_names_;///< subcommand names, likewise
+
+		/**
+		 * @brief Run the factory of a lazy subcommand, once; no-op otherwise.
+		 */
+		void materialize();
 
 		/**
 		 * @brief Parse arguments for this subcommand.
-		 * @param args Arguments to parse (starting from first arg after subcommand name).
+		 * @param args Arguments to parse, already expanded for @file response files by the Parser.
 		 * @param start_index Index to start parsing from.
+		 * @param parent_trace Parent's observer context, or nullptr.
 		 * @return Result<size_t> Number of args consumed, or error.
 		 */
-		[[nodiscard]] Result<size_t> parse_args(const std::vector<std::string> &args, size_t start_index);
+		[[nodiscard]] Result<size_t> parse_args(std::span<const std::string_view> args, size_t start_index, const detail::ParseTrace *parent_trace);
+
+		/**
+		 * @brief Body of parse_args(), reporting to this level's trace.
+		 */
+		[[nodiscard]] Result<size_t> parse_tokens(std::span<const std::string_view> args, size_t start_index, const detail::ParseTrace *trace);
 
 		/**
-		 * @brief Validate requirements after parsing.
+		 * @brief Validate requirements after parsing, then those of the selected subcommands below this one.
 		 * @return Result<void> ok() if valid, err() otherwise.
 		 */
 		[[nodiscard]] Result<void> validate_requirements() const;
 
 		/**
-		 * @brief Format a flag for help output.
-		 * @param flag The flag storage.
-		 * @param long_name Flag's long name.
-		 * @return std::string Formatted line.
+		 * @brief Cached help text, re-rendered if the definition changed since.
+		 * @param full_chain Include parent command names.
+		 * @return const std::string& Help output, valid until the next change.
 		 */
-		[[nodiscard]] std::string format_flag_for_help(const FlagStorage &flag, const std::string &long_name) const;
+		[[nodiscard]] const std::string &help_text(bool full_chain) const;
+
+		/**
+		 * @brief Render the help text from scratch.
+		 * @param out Buffer to append to.
+		 * @param full_chain Include parent command names.
+		 */
+		void render_help(std::string &out, bool full_chain) const;
+
+		/**
+		 * @brief Copy this subcommand tree into an immutable spec node (see Parser::freeze).
+		 * @return std::unique_ptr<detail::SpecCommand> Frozen subcommand.
+		 */
+		[[nodiscard]] std::unique_ptr<detail::SpecCommand> freeze() const;
 
 		/**
 		 * @brief Get the full command chain (parent commands + this command).
 		 * @return std::string Full command path.
 		 */
 		[[nodiscard]] std::string get_command_chain() const;
+
+		/**
+		 * @brief Dump this level, then recurse into the selected subcommand.
+		 * @param state Output and separator state.
+		 * @param path Names of the levels above, used as the text prefix.
+		 */
+		template <typename OutputIt>
+		void dump_level(detail::DumpState<OutputIt> &state, const detail::DumpPath *path) const;
 	};
 
 	// Template implementations
 	template <typename T>
-	TypedFlag<T> &Subcommand::add_flag(std::string long_name, std::string description) {
+	TypedFlag<T> &Subcommand::add_flag(std::string long_name, detail::HelpText description) {
 		auto flag = std::make_unique<TypedFlag<T>>(long_name, std::move(description));
 		auto *flag_ptr = flag.get();
 
-		FlagStorage storage;
-		storage.ptr = std::unique_ptr<void, void (*)(void *)>(flag.release(), [](void *p) {
-			delete static_cast<TypedFlag<T> *>(p);
-		});
-		storage.set_value = [flag_ptr](std::string_view str) {
-			return flag_ptr->set_value_from_string(str);
-		};
-		storage.validate = [flag_ptr]() {
-			return flag_ptr->validate();
-		};
-		storage.has_value = [flag_ptr]() {
-			return flag_ptr->has_value();
-		};
-		storage.is_required = [flag_ptr]() {
-			return flag_ptr->is_required();
-		};
-		storage.get_short_name = [flag_ptr]() {
-			return flag_ptr->short_name();
-		};
-		storage.get_description = [flag_ptr]() {
-			return flag_ptr->description();
-		};
-		storage.format_for_help = [this, long_name = std::string(long_name)]() {
-			return this->format_flag_for_help(flags_.at(long_name), long_name);
-		};
-		storage.get_value_as_string = [flag_ptr]() -> std::optional<std::string> {
-			if (flag_ptr->has_value()) {
-				if constexpr (std::is_same_v<T, std::string>) {
-					return flag_ptr->value();
-				} else if constexpr (std::is_same_v<T, bool>) {
-					return flag_ptr->value() ? "true" : "false";
-				} else {
-					return std::to_string(*flag_ptr->value());
-				}
-			}
-			return std::nullopt;
-		};
-		storage.is_boolean = []() {
-			return std::is_same_v<T, bool>;
-		};
+		auto index = flags_.index_of(long_name);
+		if (index != detail::NameTable<FlagStorage>::npos) {
+			short_index_->remove(flags_.at(index).value.get_short_name(), static_cast<std::uint32_t>(index));
+		} else {
+			index = flags_.size();
+		}
 
-		auto *result_ptr = storage.ptr.get();
-		flags_[long_name] = std::move(storage);
-		return *static_cast<TypedFlag<T> *>(result_ptr);
+		flags_.insert_or_assign(std::move(long_name), FlagStorage(std::move(flag)));
+		flag_ptr->attach_short_index(*short_index_, static_cast<std::uint32_t>(index));
+		flag_ptr->attach_presence(presence_->flags, static_cast<std::uint32_t>(index));
+		return *flag_ptr;
 	}
 
 	template <typename T>
-	TypedPositional<T> &Subcommand::add_positional(std::string name, std::string description, bool required) {
-		auto pos = std::make_unique<TypedPositional<T>>(name, std::move(description), required);
+	TypedPositional<T> &Subcommand::add_positional(std::string name, detail::HelpText description, bool required) {
+		auto pos = std::make_unique<TypedPositional<T>>(std::move(name), std::move(description), required);
 		auto *pos_ptr = pos.get();
-
-		PositionalStorage storage;
-		storage.ptr = std::unique_ptr<void, void (*)(void *)>(pos.release(), [](void *p) {
-			delete static_cast<TypedPositional<T> *>(p);
-		});
-		storage.set_value = [pos_ptr](std::string_view str) {
-			return pos_ptr->set_value_from_string(str);
-		};
-		storage.has_value = [pos_ptr]() {
-			return pos_ptr->has_value();
-		};
-		storage.is_required = [pos_ptr]() {
-			return pos_ptr->is_required();
-		};
-		storage.get_name = [pos_ptr]() {
-			return pos_ptr->name();
-		};
-		storage.get_description = [pos_ptr]() {
-			return pos_ptr->description();
-		};
-		storage.get_value_as_string = [pos_ptr]() -> std::optional<std::string> {
-			if (pos_ptr->has_value()) {
-				if constexpr (std::is_same_v<T, std::string>) {
-					return pos_ptr->value();
-				} else if constexpr (std::is_same_v<T, bool>) {
-					return pos_ptr->value() ? "true" : "false";
-				} else {
-					return std::to_string(*pos_ptr->value());
-				}
-			}
-			return std::nullopt;
-		};
-
-		positionals_.push_back(std::move(storage));
-		return *static_cast<TypedPositional<T> *>(positionals_.back().ptr.get());
+		if (! positional_index_.contains(pos_ptr->name())) {
+			positional_index_.insert_or_assign(pos_ptr->name(), static_cast<std::uint32_t>(positionals_.size()));
+		}
+		pos_ptr->attach_presence(presence_->positionals, static_cast<std::uint32_t>(positionals_.size()));
+		positionals_.emplace_back(std::move(pos));
+		++revision_;
+		return *pos_ptr;
 	}
 
 	template <typename T>
 	std::optional<T> Subcommand::get(std::string_view flag_name) const {
-		auto it = flags_.find(std::string(flag_name));
-		if (it == flags_.end() || ! it->second.has_value()) {
+		const auto *storage = flags_.find(flag_name);
+		if (storage == nullptr) {
 			return std::nullopt;
 		}
 
-		auto *flag_ptr = static_cast<TypedFlag<T> *>(it->second.ptr.get());
-		if (! flag_ptr->has_value()) {
+		const auto *flag_ptr = storage->template get_if<T>();
+		if (flag_ptr == nullptr || ! flag_ptr->has_value()) {
 			return std::nullopt;
 		}
 
+		if constexpr (! std::is_same_v<T, bool>) {
+			if (flag_ptr->is_multi()) {
+				return flag_ptr->all_values().back();
+			}
+		}
+
 		return flag_ptr->value();
 	}
 
+	template <typename T>
+		requires(! std::is_same_v<T, bool>)
+	std::span<const T> Subcommand::get_all(std::string_view flag_name) const {
+		const auto *storage = flags_.find(flag_name);
+		if (storage == nullptr) {
+			return {};
+		}
+
+		const auto *flag_ptr = storage->template get_if<T>();
+		if (flag_ptr == nullptr || ! flag_ptr->is_multi()) {
+			return {};
+		}
+
+		return flag_ptr->all_values();
+	}
+
 	template <typename T>
 	std::optional<T> Subcommand::get_positional(size_t index) const {
 		if (index >= positionals_.size()) {
 			return std::nullopt;
 		}
 
-		auto *pos_ptr = static_cast<TypedPositional<T> *>(positionals_[index].ptr.get());
-		if (! pos_ptr->has_value()) {
+		const auto *pos_ptr = positionals_[index].template get_if<T>();
+		if (pos_ptr == nullptr || ! pos_ptr->has_value()) {
 			return std::nullopt;
 		}
 
@@ -414,16 +519,35 @@ namespace cli {
 
 	template <typename T>
 	std::optional<T> Subcommand::get_positional(std::string_view name) const {
-		for (const auto &pos_storage: positionals_) {
-			if (pos_storage.get_name() == name) {
-				auto *pos_ptr = static_cast<TypedPositional<T> *>(pos_storage.ptr.get());
-				if (! pos_ptr->has_value()) {
-					return std::nullopt;
+		const auto *index = positional_index_.find(name);
+		if (index == nullptr) {
+			return std::nullopt;
+		}
+		return get_positional<T>(*index);
+	}
+
+	template <typename OutputIt>
+	void Subcommand::dump_level(detail::DumpState<OutputIt> &state, const detail::DumpPath *path) const {
+		if (state.json) {
+			*state.out++ = '{';
+			state.first_entry = true;
+		}
+		detail::dump_entries(state, flags_, positionals_, path);
+
+		if (selected_subcommand_.has_value()) {
+			if (const auto *sub = subcommands_.find(*selected_subcommand_); sub != nullptr) {
+				const detail::DumpPath child{*selected_subcommand_, path};
+				if (state.json) {
+					detail::dump_key(state, path, child.name);
 				}
-				return pos_ptr->value();
+				(*sub)->dump_level(state, &child);
 			}
 		}
-		return std::nullopt;
+
+		if (state.json) {
+			*state.out++ = '}';
+			state.first_entry = false;
+		}
 	}
 }// namespace cli
 
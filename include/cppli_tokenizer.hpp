@@ -0,0 +1,264 @@
+#ifndef CPPLI_TOKENIZER_HPP
+#define CPPLI_TOKENIZER_HPP
+
+#include "cppli_error.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace cli::detail {
+
+	/**
+	 * @brief Shape of one command-line token, decided by classify_token().
+	 */
+	enum class TokenKind : std::uint8_t {
+		Positional,	  ///< anything not starting with `-`, plus a lone `-`
+		Long,		  ///< `--name`
+		LongWithValue,///< `--name=value`
+		Short,		  ///< `-s`, or a bundle such as `-abc` / `-p8080`
+		DoubleDash,	  ///< `--`: every later token is positional
+	};
+
+	/**
+	 * @brief A classified token; name and value are views into the argument.
+	 */
+	struct Token {
+		TokenKind kind;
+		std::string_view name; ///< flag name without dashes (the whole bundle for Short)
+		std::string_view value;///< text after `=` for LongWithValue, the whole token for Positional
+	};
+
+	/**
+	 * @brief A flag found by a tokenizer handler, with its long name for errors and messages.
+	 */
+	template <typename Flag>
+	struct FlagMatch {
+		std::string_view name;
+		const Flag *flag = nullptr;
+		bool ambiguous = false;///< no flag: the name abbreviates several
+	};
+
+	namespace token_bytes {
+		inline constexpr std::uint8_t other = 0;
+		inline constexpr std::uint8_t dash = 1;
+		inline constexpr std::uint8_t equals = 2;
+
+		inline constexpr std::array<std::uint8_t, 256> classes = [] {
+			std::array<std::uint8_t, 256> table{};
+			table[static_cast<unsigned char>('-')] = dash;
+			table[static_cast<unsigned char>('=')] = equals;
+			return table;
+		}();
+	}// namespace token_bytes
+
+	/**
+	 * @brief Classify a token in one pass over its bytes.
+	 */
+	[[nodiscard]] constexpr Token classify_token(std::string_view arg) noexcept {
+		enum class State : std::uint8_t { Start, Dash, DoubleDash, LongName };
+
+		State state = State::Start;
+		for (std::size_t i = 0; i < arg.size(); ++i) {
+			const std::uint8_t cls = token_bytes::classes[static_cast<unsigned char>(arg[i])];
+			switch (state) {
+				case State::Start:
+					if (cls != token_bytes::dash) {
+						return {TokenKind::Positional, {}, arg};
+					}
+					state = State::Dash;
+					break;
+				case State::Dash:
+					if (cls != token_bytes::dash) {
+						return {TokenKind::Short, arg.substr(1), {}};
+					}
+					state = State::DoubleDash;
+					break;
+				case State::DoubleDash:
+				case State::LongName:
+					if (cls == token_bytes::equals) {
+						return {TokenKind::LongWithValue, arg.substr(2, i - 2), arg.substr(i + 1)};
+					}
+					state = State::LongName;
+					break;
+			}
+		}
+
+		switch (state) {
+			case State::DoubleDash:
+				return {TokenKind::DoubleDash, {}, {}};
+			case State::LongName:
+				return {TokenKind::Long, arg.substr(2), {}};
+			default:// empty, or a lone `-` (conventionally stdin)
+				return {TokenKind::Positional, {}, arg};
+		}
+	}
+
+	/**
+	 * @brief Whether a token can be a flag's value rather than a flag of its own.
+	 */
+	[[nodiscard]] constexpr bool is_value_token(std::string_view arg) noexcept {
+		return classify_token(arg).kind == TokenKind::Positional;
+	}
+
+	/**
+	 * @brief Whether a token after a boolean flag is its explicit value (true/false/1/0/yes/no/on/off).
+	 */
+	[[nodiscard]] constexpr bool is_bool_literal(std::string_view arg) noexcept {
+		switch (arg.size()) {
+			case 1:
+				return arg[0] == '1' || arg[0] == '0';
+			case 2:
+				return arg == "no" || arg == "on";
+			case 3:
+				return arg == "yes" || arg == "off";
+			case 4:
+				return arg == "true";
+			case 5:
+				return arg == "false";
+			default:
+				return false;
+		}
+	}
+
+	/**
+	 * @brief The one parse loop shared by Parser, Subcommand and ParserSpec.
+	 *
+	 * Classifies each token and hands it to the handler, which owns lookup and
+	 * storage for its command level:
+	 *
+	 * - `FlagMatch<Flag> find_long(std::string_view name)`: exact, or an abbreviation if the level allows them
+	 * - `FlagMatch<Flag> find_short(std::string_view name)`
+	 * - `bool is_boolean(const Flag &flag)`
+	 * - `Result<void> set_flag(std::string_view name, const Flag &flag, std::string_view value)`
+	 * - `Result<std::optional<std::size_t>> subcommand(std::string_view arg, std::size_t next_index)`:
+	 *   parse a subcommand starting after arg and return the tokenizer's result, or nullopt if arg is not one
+	 * - `Result<bool> positional(std::string_view arg)`: store it, or false to stop at a surplus positional
+	 * - `bool fallthrough()`: stop (instead of failing) at an unknown flag
+	 * - `std::string_view suggest_long(std::string_view name)`: nearest long name for the error, or empty
+	 *
+	 * A short token that is not itself a short name is read as a bundle:
+	 * `-abc` sets the boolean flags a, b and c, and in `-p8080` (or `-vp8080`)
+	 * the first flag that takes a value gets the rest of the token, or the
+	 * next token if nothing is left.
+	 *
+	 * @return Result<size_t> Index of the first token not consumed, or the first error.
+	 */
+	template <typename Handler>
+	[[nodiscard]] Result<std::size_t> run_tokenizer(std::span<const std::string_view> args, std::size_t start_index, Handler &handler) {
+		bool after_double_dash = false;
+		std::size_t i = start_index;
+
+		// Give a flag without an inline value the next token, if that is a value.
+		auto take_value = [&](bool boolean) -> std::optional<std::string_view> {
+			if (i + 1 < args.size() && is_value_token(args[i + 1]) && (! boolean || is_bool_literal(args[i + 1]))) {
+				return args[++i];
+			}
+			if (boolean) {
+				return std::string_view("true");
+			}
+			return std::nullopt;
+		};
+
+		for (; i < args.size(); ++i) {
+			const std::string_view arg = args[i];
+			const Token token = after_double_dash ? Token{TokenKind::Positional, {}, arg} : classify_token(arg);
+
+			if (token.kind == TokenKind::DoubleDash) {
+				after_double_dash = true;
+				continue;
+			}
+
+			if (token.kind == TokenKind::Positional) {
+				if (! after_double_dash) {
+					auto sub = handler.subcommand(arg, i + 1);
+					if (! sub) {
+						return Result<std::size_t>::err(sub.error());
+					}
+					if (sub.value().has_value()) {
+						return Result<std::size_t>::ok(*sub.value());
+					}
+				}
+
+				auto stored = handler.positional(arg);
+				if (! stored) {
+					return Result<std::size_t>::err(stored.error());
+				}
+				if (! stored.value()) {
+					return Result<std::size_t>::ok(i);
+				}
+				continue;
+			}
+
+			auto match = token.kind == TokenKind::Short ? handler.find_short(token.name) : handler.find_long(token.name);
+
+			if (match.flag == nullptr && token.kind == TokenKind::Short && token.name.size() > 1) {
+				for (std::size_t k = 0; k < token.name.size(); ++k) {
+					const auto part = handler.find_short(token.name.substr(k, 1));
+					if (part.flag == nullptr) {
+						if (k == 0 && handler.fallthrough()) {
+							return Result<std::size_t>::ok(i);
+						}
+						return Result<std::size_t>::err(Error::unknown_flag(arg));
+					}
+
+					const bool boolean = handler.is_boolean(*part.flag);
+					const std::string_view rest = token.name.substr(k + 1);
+					std::optional<std::string_view> value;
+					if (boolean) {
+						value = "true";
+					} else if (! rest.empty()) {
+						value = rest;
+					} else {
+						value = take_value(false);
+						if (! value) {
+							return Result<std::size_t>::err(Error::missing_flag_value(part.name));
+						}
+					}
+
+					auto stored = handler.set_flag(part.name, *part.flag, *value);
+					if (! stored) {
+						return Result<std::size_t>::err(stored.error());
+					}
+					if (! boolean) {
+						break;// the value used up the rest of the bundle
+					}
+				}
+				continue;
+			}
+
+			if (match.flag == nullptr) {
+				if (handler.fallthrough()) {
+					return Result<std::size_t>::ok(i);
+				}
+				if (match.ambiguous) {
+					return Result<std::size_t>::err(Error::ambiguous_flag(arg));
+				}
+				const std::string_view suggestion = token.kind == TokenKind::Short ? std::string_view{} : handler.suggest_long(token.name);
+				return Result<std::size_t>::err(Error::unknown_flag(arg, suggestion));
+			}
+
+			std::optional<std::string_view> value;
+			if (token.kind == TokenKind::LongWithValue) {
+				value = token.value;
+			} else {
+				value = take_value(handler.is_boolean(*match.flag));
+				if (! value) {
+					return Result<std::size_t>::err(Error::missing_flag_value(match.name));
+				}
+			}
+
+			auto stored = handler.set_flag(match.name, *match.flag, *value);
+			if (! stored) {
+				return Result<std::size_t>::err(stored.error());
+			}
+		}
+
+		return Result<std::size_t>::ok(i);
+	}
+
+}// namespace cli::detail
+
+#endif// CPPLI_TOKENIZER_HPP
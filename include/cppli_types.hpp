@@ -1,11 +1,27 @@
 #ifndef CPPLI_TYPES_HPP
 #define CPPLI_TYPES_HPP
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <compare>
 #include <cppli_error.hpp>
+#include <cppli_memory.hpp>
+#include <cppli_name_table.hpp>
+#include <cppli_observer.hpp>
+#include <cppli_validators.hpp>
+#include <cstdint>
 #include <functional>
+#include <memory_resource>
 #include <optional>
+#include <ratio>
+#include <span>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace cli {
@@ -17,7 +33,13 @@ namespace cli {
 	 * from flags or positionals. The function must return Result<T> with either
 	 * a parsed value or an Error.
 	 *
-	 * Built-in specializations provided: std::string, int, double, bool.
+	 * Built-in specializations provided: std::string, std::pmr::string, bool,
+	 * every integer and floating-point type (including std::int64_t,
+	 * std::uint64_t and std::size_t), std::chrono::duration, ByteSize and
+	 * std::vector of a numeric type.
+	 *
+	 * A specialization may also provide `static std::string to_string(const T &)`,
+	 * which get_value_as_string() uses instead of std::to_string.
 	 */
 	template <typename T>
 	struct ValueConverter {
@@ -39,6 +61,19 @@ namespace cli {
 		}
 	};
 
+	/**
+	 * @brief ValueConverter specialization for std::pmr::string.
+	 *
+	 * The converted value uses the default resource; ParserSpec moves it into
+	 * a string allocated from the parse's memory resource when storing it.
+	 */
+	template <>
+	struct ValueConverter<std::pmr::string> {
+		static Result<std::pmr::string> from_string(std::string_view str) {
+			return Result<std::pmr::string>::ok(std::pmr::string(str));
+		}
+	};
+
 	/**
 	 * @brief ValueConverter specialization for int.
 	 *
@@ -70,15 +105,359 @@ namespace cli {
 		static Result<bool> from_string(std::string_view str);
 	};
 
+	namespace detail {
+		template <typename T>
+		concept character_type = std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char> ||
+								 std::is_same_v<T, wchar_t> || std::is_same_v<T, char8_t> || std::is_same_v<T, char16_t> ||
+								 std::is_same_v<T, char32_t>;
+
+		/**
+		 * @brief Integer types converted by the generic from_chars converter (int has its own).
+		 */
+		template <typename T>
+		concept from_chars_integer = std::is_integral_v<T> && ! std::is_same_v<T, bool> && ! std::is_same_v<T, int> && ! character_type<T>;
+
+		/**
+		 * @brief Floating-point types converted by the generic from_chars converter (double has its own).
+		 */
+		template <typename T>
+		concept from_chars_float = std::is_floating_point_v<T> && ! std::is_same_v<T, double>;
+
+		/**
+		 * @brief Element types accepted by the numeric list converter.
+		 */
+		template <typename T>
+		concept list_number = (std::is_integral_v<T> && ! std::is_same_v<T, bool> && ! character_type<T>) || std::is_floating_point_v<T>;
+
+		/**
+		 * @brief Parse the whole of str as a number with std::from_chars.
+		 *
+		 * Unlike ValueConverter<int> and ValueConverter<double>, trailing
+		 * characters are rejected.
+		 */
+		template <typename T>
+		Result<T> from_chars_value(std::string_view str, std::string_view invalid, std::string_view out_of_range) {
+			T value{};
+			const char *end = str.data() + str.size();
+			auto [ptr, ec] = std::from_chars(str.data(), end, value);
+
+			if (ec == std::errc::result_out_of_range) {
+				return Result<T>::err(Error(ErrorCode::InvalidFlagValue, out_of_range));
+			}
+			if (ec != std::errc() || ptr != end) {
+				return Result<T>::err(Error(ErrorCode::InvalidFlagValue, invalid));
+			}
+			return Result<T>::ok(value);
+		}
+
+		/**
+		 * @brief Render a number with std::to_chars (shortest round-trip form for floating point).
+		 */
+		template <typename T>
+		[[nodiscard]] std::string to_chars_string(T value) {
+			char buffer[64];
+			auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+			return std::string(buffer, ptr);
+		}
+
+		/**
+		 * @brief Parse a delimiter-separated list of numbers in one pass, appending to out.
+		 *
+		 * Counts the delimiters first so out grows at most once. An empty string
+		 * is an empty list; an empty element is an error.
+		 */
+		template <typename T>
+		Result<void> parse_number_list(std::string_view str, char delimiter, std::vector<T> &out) {
+			if (str.empty()) {
+				return Result<void>::ok();
+			}
+
+			out.reserve(out.size() + static_cast<std::size_t>(std::count(str.begin(), str.end(), delimiter)) + 1);
+
+			const char *cursor = str.data();
+			const char *end = cursor + str.size();
+			while (true) {
+				T value{};
+				auto [ptr, ec] = std::from_chars(cursor, end, value);
+				if (ec == std::errc::result_out_of_range) {
+					return Result<void>::err(Error(ErrorCode::InvalidFlagValue, "Number out of range in list"));
+				}
+				if (ec != std::errc() || (ptr != end && *ptr != delimiter)) {
+					return Result<void>::err(Error(ErrorCode::InvalidFlagValue, "Invalid number in list"));
+				}
+				out.push_back(value);
+
+				if (ptr == end) {
+					return Result<void>::ok();
+				}
+				cursor = ptr + 1;
+			}
+		}
+
+		/**
+		 * @brief Parse a duration such as "250ms", "1h30m" or "1.5s" into nanoseconds.
+		 *
+		 * Units: ns, us (or µs), ms, s, m (or min), h, d. A bare number is taken
+		 * in units of bare_unit_ns; 0 means a unit is required.
+		 */
+		[[nodiscard]] Result<std::chrono::nanoseconds> parse_duration(std::string_view str, std::int64_t bare_unit_ns);
+
+		/**
+		 * @brief Parse a byte size such as "4GiB", "512k" or "1.5MB".
+		 *
+		 * Binary units (KiB, MiB, ... and the single letters K, M, G, T, P, E)
+		 * are powers of 1024; SI units (kB/KB, MB, GB, ...) are powers of 1000.
+		 * Units are case-insensitive; B or no unit means bytes.
+		 */
+		[[nodiscard]] Result<std::uint64_t> parse_byte_size(std::string_view str);
+
+		/**
+		 * @brief A byte count in the largest binary unit that divides it exactly, e.g. {4, "GiB"}.
+		 */
+		[[nodiscard]] std::pair<std::uint64_t, std::string_view> byte_size_parts(std::uint64_t bytes) noexcept;
+
+		/**
+		 * @brief Render a byte count in the largest binary unit that divides it exactly.
+		 */
+		[[nodiscard]] std::string byte_size_to_string(std::uint64_t bytes);
+
+		template <typename Period>
+		[[nodiscard]] constexpr std::string_view duration_suffix() noexcept {
+			if constexpr (std::is_same_v<Period, std::nano>) {
+				return "ns";
+			} else if constexpr (std::is_same_v<Period, std::micro>) {
+				return "us";
+			} else if constexpr (std::is_same_v<Period, std::milli>) {
+				return "ms";
+			} else if constexpr (std::is_same_v<Period, std::ratio<1>>) {
+				return "s";
+			} else if constexpr (std::is_same_v<Period, std::ratio<60>>) {
+				return "m";
+			} else if constexpr (std::is_same_v<Period, std::ratio<3600>>) {
+				return "h";
+			} else if constexpr (std::is_same_v<Period, std::ratio<86400>>) {
+				return "d";
+			} else {
+				return "";
+			}
+		}
+	}// namespace detail
+
+	/**
+	 * @brief ValueConverter for integer types other than int (e.g. std::int64_t, std::uint64_t, std::size_t).
+	 *
+	 * Uses std::from_chars; unsigned types reject a leading '-'.
+	 */
+	template <detail::from_chars_integer T>
+	struct ValueConverter<T> {
+		static Result<T> from_string(std::string_view str) {
+			return detail::from_chars_value<T>(str, "Invalid integer format", "Integer out of range");
+		}
+
+		static std::string to_string(const T &value) {
+			return detail::to_chars_string(value);
+		}
+	};
+
+	/**
+	 * @brief ValueConverter for floating-point types other than double (e.g. float).
+	 */
+	template <detail::from_chars_float T>
+	struct ValueConverter<T> {
+		static Result<T> from_string(std::string_view str) {
+			return detail::from_chars_value<T>(str, "Invalid floating-point format", "Floating-point out of range");
+		}
+
+		static std::string to_string(const T &value) {
+			return detail::to_chars_string(value);
+		}
+	};
+
+	/**
+	 * @brief ValueConverter for std::chrono::duration (e.g. "250ms", "5m", "1h30m").
+	 *
+	 * See detail::parse_duration for the accepted units. A bare number is in
+	 * the duration's own unit, so `--timeout 30` on a std::chrono::seconds flag
+	 * means 30s. Resolution is one nanosecond; integer durations truncate.
+	 */
+	template <typename Rep, typename Period>
+	struct ValueConverter<std::chrono::duration<Rep, Period>> {
+		using Duration = std::chrono::duration<Rep, Period>;
+
+		static Result<Duration> from_string(std::string_view str) {
+			constexpr auto bare_unit = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<std::int64_t, Period>(1));
+
+			auto parsed = detail::parse_duration(str, bare_unit.count());
+			if (! parsed) {
+				return Result<Duration>::err(parsed.error());
+			}
+
+			if constexpr (std::is_integral_v<Rep>) {
+				using Wide = std::chrono::duration<long double, std::nano>;
+				const auto count = static_cast<long double>(parsed.value().count());
+				if (count > Wide(Duration::max()).count() || count < Wide(Duration::min()).count()) {
+					return Result<Duration>::err(Error(ErrorCode::InvalidFlagValue, "Duration out of range"));
+				}
+			}
+			return Result<Duration>::ok(std::chrono::duration_cast<Duration>(parsed.value()));
+		}
+
+		static std::string to_string(const Duration &value) {
+			std::string text = detail::to_chars_string(value.count());
+			text += detail::duration_suffix<Period>();
+			return text;
+		}
+	};
+
+	/**
+	 * @brief ValueConverter for enumerations: the underlying integer.
+	 *
+	 * Flags usually map names instead; see TypedFlag<T>::set_choices with
+	 * name/value pairs. A full specialization for a particular enum takes
+	 * precedence over this one.
+	 */
+	template <typename E>
+		requires std::is_enum_v<E>
+	struct ValueConverter<E> {
+		static Result<E> from_string(std::string_view str) {
+			auto parsed = detail::from_chars_value<std::underlying_type_t<E>>(str, "Invalid enumeration value", "Enumeration value out of range");
+			if (! parsed) {
+				return Result<E>::err(parsed.error());
+			}
+			return Result<E>::ok(static_cast<E>(parsed.value()));
+		}
+
+		static std::string to_string(const E &value) {
+			return detail::to_chars_string(static_cast<std::underlying_type_t<E>>(value));
+		}
+	};
+
+	/**
+	 * @brief A size in bytes, parsed from values like "4GiB" or "512k".
+	 *
+	 * Example:
+	 * @code
+	 * parser.add_flag<cli::ByteSize>("max-bytes", "Upper limit").set_default_value({64 << 20});
+	 * std::uint64_t limit = parser.get<cli::ByteSize>("max-bytes")->bytes;
+	 * @endcode
+	 */
+	struct ByteSize {
+		std::uint64_t bytes = 0;
+
+		friend constexpr auto operator<=>(const ByteSize &, const ByteSize &) = default;
+	};
+
+	/**
+	 * @brief ValueConverter for ByteSize; see detail::parse_byte_size for the accepted units.
+	 */
+	template <>
+	struct ValueConverter<ByteSize> {
+		static Result<ByteSize> from_string(std::string_view str) {
+			auto parsed = detail::parse_byte_size(str);
+			if (! parsed) {
+				return Result<ByteSize>::err(parsed.error());
+			}
+			return Result<ByteSize>::ok(ByteSize{parsed.value()});
+		}
+
+		static std::string to_string(const ByteSize &value) {
+			return detail::byte_size_to_string(value.bytes);
+		}
+	};
+
+	/**
+	 * @brief ValueConverter for a comma-separated list of numbers in one token, e.g. `--ids 1,2,3`.
+	 *
+	 * The whole list is parsed in a single pass straight into one vector
+	 * allocation. For a flag that may also be repeated, use
+	 * TypedFlag<T>::set_multi() on the element type instead.
+	 */
+	template <detail::list_number T>
+	struct ValueConverter<std::vector<T>> {
+		static Result<std::vector<T>> from_string(std::string_view str) {
+			std::vector<T> values;
+			auto parsed = detail::parse_number_list(str, ',', values);
+			if (! parsed) {
+				return Result<std::vector<T>>::err(parsed.error());
+			}
+			return Result<std::vector<T>>::ok(std::move(values));
+		}
+
+		static std::string to_string(const std::vector<T> &values) {
+			std::string text;
+			for (const T &value: values) {
+				if (! text.empty()) {
+					text += ',';
+				}
+				char buffer[64];
+				auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+				text.append(buffer, ptr);
+			}
+			return text;
+		}
+	};
+
 	/**
 	 * @brief Validator function signature.
 	 *
 	 * Return Result<void>::ok() for success, or Result<void>::err(Error(reason)).
 	 * You can use Error::validation_failed(name, reason) for convenience.
+	 *
+	 * Prefer the built-in validators in cppli_validators.hpp where they fit:
+	 * set_validator stores those without a std::function.
 	 */
 	template <typename T>
 	using Validator = std::function<Result<void>(const T &)>;
 
+	/**
+	 * @brief Where a flag's current value came from, in increasing precedence.
+	 *
+	 * A value from one source is never overwritten by a lower one, so the
+	 * command line beats the environment, which beats a config file, which
+	 * beats the default, whatever order they are applied in.
+	 */
+	enum class ValueSource : std::uint8_t {
+		Default,	///< set_default_value(), or no value
+		ConfigFile, ///< Parser::load_config
+		Environment,///< the variable named by TypedFlag::set_env
+		CommandLine,///< Parser::parse
+	};
+
+	namespace detail {
+
+#ifdef CPPLI_MINIMAL
+		/**
+		 * @brief Description or example text in a CPPLI_MINIMAL build: accepted and dropped.
+		 *
+		 * The constructor is inline and ignores its argument, so literals passed
+		 * as descriptions are not referenced and the linker drops them.
+		 */
+		struct HelpText {
+			constexpr HelpText() noexcept = default;
+
+			template <typename Text>
+				requires std::is_convertible_v<const Text &, std::string_view>
+			constexpr HelpText(const Text &) noexcept {
+			}
+
+			[[nodiscard]] constexpr bool empty() const noexcept {
+				return true;
+			}
+
+			operator const std::string &() const noexcept {
+				static const std::string none;
+				return none;
+			}
+		};
+#else
+		/**
+		 * @brief Description or example text, as stored for help output.
+		 */
+		using HelpText = std::string;
+#endif
+
+	}// namespace detail
+
 	/**
 	 * @brief Strongly-typed flag descriptor with validation and defaults.
 	 *
@@ -105,7 +484,7 @@ namespace cli {
 		 * @param long_name The long name (without dashes).
 		 * @param description Help text for this flag.
 		 */
-		TypedFlag(std::string long_name, std::string description) : long_name_(std::move(long_name)), description_(std::move(description)) {
+		TypedFlag(std::string long_name, detail::HelpText description) : long_name_(std::move(long_name)), description_(std::move(description)) {
 		}
 
 		/** @name Accessors */
@@ -123,7 +502,7 @@ namespace cli {
 			return required_;
 		}
 		[[nodiscard]] bool has_value() const noexcept {
-			return value_.has_value();
+			return multi_ ? ! values_.empty() || default_value_.has_value() : value_.has_value();
 		}
 		[[nodiscard]] const std::optional<T> &value() const noexcept {
 			return value_;
@@ -134,18 +513,90 @@ namespace cli {
 		[[nodiscard]] const std::vector<T> &choices() const noexcept {
 			return choices_;
 		}
+		[[nodiscard]] bool is_multi() const noexcept {
+			return multi_;
+		}
+		[[nodiscard]] char delimiter() const noexcept {
+			return delimiter_;
+		}
+		[[nodiscard]] const std::vector<T> &values() const noexcept {
+			return values_;
+		}
+		[[nodiscard]] const std::string &env_name() const noexcept {
+			return env_name_;
+		}
+		[[nodiscard]] ValueSource source() const noexcept {
+			return source_;
+		}
 		///@}
 
+		/**
+		 * @brief Every value given for a repeatable flag, or its default if none was given.
+		 */
+		[[nodiscard]] std::span<const T> all_values() const noexcept
+			requires(! std::is_same_v<T, bool>)
+		{
+			if (! values_.empty()) {
+				return values_;
+			}
+			if (default_value_.has_value()) {
+				return std::span<const T>(&*default_value_, 1);
+			}
+			return {};
+		}
+
 		/**
 		 * @brief Assign a short one-letter or compact alias (e.g. "v" for -v).
 		 * @param name Short alias without dash.
 		 * @return TypedFlag& for chaining.
 		 */
 		TypedFlag &set_short_name(std::string name) {
+			if (short_hook_.index != nullptr) {
+				short_hook_.index->rename(short_name_, name, short_hook_.flag_index);
+			}
 			short_name_ = std::move(name);
 			return *this;
 		}
 
+		/**
+		 * @brief Register this flag's short name with an owner's index (used by add_flag).
+		 * @param index Owner's short-name index; later set_short_name() calls update it.
+		 * @param flag_index Position of this flag in the owner's flag table.
+		 */
+		void attach_short_index(detail::ShortNameIndex &index, std::uint32_t flag_index) {
+			short_hook_.index = &index;
+			short_hook_.flag_index = flag_index;
+			index.add(short_name_, flag_index);
+		}
+
+		/**
+		 * @brief Keep an owner's required/has-value bits for this flag current (used by add_flag).
+		 * @param bits Owner's flag bits.
+		 * @param flag_index Position of this flag in the owner's flag table.
+		 */
+		void attach_presence(detail::PresenceBits &bits, std::uint32_t flag_index) {
+			bits.reserve_index(flag_index);
+			presence_.bits = &bits;
+			presence_.index = flag_index;
+			sync_presence();
+		}
+
+		/**
+		 * @brief Add what this flag holds, the object included, to stats.
+		 */
+		void add_memory(MemoryStats &stats) const noexcept {
+			stats.flags += sizeof(*this) + detail::heap_bytes(value_) + detail::heap_bytes(default_value_) + detail::heap_bytes(values_);
+			stats.strings += detail::heap_bytes(long_name_) + detail::heap_bytes(short_name_) + detail::heap_bytes(description_) + detail::heap_bytes(env_name_);
+			stats.choices += detail::heap_bytes(choices_) + choice_index_.heap_bytes();
+			if constexpr (std::is_enum_v<T>) {
+				stats.choices += named_choices_.heap_bytes();
+				for (const auto &entry: named_choices_) {
+					stats.choices += detail::heap_bytes(entry.key);
+				}
+			}
+			detail::count_function(stats, validator_);
+		}
+
 		/**
 		 * @brief Mark the flag as required or not.
 		 * @param req True (default true) to require the flag.
@@ -153,6 +604,8 @@ namespace cli {
 		 */
 		TypedFlag &set_required(bool req = true) {
 			required_ = req;
+			sync_presence();
+			touch_owner();
 			return *this;
 		}
 
@@ -164,6 +617,35 @@ namespace cli {
 		TypedFlag &set_default_value(T val) {
 			default_value_ = std::move(val);
 			value_ = default_value_;
+			sync_presence();
+			return *this;
+		}
+
+		/**
+		 * @brief Forget parsed values and restore the default, keeping allocated capacity.
+		 *
+		 * Repeated values are cleared without releasing the vector's storage, and a
+		 * default is copied into the existing value where T allows (e.g. std::string).
+		 */
+		void reset() {
+			values_.clear();
+			value_ = default_value_;
+			source_ = ValueSource::Default;
+			sync_presence();
+		}
+
+		/**
+		 * @brief Read the flag from an environment variable when it is not on the command line.
+		 *
+		 * The variable is read at the start of each parse() of the flag's command
+		 * and parsed like a command-line value; for a repeatable flag, its
+		 * delimiter splits the variable into several values.
+		 *
+		 * @param name Variable name, e.g. "APP_PORT"; empty to stop reading one.
+		 * @return TypedFlag& for chaining.
+		 */
+		TypedFlag &set_env(std::string name) {
+			env_name_ = std::move(name);
 			return *this;
 		}
 
@@ -174,6 +656,83 @@ namespace cli {
 		 */
 		TypedFlag &set_choices(std::vector<T> opts) {
 			choices_ = std::move(opts);
+			choice_index_.build(choices_);
+			return *this;
+		}
+
+		/**
+		 * @brief Accept only the given names and parse each straight to its enum value.
+		 *
+		 * The names are looked up in a hash table, so `get<Enum>()` returns the
+		 * mapped value with no string comparison after parsing. Any other token
+		 * fails validation. The mapped values also become choices().
+		 *
+		 * Example:
+		 * @code
+		 * enum class Level { Low, High };
+		 * parser.add_flag<Level>("level", "Level").set_choices<Level>({{"low", Level::Low}, {"high", Level::High}});
+		 * @endcode
+		 *
+		 * @param mapping Accepted names and the value each one stands for.
+		 * @return TypedFlag& for chaining.
+		 */
+		template <typename E = T>
+			requires(std::is_enum_v<E> && std::is_same_v<E, T>)
+		TypedFlag &set_choices(std::vector<std::pair<std::string, E>> mapping) {
+			named_choices_.clear();
+			choices_.clear();
+			named_choices_.reserve(mapping.size());
+			choices_.reserve(mapping.size());
+			for (auto &[name, value]: mapping) {
+				named_choices_.insert_or_assign(std::move(name), value);
+				choices_.push_back(value);
+			}
+			choice_index_.build(choices_);
+			return *this;
+		}
+
+		/**
+		 * @brief The name mapped to an enum value by set_choices, if any.
+		 */
+		[[nodiscard]] std::optional<std::string_view> choice_name(const T &value) const noexcept
+			requires std::is_enum_v<T>
+		{
+			for (const auto &[name, mapped]: named_choices_) {
+				if (mapped == value) {
+					return name;
+				}
+			}
+			return std::nullopt;
+		}
+
+		/**
+		 * @brief Make the flag repeatable: every occurrence appends instead of overwriting.
+		 *
+		 * With a delimiter set (',' by default), one token may also carry several
+		 * values, e.g. `--tag a,b --tag c`. Choices and the validator apply to
+		 * each value. The default, if any, is used only when the flag never
+		 * appears. Read the values with get_all<T>(). Not available for bool,
+		 * whose std::vector specialization cannot be viewed as a span.
+		 *
+		 * @param multi True (default true) to make the flag repeatable.
+		 * @return TypedFlag& for chaining.
+		 */
+		TypedFlag &set_multi(bool multi = true)
+			requires(! std::is_same_v<T, bool>)
+		{
+			multi_ = multi;
+			sync_presence();
+			touch_owner();
+			return *this;
+		}
+
+		/**
+		 * @brief Set the separator for several values in one token of a repeatable flag.
+		 * @param delimiter Separator character; '\0' disables splitting.
+		 * @return TypedFlag& for chaining.
+		 */
+		TypedFlag &set_delimiter(char delimiter) {
+			delimiter_ = delimiter;
 			return *this;
 		}
 
@@ -184,6 +743,22 @@ namespace cli {
 		 */
 		TypedFlag &set_validator(Validator<T> fn) {
 			validator_ = std::move(fn);
+			check_ = nullptr;
+			return *this;
+		}
+
+		/**
+		 * @brief Use a built-in validator, such as `cli::range<1, 65535> && cli::power_of_two`.
+		 *
+		 * Stores only a pointer to the validator's check, which is compiled for
+		 * this exact validator, instead of a std::function.
+		 *
+		 * @return TypedFlag& for chaining.
+		 */
+		template <detail::validator_for<T> V>
+		TypedFlag &set_validator(V) {
+			validator_ = nullptr;
+			check_ = &detail::static_check<V, T>;
 			return *this;
 		}
 
@@ -191,16 +766,114 @@ namespace cli {
 		 * @brief Parse and set the value from a string, then validate.
 		 *
 		 * @param str Raw string from the command line.
+		 * @param trace Observer to report Convert/Validate stages to, if any.
 		 * @return Result<void> ok() if parsed+validated, err(Error) otherwise.
 		 */
-		Result<void> set_value_from_string(std::string_view str) {
-			auto converted = ValueConverter<T>::from_string(str);
+		Result<void> set_value_from_string(std::string_view str, const detail::ParseTrace *trace = nullptr) {
+			return set_value_from(str, ValueSource::CommandLine, trace);
+		}
+
+		/**
+		 * @brief Parse, set and validate a value given by @p source.
+		 *
+		 * Ignored if the current value came from a source of higher precedence.
+		 * A repeatable flag appends to values from the same source and replaces
+		 * values from a lower one, so `--tag` on the command line replaces the
+		 * tags of a config file instead of adding to them.
+		 *
+		 * @param str Raw value text.
+		 * @param source Where the text came from.
+		 * @param trace Observer to report Convert/Validate stages to, if any.
+		 * @return Result<void> ok() if parsed+validated (or ignored), err(Error) otherwise.
+		 */
+		Result<void> set_value_from(std::string_view str, ValueSource source, const detail::ParseTrace *trace = nullptr) {
+			if (source < source_) {
+				return Result<void>::ok();
+			}
+
+			if (multi_) {
+				if (source != source_) {
+					values_.clear();
+					source_ = source;
+				}
+				auto parsed = parse_values(
+					str,
+					[this](T &&value) {
+						values_.push_back(std::move(value));
+					},
+					trace);
+				sync_presence();
+				return parsed;
+			}
+
+			auto converted = detail::traced(trace, ParseStage::Convert, long_name_, [&] {
+				return convert(str);
+			});
 			if (! converted) {
 				return Result<void>::err(converted.error());
 			}
 
 			value_ = std::move(converted.value());
-			return validate();
+			source_ = source;
+			sync_presence();
+			return detail::traced(trace, ParseStage::Validate, long_name_, [&] {
+				return validate();
+			});
+		}
+
+		/**
+		 * @brief Split a token on the delimiter and parse+validate each piece.
+		 *
+		 * Used for repeatable flags; pieces are handed to @p sink in order. Stops
+		 * at the first invalid piece.
+		 *
+		 * @param str Raw string from the command line.
+		 * @param sink Callable taking T&&.
+		 * @param trace Observer to report Convert/Validate stages to, if any.
+		 * @return Result<void> ok() if every piece was accepted, err(Error) otherwise.
+		 */
+		template <typename Sink>
+		Result<void> parse_values(std::string_view str, Sink &&sink, const detail::ParseTrace *trace = nullptr) const {
+			while (true) {
+				const std::size_t end = delimiter_ != '\0' ? str.find(delimiter_) : std::string_view::npos;
+				auto parsed = parse_value(str.substr(0, end), trace);
+				if (! parsed) {
+					return Result<void>::err(parsed.error());
+				}
+				sink(std::move(parsed.value()));
+
+				if (end == std::string_view::npos) {
+					return Result<void>::ok();
+				}
+				str.remove_prefix(end + 1);
+			}
+		}
+
+		/**
+		 * @brief Parse and validate a string without storing the result.
+		 *
+		 * Used by ParserSpec, which keeps values in a ParseResult instead of the
+		 * flag, so the flag itself is never modified.
+		 *
+		 * @param str Raw string from the command line.
+		 * @param trace Observer to report Convert/Validate stages to, if any.
+		 * @return Result<T> The converted value if parsed+validated, err(Error) otherwise.
+		 */
+		Result<T> parse_value(std::string_view str, const detail::ParseTrace *trace = nullptr) const {
+			auto converted = detail::traced(trace, ParseStage::Convert, long_name_, [&] {
+				return convert(str);
+			});
+			if (! converted) {
+				return converted;
+			}
+
+			auto valid = detail::traced(trace, ParseStage::Validate, long_name_, [&] {
+				return validate_value(converted.value());
+			});
+			if (! valid) {
+				return Result<T>::err(valid.error());
+			}
+			return converted;
 		}
 
 		/**
@@ -213,25 +886,39 @@ namespace cli {
 		 * @return Result<void> ok() if valid, err(Error) otherwise.
 		 */
 		Result<void> validate() const {
+			if (multi_) {
+				for (const auto &value: values_) {
+					auto valid = validate_value(value);
+					if (! valid) {
+						return valid;
+					}
+				}
+				return Result<void>::ok();
+			}
+
 			if (! value_.has_value()) {
 				return Result<void>::ok();
 			}
 
-			if (! choices_.empty()) {
-				bool found = false;
-				for (const auto &choice: choices_) {
-					if (*value_ == choice) {
-						found = true;
-						break;
-					}
-				}
-				if (! found) {
-					return Result<void>::err(Error::validation_failed(long_name_, "value not in allowed choices"));
-				}
+			return validate_value(*value_);
+		}
+
+		/**
+		 * @brief Run all configured validations against a given value.
+		 * @param value Candidate value.
+		 * @return Result<void> ok() if valid, err(Error) otherwise.
+		 */
+		Result<void> validate_value(const T &value) const {
+			if (! choices_.empty() && ! choice_index_.contains(choices_, value)) {
+				return Result<void>::err(Error::validation_failed(long_name_, "value not in allowed choices"));
 			}
 
-			if (validator_) {
-				return validator_(*value_);
+			if (check_ != nullptr) {
+				if (const char *rejected = check_(value); rejected != nullptr) {
+					return Result<void>::err(Error::validation_rejected(long_name_, rejected));
+				}
+			} else if (validator_) {
+				return validator_(value);
 			}
 
 			return Result<void>::ok();
@@ -240,12 +927,53 @@ namespace cli {
 	  private:
 		std::string long_name_;
 		std::string short_name_;
-		std::string description_;
+		detail::HelpText description_;
 		bool required_ = false;
+		bool multi_ = false;
+		char delimiter_ = ',';
 		std::optional<T> value_;
 		std::optional<T> default_value_;
+		std::vector<T> values_;///< occurrences of a repeatable flag
 		std::vector<T> choices_;
+		detail::ChoiceIndex<T> choice_index_;///< hashed lookup into choices_ for large sets
+		[[no_unique_address]] std::conditional_t<std::is_enum_v<T>, detail::NameTable<T>, std::monostate> named_choices_;
 		Validator<T> validator_;
+		detail::StaticCheck<T> check_ = nullptr;///< built-in validator, used instead of validator_
+		std::string env_name_;
+		ValueSource source_ = ValueSource::Default;///< origin of value_ / values_
+		detail::ShortNameHook short_hook_;
+		detail::PresenceHook presence_;
+
+		/**
+		 * @brief Convert a token with the name mapping, if set, or ValueConverter<T>.
+		 */
+		Result<T> convert(std::string_view str) const {
+			if constexpr (std::is_enum_v<T>) {
+				if (! named_choices_.empty()) {
+					if (const T *value = named_choices_.find(str); value != nullptr) {
+						return Result<T>::ok(*value);
+					}
+					return Result<T>::err(Error::validation_failed(long_name_, "value not in allowed choices"));
+				}
+			}
+			return ValueConverter<T>::from_string(str);
+		}
+
+		/**
+		 * @brief Mirror required/has-value into the owner's presence bits.
+		 */
+		void sync_presence() noexcept {
+			presence_.update(required_, has_value());
+		}
+
+		/**
+		 * @brief Tell the owner that something shown in its help changed.
+		 */
+		void touch_owner() noexcept {
+			if (short_hook_.index != nullptr) {
+				short_hook_.index->touch();
+			}
+		}
 	};
 
 	/**
@@ -270,7 +998,7 @@ namespace cli {
 		 * @param description Explanation shown in help text.
 		 * @param required Whether the positional is mandatory (default true).
 		 */
-		TypedPositional(std::string name, std::string description, bool required = true) : name_(std::move(name)), description_(std::move(description)), required_(required) {
+		TypedPositional(std::string name, detail::HelpText description, bool required = true) : name_(std::move(name)), description_(std::move(description)), required_(required) {
 		}
 
 		/** @name Accessors */
@@ -292,40 +1020,119 @@ namespace cli {
 		}
 		///@}
 
+		/**
+		 * @brief Forget the parsed value.
+		 */
+		void reset() noexcept {
+			value_.reset();
+			presence_.update(required_, false);
+		}
+
+		/**
+		 * @brief Keep an owner's required/has-value bits for this positional current (used by add_positional).
+		 * @param bits Owner's positional bits.
+		 * @param index Position of this positional in the owner's list.
+		 */
+		void attach_presence(detail::PresenceBits &bits, std::uint32_t index) {
+			bits.reserve_index(index);
+			presence_.bits = &bits;
+			presence_.index = index;
+			presence_.update(required_, has_value());
+		}
+
+		/**
+		 * @brief Add what this positional holds, the object included, to stats.
+		 */
+		void add_memory(MemoryStats &stats) const noexcept {
+			stats.flags += sizeof(*this) + detail::heap_bytes(value_);
+			stats.strings += detail::heap_bytes(name_) + detail::heap_bytes(description_);
+			detail::count_function(stats, validator_);
+		}
+
 		/**
 		 * @brief Parse and set the value from a string, then validate if set.
 		 * @param str Raw token from the command line.
+		 * @param trace Observer to report Convert/Validate stages to, if any.
 		 * @return Result<void> ok() if parsed (+validated), err(Error) otherwise.
 		 */
-		Result<void> set_value_from_string(std::string_view str) {
-			auto converted = ValueConverter<T>::from_string(str);
+		Result<void> set_value_from_string(std::string_view str, const detail::ParseTrace *trace = nullptr) {
+			auto converted = detail::traced(trace, ParseStage::Convert, name_, [&] {
+				return ValueConverter<T>::from_string(str);
+			});
 			if (! converted) {
 				return Result<void>::err(converted.error());
 			}
 
 			value_ = std::move(converted.value());
+			presence_.update(required_, true);
 
-			if (validator_) {
-				return validator_(*value_);
+			if (has_validator()) {
+				return detail::traced(trace, ParseStage::Validate, name_, [&] {
+					return validate_value(*value_);
+				});
 			}
 
 			return Result<void>::ok();
 		}
 
+		/**
+		 * @brief Parse and validate a token without storing the result.
+		 * @param str Raw token from the command line.
+		 * @return Result<T> The converted value if parsed (+validated), err(Error) otherwise.
+		 */
+		Result<T> parse_value(std::string_view str) const {
+			auto converted = ValueConverter<T>::from_string(str);
+			if (! converted || ! has_validator()) {
+				return converted;
+			}
+
+			auto valid = validate_value(converted.value());
+			if (! valid) {
+				return Result<T>::err(valid.error());
+			}
+			return converted;
+		}
+
 		/**
 		 * @brief Provide a custom validator function.
 		 * @param fn Validator invoked after parsing.
 		 */
 		void set_validator(Validator<T> fn) {
 			validator_ = std::move(fn);
+			check_ = nullptr;
+		}
+
+		/**
+		 * @brief Use a built-in validator, such as `cli::non_empty`.
+		 */
+		template <detail::validator_for<T> V>
+		void set_validator(V) {
+			validator_ = nullptr;
+			check_ = &detail::static_check<V, T>;
 		}
 
 	  private:
 		std::string name_;
-		std::string description_;
+		detail::HelpText description_;
 		bool required_;
 		std::optional<T> value_;
 		Validator<T> validator_;
+		detail::StaticCheck<T> check_ = nullptr;///< built-in validator, used instead of validator_
+		detail::PresenceHook presence_;
+
+		[[nodiscard]] bool has_validator() const noexcept {
+			return check_ != nullptr || static_cast<bool>(validator_);
+		}
+
+		Result<void> validate_value(const T &value) const {
+			if (check_ != nullptr) {
+				if (const char *rejected = check_(value); rejected != nullptr) {
+					return Result<void>::err(Error::validation_rejected(name_, rejected));
+				}
+				return Result<void>::ok();
+			}
+			return validator_(value);
+		}
 	};
 
 }// namespace cli
@@ -0,0 +1,238 @@
+#ifndef CPPLI_VALIDATORS_HPP
+#define CPPLI_VALIDATORS_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace cli {
+
+	/**
+	 * @brief String literal usable as a template argument (e.g. Flag<"port", int>).
+	 *
+	 * N counts the terminating NUL.
+	 */
+	template <std::size_t N>
+	struct FixedString {
+		char value[N]{};
+
+		constexpr FixedString() = default;
+
+		constexpr FixedString(const char (&str)[N]) {
+			std::copy_n(str, N, value);
+		}
+
+		[[nodiscard]] constexpr std::string_view view() const noexcept {
+			return {value, N - 1};
+		}
+	};
+
+	namespace detail {
+
+		template <std::size_t... N>
+		[[nodiscard]] constexpr FixedString<(N + ...) - sizeof...(N) + 1> concat(const FixedString<N> &...parts) {
+			FixedString<(N + ...) - sizeof...(N) + 1> out;
+			std::size_t at = 0;
+			((std::copy_n(parts.value, N - 1, out.value + at), at += N - 1), ...);
+			return out;
+		}
+
+		/**
+		 * @brief Decimal text of an integral template argument.
+		 */
+		template <auto Value>
+			requires(std::integral<decltype(Value)> && ! std::is_same_v<decltype(Value), bool>)
+		[[nodiscard]] constexpr auto decimal() {
+			using Unsigned = std::make_unsigned_t<decltype(Value)>;
+			constexpr Unsigned magnitude = Value < 0 ? Unsigned(0) - Unsigned(Value) : Unsigned(Value);
+			constexpr std::size_t size = [] {
+				std::size_t digits = Value < 0 ? 2 : 1;
+				for (Unsigned rest = magnitude; rest >= 10; rest /= 10) {
+					++digits;
+				}
+				return digits;
+			}();
+
+			FixedString<size + 1> text;
+			Unsigned rest = magnitude;
+			for (std::size_t i = size; i-- > (Value < 0 ? 1 : 0);) {
+				text.value[i] = static_cast<char>('0' + rest % 10);
+				rest /= 10;
+			}
+			if (Value < 0) {
+				text.value[0] = '-';
+			}
+			return text;
+		}
+
+		/**
+		 * @brief Error::validation_rejected pattern for a built-in validator's reason.
+		 */
+		template <FixedString Reason>
+		inline constexpr auto rejection = concat(FixedString("Validation failed for {}: "), Reason);
+
+		/**
+		 * @brief A one_of choice: an integral or enum value, or a string literal.
+		 */
+		template <typename V>
+		struct Literal {
+			V value;
+
+			constexpr Literal(V v) : value(v) {
+			}
+
+			template <std::size_t N>
+			constexpr Literal(const char (&text)[N]) : value(text) {
+			}
+
+			template <typename T>
+			[[nodiscard]] constexpr bool matches(const T &candidate) const noexcept {
+				if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+					return std::string_view(candidate) == value.view();
+				} else {
+					return candidate == value;
+				}
+			}
+		};
+
+		template <std::size_t N>
+		Literal(const char (&)[N]) -> Literal<FixedString<N>>;
+
+		/**
+		 * @brief Base of the built-in validators; marks a type for set_validator's inline path.
+		 */
+		struct ValidatorTag {};
+
+		/**
+		 * @brief Stateless validator type: everything it checks is in its template arguments.
+		 */
+		template <typename V>
+		concept validator_object = std::derived_from<V, ValidatorTag> && std::is_empty_v<V> && std::default_initializable<V>;
+
+		/**
+		 * @brief A validator object that can check values of type T.
+		 *
+		 * `reject(value)` returns nullptr to accept, or an Error::validation_rejected pattern.
+		 */
+		template <typename V, typename T>
+		concept validator_for = validator_object<V> && requires(const V validator, const T &value) {
+			{ validator.reject(value) } -> std::same_as<const char *>;
+		};
+
+		/**
+		 * @brief A validator object's check, instantiated per validator so it inlines into one function.
+		 */
+		template <typename T>
+		using StaticCheck = const char *(*) (const T &) noexcept;
+
+		template <typename V, typename T>
+		const char *static_check(const T &value) noexcept {
+			return V{}.reject(value);
+		}
+
+	}// namespace detail
+
+	/**
+	 * @brief Accepts integers in [Lo, Hi].
+	 */
+	template <auto Lo, auto Hi>
+		requires(Lo <= Hi)
+	struct range_t : detail::ValidatorTag {
+		template <typename T>
+			requires std::integral<T>
+		[[nodiscard]] constexpr const char *reject(const T &value) const noexcept {
+			return std::cmp_less(value, Lo) || std::cmp_greater(value, Hi) ? message.value : nullptr;
+		}
+
+	  private:
+		static constexpr auto message = detail::rejection<detail::concat(FixedString("must be in ["), detail::decimal<Lo>(), FixedString(", "), detail::decimal<Hi>(), FixedString("]"))>;
+	};
+
+	/**
+	 * @brief Accepts strings and containers that have at least one element.
+	 */
+	struct non_empty_t : detail::ValidatorTag {
+		template <typename T>
+			requires requires(const T &value) {
+				{ value.empty() } -> std::convertible_to<bool>;
+			}
+		[[nodiscard]] constexpr const char *reject(const T &value) const noexcept {
+			return value.empty() ? detail::rejection<"must not be empty">.value : nullptr;
+		}
+	};
+
+	/**
+	 * @brief Accepts positive integers that are a power of two.
+	 */
+	struct power_of_two_t : detail::ValidatorTag {
+		template <typename T>
+			requires std::integral<T>
+		[[nodiscard]] constexpr const char *reject(const T &value) const noexcept {
+			return value > 0 && (value & (value - 1)) == 0 ? nullptr : detail::rejection<"must be a power of two">.value;
+		}
+	};
+
+	/**
+	 * @brief Accepts exactly the listed values: integers, enumerators or string literals.
+	 */
+	template <detail::Literal... Values>
+	struct one_of_t : detail::ValidatorTag {
+		template <typename T>
+			requires(requires(const T &value) { (Values.matches(value), ...); })
+		[[nodiscard]] constexpr const char *reject(const T &value) const noexcept {
+			return (Values.matches(value) || ...) ? nullptr : detail::rejection<"value not in allowed choices">.value;
+		}
+	};
+
+	/**
+	 * @brief Accepts values that both A and B accept; reports the first rejection.
+	 */
+	template <detail::validator_object A, detail::validator_object B>
+	struct all_of_t : detail::ValidatorTag {
+		template <typename T>
+			requires(detail::validator_for<A, T> && detail::validator_for<B, T>)
+		[[nodiscard]] constexpr const char *reject(const T &value) const noexcept {
+			const char *rejected = A{}.reject(value);
+			return rejected != nullptr ? rejected : B{}.reject(value);
+		}
+	};
+
+	/**
+	 * @brief Built-in validators, for TypedFlag::set_validator and TypedPositional::set_validator.
+	 *
+	 * Each is an empty constexpr object, so set_validator keeps only a pointer
+	 * to a check compiled for that exact validator; combine them with `&&`.
+	 * A rejection reports ErrorCode::ValidationFailed with a message fixed at
+	 * compile time and the flag name, without allocating.
+	 *
+	 * Example:
+	 * @code
+	 * parser.add_flag<int>("port", "Listen port").set_validator(cli::range<1, 65535>);
+	 * parser.add_flag<std::size_t>("block", "Block size").set_validator(cli::range<512, 65536> && cli::power_of_two);
+	 * parser.add_flag<std::string>("mode", "Mode").set_validator(cli::one_of<"fast", "safe">);
+	 * static_assert(cli::range<1, 10>.reject(5) == nullptr);
+	 * @endcode
+	 */
+	///@{
+	template <auto Lo, auto Hi>
+	inline constexpr range_t<Lo, Hi> range{};
+
+	inline constexpr non_empty_t non_empty{};
+
+	inline constexpr power_of_two_t power_of_two{};
+
+	template <detail::Literal... Values>
+	inline constexpr one_of_t<Values...> one_of{};
+	///@}
+
+	template <detail::validator_object A, detail::validator_object B>
+	[[nodiscard]] constexpr all_of_t<A, B> operator&&(A, B) noexcept {
+		return {};
+	}
+
+}// namespace cli
+
+#endif// CPPLI_VALIDATORS_HPP
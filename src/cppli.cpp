@@ -1,60 +1,18 @@
+#include <algorithm>
 #include <cppli.hpp>
+#include <cppli_config.hpp>
 #include <cppli_error.hpp>
+#include <cppli_help.hpp>
+#include <cppli_response_file.hpp>
+#include <cppli_tokenizer.hpp>
 #include <iostream>
-#include <sstream>
-
-#ifdef _WIN32
-#include <io.h>
-#include <stdio.h>
-#else
-#include <unistd.h>
-#endif
 
 namespace cli {
 
-	namespace {
-		/**
-		 * @brief RAII helper class for ANSI color codes
-		 */
-		class ColorGuard {
-		  public:
-			ColorGuard(std::ostream &os, const char *color) : os_(os) {
-				if (is_tty())
-					os_ << color;
-			}
-
-			~ColorGuard() {
-				if (is_tty())
-					os_ << "\033[0m";
-			}
-
-		  private:
-			std::ostream &os_;
-
-			static bool is_tty() {
-				static bool checked = false;
-				static bool is_terminal = false;
-				if (! checked) {
-#ifdef _WIN32
-					is_terminal = _isatty(_fileno(stdout)) != 0;
-#else
-					is_terminal = isatty(fileno(stdout)) == 1;
-#endif
-					checked = true;
-				}
-				return is_terminal;
-			}
-		};
-
-		constexpr const char *RESET = "\033[0m";
-		constexpr const char *BOLD = "\033[1m";
-		constexpr const char *GREEN = "\033[32m";
-		constexpr const char *YELLOW = "\033[33m";
-		constexpr const char *RED = "\033[31m";
-	}// namespace
-
-	Parser::Parser(std::string app_name, std::string description, std::string version)
-		: app_name_(std::move(app_name)), description_(std::move(description)), version_(std::move(version)) {
+	Parser::Parser(std::string app_name, detail::HelpText description, std::string version)
+		: app_name_(std::move(app_name)), description_(std::move(description)), version_(std::move(version)),
+		  short_index_(std::make_unique<detail::ShortNameIndex>()),
+		  presence_(std::make_unique<detail::CommandPresence>()) {
 	}
 
 	Parser &Parser::add_help_flag() {
@@ -67,174 +25,266 @@ namespace cli {
 		return *this;
 	}
 
-	Parser &Parser::add_example(std::string description, std::string command) {
+	Parser &Parser::add_example([[maybe_unused]] detail::HelpText description, [[maybe_unused]] detail::HelpText command) {
+#ifndef CPPLI_MINIMAL
 		examples_.push_back({std::move(description), std::move(command)});
+		++revision_;
+#endif
+		return *this;
+	}
+
+	Parser &Parser::add_rest_positional(std::string name) {
+		rest_name_ = std::move(name);
+		++revision_;
 		return *this;
 	}
 
-	Subcommand &Parser::add_subcommand(std::string name, std::string description) {
+	Subcommand &Parser::add_subcommand(std::string name, detail::HelpText description) {
 		auto subcommand = std::make_unique<Subcommand>(name, std::move(description), this);
 		auto *ptr = subcommand.get();
-		subcommands_[name] = std::move(subcommand);
+		subcommands_.insert_or_assign(std::move(name), std::move(subcommand));
+		++revision_;
 		return *ptr;
 	}
 
+	Parser &Parser::add_lazy_subcommand(std::string name, detail::HelpText description, SubcommandFactory factory) {
+		auto subcommand = std::make_unique<Subcommand>(name, std::move(description), this);
+		subcommand->factory_ = std::move(factory);
+		subcommands_.insert_or_assign(std::move(name), std::move(subcommand));
+		++revision_;
+		return *this;
+	}
+
 	std::optional<std::string> Parser::get_selected_subcommand() const {
 		return selected_subcommand_;
 	}
 
+	std::vector<std::string_view> Parser::get_selected_subcommands() const {
+		std::vector<std::string_view> names;
+		names.reserve(chain_.size());
+		for (const Subcommand *sub: chain_) {
+			names.push_back(sub->name_);
+		}
+		return names;
+	}
+
 	Subcommand *Parser::get_subcommand(std::string_view name) {
-		auto it = subcommands_.find(std::string(name));
-		return it != subcommands_.end() ? it->second.get() : nullptr;
+		auto *sub = subcommands_.find(name);
+		if (sub == nullptr) {
+			return nullptr;
+		}
+		(*sub)->materialize();
+		return sub->get();
 	}
 
 	Parser &Parser::require_subcommand(int count) {
 		required_subcommand_count_ = count;
+		++revision_;
 		return *this;
 	}
 
 	Result<void> Parser::parse(int argc, char **argv) {
-		std::vector<std::string> args;
-		args.reserve(static_cast<size_t>(argc) - 1);
-		for (int i = 1; i < argc; ++i) {
-			args.emplace_back(argv[i]);
+		if (argc <= 1) {
+			return parse(std::span<const std::string_view>{});
 		}
-		return parse(args);
+		return parse(std::span<const char *const>(argv + 1, static_cast<size_t>(argc) - 1));
 	}
 
 	Result<void> Parser::parse(const std::vector<std::string> &args) {
-		short_to_long_.clear();
-		for (const auto &[name, storage]: flags_) {
-			const auto s_name = storage.get_short_name();
+		// Kept in the parser so get_rest() can point into it after parse() returns.
+		arg_views_.assign(args.begin(), args.end());
+		return parse(std::span<const std::string_view>(arg_views_));
+	}
 
-			if (! s_name.empty()) {
-				short_to_long_[s_name] = name;
-			}
-		}
+	Result<void> Parser::parse(std::span<const char *const> args) {
+		arg_views_.assign(args.begin(), args.end());
+		return parse(std::span<const std::string_view>(arg_views_));
+	}
 
-		size_t pos_index = 0;
-		bool after_double_dash = false;
+	Result<void> Parser::parse(std::span<const std::string_view> args) {
+		completion_requested_ = false;
+		if (completion_enabled_ && ! args.empty() && args.front() == completion_command) {
+			write_completions(args.subspan(1));
+			completion_requested_ = true;
+			return Result<void>::ok();
+		}
 
-		for (size_t i = 0; i < args.size(); ++i) {
-			const auto &arg = args[i];
+		const auto trace = detail::make_trace(observer_, nullptr, app_name_);
+		const detail::ParseTrace *trace_ptr = trace ? &*trace : nullptr;
+		return detail::traced(trace_ptr, ParseStage::Parse, {}, [&] {
+			return parse_tokens(args, trace_ptr);
+		});
+	}
 
-			if (arg == "--") {
-				after_double_dash = true;
-				continue;
+	Result<void> Parser::parse_tokens(std::span<const std::string_view> args, const detail::ParseTrace *trace) {
+		// Owns any mapped @file contents that args points into after expansion.
+		// Kept until the next parse() or reset(), since get_rest() may view it.
+		auto &response_files = response_files_.emplace();
+		rest_ = {};
+		chain_.clear();
+		callbacks_ = {};
+
+		auto expanded = detail::traced(trace, ParseStage::ResponseFiles, {}, [&] {
+			return response_files.expand(args);
+		});
+		if (! expanded) {
+			return Result<void>::err(expanded.error());
+		}
+		args = expanded.value();
+
+		// Root level of the shared tokenizer; a selected subcommand finishes the whole parse.
+		struct Handler {
+			Parser &parser;
+			std::span<const std::string_view> args;
+			const detail::ParseTrace *trace;
+			size_t pos_index = 0;
+			bool finished = false;
+
+			detail::FlagMatch<FlagStorage> find_long(std::string_view name) const {
+				const auto *abbreviations = parser.abbreviations_ ? &parser.flag_names_.get(parser.flags_) : nullptr;
+				const auto found = detail::lookup_name(parser.flags_, abbreviations, name);
+				if (found.index == detail::NameTable<FlagStorage>::npos) {
+					return {{}, nullptr, found.ambiguous};
+				}
+				const auto &entry = parser.flags_.at(found.index);
+				return {entry.key, &entry.value};
 			}
 
-			if (! after_double_dash && ! arg.empty() && arg[0] != '-') {
-				auto sub_it = subcommands_.find(arg);
-				if (sub_it != subcommands_.end()) {
-					selected_subcommand_ = arg;
-					auto &subcommand = *sub_it->second;
-
-					auto result = subcommand.parse_args(args, i + 1);
-					if (! result) {
-						return Result<void>::err(result.error());
-					}
-
-					subcommand.parsed_ = true;
+			detail::FlagMatch<FlagStorage> find_short(std::string_view name) const {
+				const auto index = parser.short_index_->find(name);
+				if (index == detail::ShortNameIndex::npos) {
+					return {};
+				}
+				const auto &entry = parser.flags_.at(index);
+				return {entry.key, &entry.value};
+			}
 
-					if (subcommand.help_requested_) {
-						help_requested_ = true;
-						parsed_ = true;
-						return Result<void>::ok();
-					}
+			static bool is_boolean(const FlagStorage &flag) noexcept {
+				return flag.is_boolean();
+			}
 
-					auto validation = subcommand.validate_requirements();
-					if (! validation) {
-						return validation;
-					}
+			static bool fallthrough() noexcept {
+				return false;
+			}
 
-					parsed_ = true;
+			std::string_view suggest_long(std::string_view name) const {
+				return detail::closest_name(parser.flags_, parser.flag_names_.get(parser.flags_), name);
+			}
 
-					subcommand.invoke_callback();
+			auto *find_subcommand(std::string_view name) const {
+				const auto *abbreviations = parser.abbreviations_ ? &parser.subcommand_names_.get(parser.subcommands_) : nullptr;
+				const auto found = detail::lookup_name(parser.subcommands_, abbreviations, name);
+				return found.index == detail::NameTable<std::unique_ptr<Subcommand>>::npos ? nullptr : &parser.subcommands_.at(found.index);
+			}
 
-					return Result<void>::ok();
+			Result<void> set_flag(std::string_view name, const FlagStorage &flag, std::string_view value) const {
+				if (name == "help") {
+					parser.help_requested_ = true;
 				}
+				if (name == "version") {
+					parser.version_requested_ = true;
+				}
+				return flag.set_value(value, trace);
 			}
 
-			if (after_double_dash || (arg.empty() || arg[0] != '-')) {
-				if (pos_index >= positionals_.size()) {
-					return Result<void>::err(Error::too_many_positionals());
+			Result<bool> positional(std::string_view arg) {
+				if (pos_index >= parser.positionals_.size()) {
+					if (parser.rest_name_.has_value()) {
+						return Result<bool>::ok(false);// the rest starts here
+					}
+					if (const auto near = detail::closest_name(parser.subcommands_, parser.subcommand_names_.get(parser.subcommands_), arg); ! near.empty()) {
+						return Result<bool>::err(Error::unknown_subcommand(arg, near));
+					}
+					return Result<bool>::err(Error::too_many_positionals());
 				}
-
-				auto result = positionals_[pos_index].set_value(arg);
+				auto result = parser.positionals_[pos_index].set_value(arg, trace);
 				if (! result) {
-					return result;
+					return Result<bool>::err(result.error());
 				}
 				++pos_index;
-				continue;
+				return Result<bool>::ok(true);
 			}
 
-			std::string flag_name;
-			std::string flag_value;
-			bool has_value = false;
-
-			if (arg.starts_with("--")) {
-				size_t eq_pos = arg.find('=');
-				if (eq_pos != std::string::npos) {
-					flag_name = arg.substr(2, eq_pos - 2);
-					flag_value = arg.substr(eq_pos + 1);
-					has_value = true;
-				} else {
-					flag_name = arg.substr(2);
-				}
-			} else if (arg.starts_with("-")) {
-				std::string short_name = arg.substr(1);
-				auto it = short_to_long_.find(short_name);
-				if (it != short_to_long_.end()) {
-					flag_name = it->second;
-				} else {
-					return Result<void>::err(Error::unknown_flag(arg));
+			Result<std::optional<size_t>> subcommand(std::string_view arg, size_t next_index) {
+				using Outcome = Result<std::optional<size_t>>;
+
+				const auto *entry = find_subcommand(arg);
+				if (entry == nullptr) {
+					return Outcome::ok(std::nullopt);
 				}
-			}
 
-			if (flag_name == "help") {
-				help_requested_ = true;
-			}
+				arg = entry->key;
+				parser.selected_subcommand_ = std::string(arg);
+				finished = true;
 
-			if (flag_name == "version") {
-				version_requested_ = true;
-			}
+				// With chaining, a token that ends one subcommand's arguments may start the next.
+				while (true) {
+					auto &subcommand = *entry->value;
+					if (std::ranges::find(parser.chain_, &subcommand) != parser.chain_.end()) {
+						return Outcome::err(Error::repeated_subcommand(arg));
+					}
+					parser.chain_.push_back(&subcommand);
 
-			auto flag_it = flags_.find(flag_name);
-			if (flag_it == flags_.end()) {
-				return Result<void>::err(Error::unknown_flag(arg));
-			}
+					auto result = subcommand.parse_args(args, next_index, trace);
+					if (! result) {
+						return Outcome::err(result.error());
+					}
+
+					subcommand.parsed_ = true;
 
-			bool is_boolean_flag = flag_it->second.is_boolean();
+					if (subcommand.help_requested_) {
+						parser.help_requested_ = true;
+						parser.parsed_ = true;
+						return Outcome::ok(args.size());
+					}
 
-			if (! has_value && i + 1 < args.size() && ! args[i + 1].starts_with("-")) {
-				std::string_view next_arg = args[i + 1];
+					const auto sub_trace = detail::make_trace(subcommand.observer_, trace, subcommand.name_);
+					const detail::ParseTrace *sub_trace_ptr = sub_trace ? &*sub_trace : nullptr;
+
+					auto validation = detail::traced(sub_trace_ptr, ParseStage::Requirements, {}, [&] {
+						return subcommand.validate_requirements();
+					});
+					if (! validation) {
+						return Outcome::err(validation.error());
+					}
 
-				if (! is_boolean_flag) {
-					flag_value = args[++i];
-					has_value = true;
-				} else {
-					if (next_arg == "true" || next_arg == "false" || next_arg == "1" || next_arg == "0" ||
-						next_arg == "yes" || next_arg == "no" || next_arg == "on" || next_arg == "off") {
-						flag_value = args[++i];
-						has_value = true;
+					const size_t end = result.value();
+					if (! parser.chain_subcommands_ || end >= args.size()) {
+						break;
+					}
+					entry = find_subcommand(args[end]);
+					if (entry == nullptr) {
+						break;
 					}
+					arg = entry->key;
+					next_index = end + 1;
 				}
-			}
 
-			if (! has_value && is_boolean_flag) {
-				flag_value = "true";
-				has_value = true;
+				parser.parsed_ = true;
+				return Outcome::ok(args.size());
 			}
+		};
 
-			if (! has_value) {
-				return Result<void>::err(Error::missing_flag_value(flag_name));
-			}
+		if (auto env = detail::apply_environment(flags_, trace); ! env) {
+			return env;
+		}
 
-			auto result = flag_it->second.set_value(flag_value);
-			if (! result) {
-				return result;
+		Handler handler{*this, args, trace};
+		auto consumed = detail::run_tokenizer(args, 0, handler);
+		if (! consumed) {
+			return Result<void>::err(consumed.error());
+		}
+		if (handler.finished) {
+			if (help_requested_) {
+				return Result<void>::ok();
+			}
+			if (auto counted = validate_subcommand_count(); ! counted) {
+				return counted;
 			}
+			run_callbacks(trace);
+			return Result<void>::ok();
 		}
+		rest_ = args.subspan(consumed.value());
 
 		parsed_ = true;
 
@@ -242,17 +292,62 @@ namespace cli {
 			return Result<void>::ok();
 		}
 
-		if (required_subcommand_count_ != 0) {
-			if (required_subcommand_count_ == -1 && ! selected_subcommand_.has_value()) {
-				return Result<void>::err(Error(ErrorCode::MissingRequiredFlag, "A subcommand is required"));
+		if (auto counted = validate_subcommand_count(); ! counted) {
+			return counted;
+		}
+
+		return detail::traced(trace, ParseStage::Requirements, {}, [&] {
+			return validate_requirements();
+		});
+	}
+
+	Result<void> Parser::validate_subcommand_count() const {
+		if (required_subcommand_count_ == 0) {
+			return Result<void>::ok();
+		}
+		if (chain_.empty()) {
+			return Result<void>::err(Error(ErrorCode::MissingRequiredFlag, "A subcommand is required"));
+		}
+		if (required_subcommand_count_ > 0 && chain_.size() != static_cast<size_t>(required_subcommand_count_)) {
+			return Result<void>::err(Error::subcommand_count(static_cast<size_t>(required_subcommand_count_), chain_.size()));
+		}
+		return Result<void>::ok();
+	}
+
+	void Parser::run_callbacks(const detail::ParseTrace *trace) {
+		if (executor_ == nullptr) {
+			for (const Subcommand *sub: chain_) {
+				const auto sub_trace = detail::make_trace(sub->observer_, trace, sub->name_);
+				(void) detail::traced(sub_trace ? &*sub_trace : nullptr, ParseStage::Callback, {}, [&] {
+					sub->invoke_callback();
+					return Result<void>::ok();
+				});
 			}
+			return;
 		}
 
-		return validate_requirements();
+		std::vector<std::vector<std::function<void()>>> stages;
+		bool shared = false;///< the last stage is a group of concurrent subcommands
+		for (const Subcommand *sub: chain_) {
+			if (! sub->callback_) {
+				continue;
+			}
+			if (! (shared && sub->concurrent_)) {
+				stages.emplace_back();
+			}
+			stages.back().push_back(sub->callback_);
+			shared = sub->concurrent_;
+		}
+		callbacks_ = CallbackHandle::start(*executor_, std::move(stages));
 	}
 
 	Result<void> Parser::validate_requirements() const {
-		for (const auto &[name, flag]: flags_) {
+		if (presence_->satisfied()) {
+			return Result<void>::ok();
+		}
+
+		// Something is missing: find it the way users see it, flags in name order first.
+		for (const auto &[name, flag]: flags_.sorted()) {
 			if (flag.is_required() && ! flag.has_value()) {
 				return Result<void>::err(Error::missing_required_flag(name));
 			}
@@ -267,116 +362,165 @@ namespace cli {
 		return Result<void>::ok();
 	}
 
+	MemoryStats Parser::memory_stats() const {
+		MemoryStats stats;
+		for (const auto &[name, flag]: flags_) {
+			stats.strings += detail::heap_bytes(name);
+			flag.add_memory(stats);
+		}
+		for (const auto &pos: positionals_) {
+			pos.add_memory(stats);
+		}
+		for (const auto &entry: positional_index_) {
+			stats.strings += detail::heap_bytes(entry.key);
+		}
+
+		stats.tables += flags_.heap_bytes() + sizeof(detail::ShortNameIndex) + short_index_->heap_bytes();
+		stats.tables += sizeof(detail::CommandPresence) + presence_->heap_bytes();
+		stats.tables += positionals_.capacity() * sizeof(PositionalStorage) + positional_index_.heap_bytes() + subcommands_.heap_bytes();
+		stats.tables += flag_names_.heap_bytes() + subcommand_names_.heap_bytes();
+
+		stats.strings += detail::heap_bytes(app_name_) + detail::heap_bytes(description_) + detail::heap_bytes(version_) + detail::heap_bytes(rest_name_);
+		stats.strings += help_cache_.heap_bytes();
+#ifndef CPPLI_MINIMAL
+		stats.strings += examples_.capacity() * sizeof(Example);
+		for (const auto &example: examples_) {
+			stats.strings += detail::heap_bytes(example.description) + detail::heap_bytes(example.command);
+		}
+#endif
+
+		stats.values += detail::heap_bytes(arg_views_) + detail::heap_bytes(chain_) + detail::heap_bytes(selected_subcommand_);
+
+		for (const auto &[name, sub]: subcommands_) {
+			stats.strings += detail::heap_bytes(name);
+			const MemoryStats child = sub->memory_stats();
+			stats.subcommands += sizeof(Subcommand) + child.total();
+			stats.function_targets += child.function_targets;
+		}
+		return stats;
+	}
+
+	ParserSpec Parser::freeze() const {
+		auto root = std::make_shared<detail::SpecCommand>();
+		root->name = app_name_;
+		root->is_root = true;
+		root->required_subcommand_count = required_subcommand_count_;
+		root->abbreviations = abbreviations_;
+		root->chain = chain_subcommands_;
+		root->rest = rest_name_.has_value();
+
+		for (const auto &[name, flag]: flags_) {
+			root->add_flag(name, flag);
+		}
+		for (const auto &pos: positionals_) {
+			root->add_positional(pos);
+		}
+		for (const auto &[name, sub]: subcommands_) {
+			sub->materialize();
+			root->subcommands.insert_or_assign(name, sub->freeze());
+		}
+		root->finish();
+
+		return ParserSpec(std::move(root));
+	}
+
+	void Parser::reset() {
+		for (const auto &[name, flag]: flags_) {
+			flag.reset();
+		}
+		for (const auto &pos: positionals_) {
+			pos.reset();
+		}
+		for (const auto &[name, sub]: subcommands_) {
+			sub->reset();
+		}
+		selected_subcommand_.reset();
+		chain_.clear();
+		callbacks_ = {};
+		rest_ = {};
+		response_files_.reset();
+		parsed_ = false;
+		help_requested_ = false;
+		version_requested_ = false;
+		completion_requested_ = false;
+	}
+
 	bool Parser::has(std::string_view flag_name) const {
-		auto it = flags_.find(std::string(flag_name));
-		return it != flags_.end() && it->second.has_value();
+		return presence_->flags.present(flags_.index_of(flag_name));
 	}
 
 	void Parser::print_help(std::ostream &os) const {
-		os << generate_help();
+		const std::string &text = help_text();
+		os.write(text.data(), static_cast<std::streamsize>(text.size()));
+	}
+
+	void Parser::write_help(std::FILE *stream) const {
+		detail::write_text(stream, help_text());
 	}
 
 	void Parser::print_version(std::ostream &os) const {
-		ColorGuard guard(os, BOLD);
+		const bool color = detail::color_enabled();
+		if (color) {
+			os << detail::ansi_bold;
+		}
 		os << app_name_;
 		if (! version_.empty()) {
 			os << " v" << version_;
 		}
 		os << "\n";
-	}
-
-	std::string Parser::format_flag_for_help(const FlagStorage &flag, const std::string &long_name) const {
-		std::ostringstream oss;
-
-		oss << "    ";
-		std::string short_name = flag.get_short_name();
-		if (! short_name.empty()) {
-			oss << "-" << short_name << ", ";
-		} else {
-			oss << "    ";
-		}
-
-		oss << "--" << long_name;
-
-		if (flag.is_required()) {
-			oss << " (required)";
+		if (color) {
+			os << detail::ansi_reset;
 		}
-
-		return oss.str();
 	}
 
 	std::string Parser::generate_help() const {
-		std::ostringstream oss;
+		return help_text();
+	}
 
-		{
-			ColorGuard guard(oss, BOLD);
-			oss << app_name_;
-			if (! version_.empty()) {
-				oss << " v" << version_;
-			}
+	const std::string &Parser::help_text() const {
+		return help_cache_.get(revision_ + short_index_->revision(), [this](std::string &out) {
+			render_help(out);
+		});
+	}
+
+	void Parser::render_help(std::string &out) const {
+		std::string title = app_name_;
+		if (! version_.empty()) {
+			title += " v";
+			title += version_;
 		}
-		oss << "\n";
+		detail::append_styled(out, detail::ansi_bold, title);
+		out += '\n';
 
+#ifndef CPPLI_MINIMAL
 		if (! description_.empty()) {
-			oss << description_ << "\n";
+			out += description_;
+			out += '\n';
 		}
+#endif
 
-		oss << "\nUSAGE:\n";
-		oss << "    " << app_name_ << " [OPTIONS]";
-
-		for (const auto &pos: positionals_) {
-			if (pos.is_required()) {
-				oss << " <" << pos.get_name() << ">";
-			} else {
-				oss << " [" << pos.get_name() << "]";
-			}
-		}
+		out += "\nUSAGE:\n    ";
+		out += app_name_;
+		out += " [OPTIONS]";
+		detail::append_usage_positionals(out, positionals_);
+		detail::append_usage_rest(out, rest_name_);
 
 		if (! subcommands_.empty()) {
-			if (required_subcommand_count_ != 0) {
-				oss << " <SUBCOMMAND>";
-			} else {
-				oss << " [SUBCOMMAND]";
-			}
+			out += required_subcommand_count_ != 0 ? " <SUBCOMMAND>" : " [SUBCOMMAND]";
 		}
+		out += "\n\n";
 
-		oss << "\n\n";
-
-		if (! flags_.empty()) {
-			oss << "OPTIONS:\n";
-			for (const auto &[name, flag]: flags_) {
-				oss << format_flag_for_help(flag, name) << "\n";
-				std::string desc = flag.get_description();
-				if (! desc.empty()) {
-					oss << "        " << desc << "\n";
-				}
-			}
-			oss << "\n";
-		}
+#ifndef CPPLI_MINIMAL
+		detail::append_options(out, flags_);
 
 		if (! subcommands_.empty()) {
-			oss << "SUBCOMMANDS:\n";
-			for (const auto &[name, sub]: subcommands_) {
-				oss << "    " << name;
-				if (! sub->description().empty()) {
-					oss << " - " << sub->description();
-				}
-				oss << "\n";
-			}
-			oss << "\n";
-			oss << "Use '" << app_name_ << " <SUBCOMMAND> --help' for more information on a subcommand.\n\n";
+			detail::append_subcommand_list(out, subcommands_);
+			out += "Use '";
+			out += app_name_;
+			out += " <SUBCOMMAND> --help' for more information on a subcommand.\n\n";
 		}
 
-		if (! examples_.empty()) {
-			oss << "EXAMPLES:\n";
-			for (const auto &example: examples_) {
-				oss << "  " << example.description << "\n";
-				oss << "    $ ";
-				ColorGuard guard(oss, GREEN);
-				oss << example.command << "\n\n";
-			}
-		}
-
-		return oss.str();
+		detail::append_examples(out, examples_);
+#endif
 	}
 }// namespace cli
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cppli.hpp>
+#include <cppli_completion.hpp>
+#include <cppli_tokenizer.hpp>
+#include <cstdio>
+
+namespace cli {
+
+	namespace detail {
+
+		std::span<const std::string> PrefixIndex::matches(std::string_view prefix) {
+			if (! sorted_) {
+				std::ranges::sort(entries_);
+				const auto [first, last] = std::ranges::unique(entries_);
+				entries_.erase(first, last);
+				sorted_ = true;
+			}
+
+			const auto begin = std::ranges::lower_bound(entries_, prefix, {}, [](const std::string &entry) {
+				return std::string_view(entry);
+			});
+			auto end = begin;
+			while (end != entries_.end() && end->starts_with(prefix)) {
+				++end;
+			}
+			return {begin, end};
+		}
+
+		void add_flag_candidates(PrefixIndex &index, const NameTable<FlagStorage> &flags) {
+			for (const auto &[name, flag]: flags) {
+				index.add("--" + name);
+				if (! flag.get_short_name().empty()) {
+					index.add("-" + flag.get_short_name());
+				}
+			}
+		}
+
+		void add_choice_candidates(PrefixIndex &index, const FlagStorage &flag, std::string_view lead) {
+			std::vector<std::string> choices;
+			flag.append_choices(choices);
+			for (auto &choice: choices) {
+				index.add(lead.empty() ? std::move(choice) : std::string(lead) + choice);
+			}
+		}
+
+		namespace {
+			/**
+			 * @brief app name usable inside a shell function name.
+			 */
+			std::string function_name(std::string_view app) {
+				std::string name = "_";
+				for (const char c: app) {
+					const bool word = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+					name += word ? c : '_';
+				}
+				return name + "_complete";
+			}
+		}// namespace
+
+		std::string completion_script(std::string_view app, CompletionShell shell) {
+			const std::string fn = function_name(app);
+			const std::string cmd(app);
+			std::string out;
+
+			switch (shell) {
+				case CompletionShell::Bash:
+					out += "# bash completion for " + cmd + "; source this file or put it in bash-completion's directory\n";
+					out += fn + "() {\n";
+					out += "    local IFS=$'\\n'\n";
+					out += "    COMPREPLY=($(" + cmd + " " + std::string(completion_command) + " \"${COMP_WORDS[@]:1:COMP_CWORD}\" 2>/dev/null))\n";
+					out += "}\n";
+					out += "complete -o default -F " + fn + " " + cmd + "\n";
+					break;
+				case CompletionShell::Zsh:
+					out += "#compdef " + cmd + "\n";
+					out += fn + "() {\n";
+					out += "    local -a candidates\n";
+					out += "    candidates=(\"${(@f)$(" + cmd + " " + std::string(completion_command) + " \"${(@)words[2,CURRENT]}\" 2>/dev/null)}\")\n";
+					out += "    compadd -a candidates\n";
+					out += "}\n";
+					out += "compdef " + fn + " " + cmd + "\n";
+					break;
+				case CompletionShell::Fish:
+					out += "function " + fn + "\n";
+					out += "    set -l words (commandline -opc)\n";
+					out += "    set -e words[1]\n";
+					out += "    " + cmd + " " + std::string(completion_command) + " $words (commandline -ct) 2>/dev/null\n";
+					out += "end\n";
+					out += "complete -c " + cmd + " -f -a '(" + fn + ")'\n";
+					break;
+			}
+
+			return out;
+		}
+
+	}// namespace detail
+
+	Parser &Parser::add_completion() {
+		completion_enabled_ = true;
+		return *this;
+	}
+
+	std::vector<std::string> Parser::complete(std::span<const std::string_view> words) {
+		const detail::NameTable<FlagStorage> *flags = &flags_;
+		const detail::ShortNameIndex *short_index = short_index_.get();
+		detail::NameTable<std::unique_ptr<Subcommand>> *subcommands = &subcommands_;
+
+		const std::string_view current = words.empty() ? std::string_view{} : words.back();
+		const auto typed = words.empty() ? words : words.first(words.size() - 1);
+
+		// Walk only the typed path: descend into subcommands and skip flag values.
+		const FlagStorage *pending = nullptr;
+		bool after_double_dash = false;
+		for (const std::string_view word: typed) {
+			if (pending != nullptr) {
+				pending = nullptr;
+				continue;
+			}
+			if (after_double_dash) {
+				continue;
+			}
+			const detail::Token token = detail::classify_token(word);
+			if (token.kind == detail::TokenKind::DoubleDash) {
+				after_double_dash = true;
+			} else if (token.kind == detail::TokenKind::Long) {
+				const auto *flag = flags->find(token.name);
+				pending = flag != nullptr && ! flag->is_boolean() ? flag : nullptr;
+			} else if (token.kind == detail::TokenKind::Short) {
+				const auto index = short_index->find(token.name);
+				if (index != detail::ShortNameIndex::npos && ! flags->at(index).value.is_boolean()) {
+					pending = &flags->at(index).value;
+				}
+			} else if (token.kind == detail::TokenKind::Positional) {
+				if (auto *sub = subcommands->find(word); sub != nullptr) {
+					Subcommand &subcommand = **sub;
+					subcommand.materialize();
+					flags = &subcommand.flags_;
+					short_index = subcommand.short_index_.get();
+					subcommands = &subcommand.subcommands_;
+				}
+			}
+		}
+
+		detail::PrefixIndex index;
+		if (pending != nullptr) {
+			detail::add_choice_candidates(index, *pending, {});
+		} else if (! after_double_dash) {// only positionals follow `--`; those are left to the shell
+			const auto eq = current.find('=');
+			if (current.starts_with("--") && eq != std::string_view::npos) {
+				if (const auto *flag = flags->find(current.substr(2, eq - 2)); flag != nullptr) {
+					detail::add_choice_candidates(index, *flag, current.substr(0, eq + 1));
+				}
+			} else if (current.starts_with('-')) {
+				detail::add_flag_candidates(index, *flags);
+			} else {
+				for (const auto &[name, sub]: *subcommands) {
+					index.add(name);
+				}
+			}
+		}
+
+		const auto found = index.matches(current);
+		return {found.begin(), found.end()};
+	}
+
+	void Parser::write_completions(std::span<const std::string_view> words) {
+		for (const auto &candidate: complete(words)) {
+			std::fwrite(candidate.data(), 1, candidate.size(), stdout);
+			std::fputc('\n', stdout);
+		}
+		std::fflush(stdout);
+	}
+
+	std::string Parser::completion_script(CompletionShell shell) const {
+		return detail::completion_script(app_name_, shell);
+	}
+
+}// namespace cli
@@ -0,0 +1,146 @@
+#include <charconv>
+#include <cppli.hpp>
+#include <cppli_config.hpp>
+#include <cppli_response_file.hpp>
+#include <cstdlib>
+#include <string>
+
+namespace cli {
+
+	namespace detail {
+
+		namespace {
+			constexpr std::string_view trim(std::string_view text) noexcept {
+				constexpr std::string_view blanks = " \t\r\f\v";
+				const auto first = text.find_first_not_of(blanks);
+				if (first == std::string_view::npos) {
+					return {};
+				}
+				return text.substr(first, text.find_last_not_of(blanks) - first + 1);
+			}
+
+			constexpr std::string_view unquote(std::string_view value) noexcept {
+				if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front()) {
+					return value.substr(1, value.size() - 2);
+				}
+				return value;
+			}
+		}// namespace
+
+		std::optional<ConfigLine> ConfigScanner::next() noexcept {
+			while (pos_ < text_.size()) {
+				const auto end = text_.find('\n', pos_);
+				const auto raw = text_.substr(pos_, end == std::string_view::npos ? std::string_view::npos : end - pos_);
+				pos_ = end == std::string_view::npos ? text_.size() : end + 1;
+				++line_;
+
+				const std::string_view text = trim(raw);
+				if (text.empty() || text.front() == '#' || text.front() == ';') {
+					continue;
+				}
+
+				if (text.front() == '[') {
+					if (text.back() != ']') {
+						return ConfigLine{ConfigLine::Kind::Malformed, {}, "section header without ']'"};
+					}
+					const std::string_view name = trim(text.substr(1, text.size() - 2));
+					if (name.empty()) {
+						return ConfigLine{ConfigLine::Kind::Malformed, {}, "empty section name"};
+					}
+					return ConfigLine{ConfigLine::Kind::Section, name, {}};
+				}
+
+				const auto eq = text.find('=');
+				if (eq == std::string_view::npos) {
+					return ConfigLine{ConfigLine::Kind::Malformed, {}, "expected key = value"};
+				}
+				const std::string_view key = trim(text.substr(0, eq));
+				if (key.empty()) {
+					return ConfigLine{ConfigLine::Kind::Malformed, {}, "missing key before '='"};
+				}
+				return ConfigLine{ConfigLine::Kind::Entry, key, unquote(trim(text.substr(eq + 1)))};
+			}
+			return std::nullopt;
+		}
+
+		Result<void> apply_environment(const NameTable<FlagStorage> &flags, const ParseTrace *trace) {
+			for (const auto &[name, flag]: flags) {
+				const std::string &variable = flag.get_env_name();
+				if (variable.empty()) {
+					continue;
+				}
+				const char *value = std::getenv(variable.c_str());
+				if (value == nullptr) {
+					continue;
+				}
+				auto stored = flag.set_value_from(value, ValueSource::Environment, trace);
+				if (! stored) {
+					return stored;
+				}
+			}
+			return Result<void>::ok();
+		}
+
+	}// namespace detail
+
+	Result<void> Parser::load_config(const std::string &path) {
+		const auto file = detail::MappedFile::open(path);
+		if (! file) {
+			return Result<void>::err(Error::config_error(path, "cannot be opened"));
+		}
+
+		detail::ConfigScanner scanner(file->contents());
+		auto fail = [&](std::string_view reason) {
+			char line[24];
+			const auto end = std::to_chars(line, line + sizeof(line), scanner.line()).ptr;
+			std::string location = path;
+			location.append(":").append(line, end);
+			return Result<void>::err(Error::config_error(location, reason));
+		};
+
+		// Values go straight into the flags; nothing is collected first.
+		const detail::NameTable<FlagStorage> *flags = &flags_;
+		while (const auto line = scanner.next()) {
+			switch (line->kind) {
+				case detail::ConfigLine::Kind::Malformed:
+					return fail(line->value);
+
+				case detail::ConfigLine::Kind::Section: {
+					// `[remote.add]` is the `add` subcommand of `remote`.
+					detail::NameTable<std::unique_ptr<Subcommand>> *subcommands = &subcommands_;
+					std::string_view rest = line->key;
+					while (true) {
+						const auto dot = rest.find('.');
+						auto *sub = subcommands->find(rest.substr(0, dot));
+						if (sub == nullptr) {
+							return fail("unknown section [" + std::string(line->key) + "]");
+						}
+						Subcommand &subcommand = **sub;
+						subcommand.materialize();
+						flags = &subcommand.flags_;
+						subcommands = &subcommand.subcommands_;
+						if (dot == std::string_view::npos) {
+							break;
+						}
+						rest.remove_prefix(dot + 1);
+					}
+					break;
+				}
+
+				case detail::ConfigLine::Kind::Entry: {
+					const auto *flag = flags->find(line->key);
+					if (flag == nullptr) {
+						return fail("unknown option '" + std::string(line->key) + "'");
+					}
+					auto stored = flag->set_value_from(line->value, ValueSource::ConfigFile);
+					if (! stored) {
+						return fail(stored.error().message());
+					}
+					break;
+				}
+			}
+		}
+		return Result<void>::ok();
+	}
+
+}// namespace cli
@@ -1,45 +1,115 @@
+#include <charconv>
 #include <cppli_error.hpp>
-#include <sstream>
+#include <iterator>
 
 namespace cli {
 
+	Error::Error(ErrorCode code, const char *pattern, std::string_view first, std::string_view second, std::source_location location)
+		: pattern_(pattern), location_(location), code_(code) {
+		const std::size_t total_size = first.size() + second.size();
+		if (total_size <= inline_capacity) {
+			first_size_ = static_cast<std::uint8_t>(first.size());
+			total_size_ = static_cast<std::uint8_t>(total_size);
+			std::copy(first.begin(), first.end(), inline_);
+			std::copy(second.begin(), second.end(), inline_ + first.size());
+			return;
+		}
+
+		auto spill = std::make_unique<Spill>();
+		spill->first_size = first.size();
+		spill->text.reserve(total_size);
+		spill->text.append(first).append(second);
+		spill_ = spill.release();
+		spilled_ = true;
+	}
+
+	std::string Error::message() const {
+		std::string text;
+		format_to(std::back_inserter(text));
+		return text;
+	}
+
 	std::string Error::format() const {
-		std::ostringstream oss;
-		oss << message_;
+		std::string text = message();
 
 #ifndef NDEBUG
-		oss << " [" << location_.file_name() << ":" << location_.line() << "]";
+		char line[16];
+		const auto end = std::to_chars(line, line + sizeof(line), location_.line()).ptr;
+		text.append(" [").append(location_.file_name()).append(":").append(line, end).append("]");
 #endif
 
-		return oss.str();
+		return text;
 	}
 
 	Error Error::unknown_flag(std::string_view flag_name) {
-		return Error(ErrorCode::UnknownFlag, std::string("Unknown flag: ") + std::string(flag_name));
+		return Error(ErrorCode::UnknownFlag, "Unknown flag: {}", flag_name, {});
+	}
+
+	Error Error::unknown_flag(std::string_view flag_name, std::string_view suggestion) {
+		if (suggestion.empty()) {
+			return unknown_flag(flag_name);
+		}
+		return Error(ErrorCode::UnknownFlag, "Unknown flag: {} (did you mean --{}?)", flag_name, suggestion);
+	}
+
+	Error Error::ambiguous_flag(std::string_view flag_name) {
+		return Error(ErrorCode::UnknownFlag, "Ambiguous flag: {} matches more than one flag", flag_name, {});
+	}
+
+	Error Error::unknown_subcommand(std::string_view name, std::string_view suggestion) {
+		return Error(ErrorCode::UnknownSubcommand, "Unknown subcommand: {} (did you mean {}?)", name, suggestion);
 	}
 
 	Error Error::missing_required_flag(std::string_view flag_name) {
-		return Error(ErrorCode::MissingRequiredFlag, std::string("Required flag missing: --") + std::string(flag_name));
+		return Error(ErrorCode::MissingRequiredFlag, "Required flag missing: --{}", flag_name, {});
 	}
 
 	Error Error::missing_required_positional(std::string_view pos_name) {
-		return Error(ErrorCode::MissingRequiredPositional, std::string("Required positional missing: ") + std::string(pos_name));
+		return Error(ErrorCode::MissingRequiredPositional, "Required positional missing: {}", pos_name, {});
 	}
 
 	Error Error::invalid_flag_value(std::string_view flag_name, std::string_view value) {
-		return Error(ErrorCode::InvalidFlagValue, std::string("Invalid value for --") + std::string(flag_name) + ": " + std::string(value));
+		return Error(ErrorCode::InvalidFlagValue, "Invalid value for --{}: {}", flag_name, value);
 	}
 
 	Error Error::too_many_positionals() {
-		return Error(ErrorCode::TooManyPositionals, "Too many positional arguments");
+		return Error(ErrorCode::TooManyPositionals, "Too many positional arguments", {}, {});
 	}
 
 	Error Error::missing_flag_value(std::string_view flag_name) {
-		return Error(ErrorCode::MissingFlagValue, std::string("Missing value for flag: --") + std::string(flag_name));
+		return Error(ErrorCode::MissingFlagValue, "Missing value for flag: --{}", flag_name, {});
 	}
 
 	Error Error::validation_failed(std::string_view name, std::string_view reason) {
-		return Error(ErrorCode::ValidationFailed, std::string("Validation failed for ") + std::string(name) + ": " + std::string(reason));
+		return Error(ErrorCode::ValidationFailed, "Validation failed for {}: {}", name, reason);
+	}
+
+	Error Error::validation_rejected(std::string_view name, const char *pattern) {
+		return Error(ErrorCode::ValidationFailed, pattern, name, {});
+	}
+
+	Error Error::response_file_error(std::string_view path, std::string_view reason) {
+		return Error(ErrorCode::ResponseFileError, "Cannot expand response file @{}: {}", path, reason);
+	}
+
+	Error Error::snapshot_error(std::string_view reason) {
+		return Error(ErrorCode::SnapshotError, "Invalid parse snapshot: {}", reason, {});
+	}
+
+	Error Error::config_error(std::string_view location, std::string_view reason) {
+		return Error(ErrorCode::ConfigError, "Invalid config file {}: {}", location, reason);
+	}
+
+	Error Error::repeated_subcommand(std::string_view name) {
+		return Error(ErrorCode::SubcommandChainError, "Subcommand given more than once: {}", name, {});
+	}
+
+	Error Error::subcommand_count(std::size_t expected, std::size_t given) {
+		char expected_text[24];
+		char given_text[24];
+		const auto expected_end = std::to_chars(expected_text, expected_text + sizeof(expected_text), expected).ptr;
+		const auto given_end = std::to_chars(given_text, given_text + sizeof(given_text), given).ptr;
+		return Error(ErrorCode::SubcommandChainError, "Expected {} subcommands, got {}", std::string_view(expected_text, expected_end), std::string_view(given_text, given_end));
 	}
 
 }// namespace cli
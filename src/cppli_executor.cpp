@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <atomic>
+#include <cppli_executor.hpp>
+#include <exception>
+#include <memory>
+
+namespace cli {
+
+	namespace {
+		/**
+		 * @brief Shared between bulk_execute and its helper tasks.
+		 *
+		 * Helpers that start after all indices are claimed only touch this state,
+		 * never the caller's fn, so it is safe for them to outlive the call.
+		 */
+		struct BulkState {
+			std::size_t count = 0;
+			const std::function<void(std::size_t)> *fn = nullptr;
+			std::atomic<std::size_t> next{0};
+			std::size_t done = 0;
+			std::exception_ptr error;///< first exception thrown by fn
+			std::mutex mutex;
+			std::condition_variable finished;
+
+			void work() noexcept {
+				std::size_t completed = 0;
+				std::exception_ptr thrown;
+				for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+					++completed;
+					try {
+						(*fn)(i);
+					} catch (...) {
+						// Stop handing out indices; the ones nobody claimed count as done.
+						thrown = std::current_exception();
+						completed += count - std::min(next.exchange(count), count);
+						break;
+					}
+				}
+
+				if (completed > 0) {
+					std::lock_guard lock(mutex);
+					if (thrown && ! error) {
+						error = thrown;
+					}
+					done += completed;
+					if (done == count) {
+						finished.notify_all();
+					}
+				}
+			}
+		};
+	}// namespace
+
+	void Executor::bulk_execute(std::size_t count, const std::function<void(std::size_t)> &fn) {
+		if (count == 0) {
+			return;
+		}
+
+		auto state = std::make_shared<BulkState>();
+		state->count = count;
+		state->fn = &fn;
+
+		const std::size_t helpers = std::min(concurrency(), count) - (concurrency() > 0 ? 1 : 0);
+		try {
+			for (std::size_t i = 0; i < helpers; ++i) {
+				post([state] {
+					state->work();
+				});
+			}
+		} catch (...) {
+			// Fewer helpers only means more work for this thread.
+		}
+
+		state->work();
+
+		std::unique_lock lock(state->mutex);
+		state->finished.wait(lock, [&] {
+			return state->done == state->count;
+		});
+		if (state->error) {
+			std::rethrow_exception(state->error);
+		}
+	}
+
+	ThreadExecutor::ThreadExecutor(std::size_t threads) {
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		workers_.reserve(threads);
+		for (std::size_t i = 0; i < threads; ++i) {
+			workers_.emplace_back([this] {
+				run();
+			});
+		}
+	}
+
+	ThreadExecutor::~ThreadExecutor() {
+		{
+			std::lock_guard lock(mutex_);
+			stopping_ = true;
+		}
+		ready_.notify_all();
+
+		for (auto &worker: workers_) {
+			worker.join();
+		}
+	}
+
+	void ThreadExecutor::post(std::function<void()> task) {
+		{
+			std::lock_guard lock(mutex_);
+			queue_.push_back(std::move(task));
+		}
+		ready_.notify_one();
+	}
+
+	void ThreadExecutor::run() {
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock lock(mutex_);
+				ready_.wait(lock, [this] {
+					return stopping_ || ! queue_.empty();
+				});
+
+				if (queue_.empty()) {
+					return;
+				}
+
+				task = std::move(queue_.front());
+				queue_.pop_front();
+			}
+
+			task();
+		}
+	}
+
+	struct CallbackHandle::State {
+		Executor *executor = nullptr;
+		std::vector<std::vector<std::function<void()>>> stages;
+		std::size_t stage = 0;	  ///< index of the running stage
+		std::size_t remaining = 0;///< tasks of that stage not finished yet
+		bool finished = false;
+		std::exception_ptr error;
+		std::mutex mutex;
+		std::condition_variable done;
+
+		/**
+		 * @brief Post the tasks of the current stage.
+		 */
+		static void post_stage(const std::shared_ptr<State> &state) {
+			auto &tasks = state->stages[state->stage];
+			{
+				std::lock_guard lock(state->mutex);
+				state->remaining = tasks.size();
+			}
+			for (auto &task: tasks) {
+				state->executor->post([state, &task] {
+					std::exception_ptr thrown;
+					try {
+						task();
+					} catch (...) {
+						thrown = std::current_exception();
+					}
+					finish_task(state, thrown);
+				});
+			}
+		}
+
+		static void finish_task(const std::shared_ptr<State> &state, std::exception_ptr thrown) {
+			bool next = false;
+			{
+				std::lock_guard lock(state->mutex);
+				if (thrown && ! state->error) {
+					state->error = thrown;
+				}
+				if (--state->remaining != 0) {
+					return;
+				}
+				++state->stage;
+				if (state->stage == state->stages.size() || state->error) {
+					state->finished = true;
+					state->done.notify_all();
+				} else {
+					next = true;
+				}
+			}
+			if (next) {
+				post_stage(state);
+			}
+		}
+	};
+
+	CallbackHandle CallbackHandle::start(Executor &executor, std::vector<std::vector<std::function<void()>>> stages) {
+		CallbackHandle handle;
+		if (stages.empty()) {
+			return handle;
+		}
+
+		handle.state_ = std::make_shared<State>();
+		handle.state_->executor = &executor;
+		handle.state_->stages = std::move(stages);
+		State::post_stage(handle.state_);
+		return handle;
+	}
+
+	void CallbackHandle::wait() const {
+		if (! state_) {
+			return;
+		}
+
+		std::unique_lock lock(state_->mutex);
+		state_->done.wait(lock, [this] {
+			return state_->finished;
+		});
+		if (state_->error) {
+			std::rethrow_exception(state_->error);
+		}
+	}
+
+	bool CallbackHandle::done() const noexcept {
+		if (! state_) {
+			return true;
+		}
+		std::lock_guard lock(state_->mutex);
+		return state_->finished;
+	}
+
+}// namespace cli
@@ -0,0 +1,97 @@
+#include <cppli_help.hpp>
+
+#ifndef CPPLI_MINIMAL
+#ifdef _WIN32
+#include <io.h>
+#include <stdio.h>
+#else
+#include <unistd.h>
+#endif
+#endif
+
+namespace cli::detail {
+
+#ifndef CPPLI_MINIMAL
+	bool color_enabled() noexcept {
+		static const bool is_terminal = [] {
+#ifdef _WIN32
+			return _isatty(_fileno(stdout)) != 0;
+#else
+			return isatty(fileno(stdout)) == 1;
+#endif
+		}();
+		return is_terminal;
+	}
+#endif
+
+	void append_styled(std::string &out, std::string_view style, std::string_view text) {
+		if (color_enabled()) {
+			out += style;
+			out += text;
+			out += ansi_reset;
+		} else {
+			out += text;
+		}
+	}
+
+	void append_usage_positionals(std::string &out, std::span<const PositionalStorage> positionals) {
+		for (const auto &pos: positionals) {
+			const bool required = pos.is_required();
+			out += required ? " <" : " [";
+			out += pos.get_name();
+			out += required ? '>' : ']';
+		}
+	}
+
+	void append_usage_rest(std::string &out, const std::optional<std::string> &rest_name) {
+		if (rest_name.has_value()) {
+			out += " [-- ";
+			out += *rest_name;
+			out += "...]";
+		}
+	}
+
+#ifndef CPPLI_MINIMAL
+	void append_options(std::string &out, const NameTable<FlagStorage> &flags) {
+		if (flags.empty()) {
+			return;
+		}
+
+		out += "OPTIONS:\n";
+		for (const auto &[long_name, flag]: flags.sorted()) {
+			const std::string &short_name = flag.get_short_name();
+			if (! short_name.empty()) {
+				out += "    -";
+				out += short_name;
+				out += ", ";
+			} else {
+				out += "        ";
+			}
+
+			out += "--";
+			out += long_name;
+
+			if (flag.is_required()) {
+				out += " (required)";
+			}
+			if (flag.is_multi()) {
+				out += " (repeatable)";
+			}
+			out += '\n';
+
+			const std::string &desc = flag.get_description();
+			if (! desc.empty()) {
+				out += "        ";
+				out += desc;
+				out += '\n';
+			}
+		}
+		out += '\n';
+	}
+#endif
+
+	void write_text(std::FILE *stream, std::string_view text) noexcept {
+		std::fwrite(text.data(), 1, text.size(), stream);
+	}
+
+}// namespace cli::detail
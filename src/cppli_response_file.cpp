@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <cppli_error.hpp>
+#include <cppli_response_file.hpp>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cli::detail {
+
+	namespace {
+		constexpr bool is_space(char c) noexcept {
+			return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+		}
+
+		constexpr bool is_special(char c) noexcept {
+			return c == '\'' || c == '"' || c == '\\';
+		}
+
+		constexpr bool is_dquote_escapable(char c) noexcept {
+			return c == '"' || c == '\\' || c == '$' || c == '`' || c == '\n';
+		}
+	}// namespace
+
+	MappedFile::MappedFile(MappedFile &&other) noexcept
+		: data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {
+	}
+
+	MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+		if (this != &other) {
+			unmap();
+			data_ = std::exchange(other.data_, nullptr);
+			size_ = std::exchange(other.size_, 0);
+		}
+		return *this;
+	}
+
+	MappedFile::~MappedFile() {
+		unmap();
+	}
+
+	void MappedFile::unmap() noexcept {
+		if (data_ == nullptr) {
+			return;
+		}
+#ifdef _WIN32
+		UnmapViewOfFile(data_);
+#else
+		munmap(const_cast<void *>(data_), size_);
+#endif
+		data_ = nullptr;
+		size_ = 0;
+	}
+
+	std::optional<MappedFile> MappedFile::open(const std::string &path) {
+		MappedFile file;
+
+#ifdef _WIN32
+		HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (handle == INVALID_HANDLE_VALUE) {
+			return std::nullopt;
+		}
+
+		LARGE_INTEGER size;
+		if (! GetFileSizeEx(handle, &size)) {
+			CloseHandle(handle);
+			return std::nullopt;
+		}
+		if (size.QuadPart == 0) {
+			CloseHandle(handle);
+			return file;
+		}
+
+		HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(handle);
+		if (mapping == nullptr) {
+			return std::nullopt;
+		}
+
+		const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (data == nullptr) {
+			return std::nullopt;
+		}
+
+		file.data_ = data;
+		file.size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+		const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			return std::nullopt;
+		}
+
+		struct stat info {};
+		if (fstat(fd, &info) != 0 || ! S_ISREG(info.st_mode)) {
+			::close(fd);
+			return std::nullopt;
+		}
+		if (info.st_size == 0) {
+			::close(fd);
+			return file;
+		}
+
+		const auto size = static_cast<std::size_t>(info.st_size);
+		void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED) {
+			return std::nullopt;
+		}
+		madvise(data, size, MADV_SEQUENTIAL);
+
+		file.data_ = data;
+		file.size_ = size;
+#endif
+
+		return file;
+	}
+
+	std::optional<std::string_view> ResponseFileTokenizer::next() {
+		while (pos_ < text_.size() && is_space(text_[pos_])) {
+			++pos_;
+		}
+		if (pos_ >= text_.size()) {
+			return std::nullopt;
+		}
+
+		const std::size_t start = pos_;
+
+		// Fast path: a bare word with no quoting is a view into the file.
+		while (pos_ < text_.size() && ! is_space(text_[pos_]) && ! is_special(text_[pos_])) {
+			++pos_;
+		}
+		if (pos_ >= text_.size() || is_space(text_[pos_])) {
+			return text_.substr(start, pos_ - start);
+		}
+
+		// A token that is exactly one quoted run without escapes is also a view.
+		if (pos_ == start && text_[start] != '\\') {
+			const char quote = text_[start];
+			const std::size_t close = text_.find(quote, start + 1);
+			if (close != std::string_view::npos && (close + 1 == text_.size() || is_space(text_[close + 1]))) {
+				const std::string_view inner = text_.substr(start + 1, close - start - 1);
+				if (quote == '\'' || inner.find('\\') == std::string_view::npos) {
+					pos_ = close + 1;
+					return inner;
+				}
+			}
+		}
+
+		// General case: unescape into scratch storage.
+		std::pmr::string &out = scratch_.emplace_back(text_.substr(start, pos_ - start));
+		while (pos_ < text_.size() && ! is_space(text_[pos_])) {
+			const char c = text_[pos_];
+
+			if (c == '\'') {
+				const std::size_t close = std::min(text_.find('\'', pos_ + 1), text_.size());
+				out.append(text_.substr(pos_ + 1, close - pos_ - 1));
+				pos_ = close + 1;
+			} else if (c == '"') {
+				++pos_;
+				while (pos_ < text_.size() && text_[pos_] != '"') {
+					if (text_[pos_] == '\\' && pos_ + 1 < text_.size() && is_dquote_escapable(text_[pos_ + 1])) {
+						if (text_[pos_ + 1] != '\n') {
+							out.push_back(text_[pos_ + 1]);
+						}
+						pos_ += 2;
+					} else {
+						out.push_back(text_[pos_++]);
+					}
+				}
+				++pos_;
+			} else if (c == '\\') {
+				if (pos_ + 1 < text_.size() && text_[pos_ + 1] != '\n') {
+					out.push_back(text_[pos_ + 1]);
+				}
+				pos_ += 2;
+			} else {
+				out.push_back(c);
+				++pos_;
+			}
+		}
+		pos_ = std::min(pos_, text_.size());
+
+		return std::string_view(out);
+	}
+
+	Result<std::span<const std::string_view>> ResponseFileExpander::expand(std::span<const std::string_view> args) {
+		bool any = false;
+		for (const std::string_view arg: args) {
+			if (arg == "--") {
+				break;
+			}
+			if (is_response_file_arg(arg)) {
+				any = true;
+				break;
+			}
+		}
+		if (! any) {
+			return Result<std::span<const std::string_view>>::ok(args);
+		}
+
+		tokens_.reserve(args.size());
+		after_double_dash_ = false;
+		for (const std::string_view arg: args) {
+			auto appended = append(arg, 0);
+			if (! appended) {
+				return Result<std::span<const std::string_view>>::err(appended.error());
+			}
+		}
+
+		return Result<std::span<const std::string_view>>::ok(std::span<const std::string_view>(tokens_));
+	}
+
+	Result<void> ResponseFileExpander::append(std::string_view arg, int depth) {
+		if (after_double_dash_ || ! is_response_file_arg(arg)) {
+			if (arg == "--") {
+				after_double_dash_ = true;
+			}
+			tokens_.push_back(arg);
+			return Result<void>::ok();
+		}
+
+		if (depth >= max_depth) {
+			return Result<void>::err(Error::response_file_error(arg.substr(1), "response files nested too deeply"));
+		}
+
+		auto file = MappedFile::open(std::string(arg.substr(1)));
+		if (! file) {
+			tokens_.push_back(arg);
+			return Result<void>::ok();
+		}
+
+		// Moving a MappedFile keeps its mapping address, so views stay valid as
+		// files_ grows.
+		files_.push_back(std::move(*file));
+		ResponseFileTokenizer tokenizer(files_.back().contents(), scratch_);
+		while (auto token = tokenizer.next()) {
+			auto appended = append(*token, depth + 1);
+			if (! appended) {
+				return appended;
+			}
+		}
+
+		return Result<void>::ok();
+	}
+
+}// namespace cli::detail
@@ -0,0 +1,225 @@
+#include <cppli_snapshot.hpp>
+#include <cstring>
+
+namespace cli {
+
+	void ParseResult::write_snapshot(detail::SnapshotWriter &out, const detail::SpecCommand *parent) const {
+		out.align();
+		const std::size_t start = out.position();
+
+		detail::SnapshotLevel level{};
+		level.entry_count = static_cast<std::uint32_t>(command_->bit_count());
+		level.selected = subcommand_ == nullptr ? detail::snapshot_none : static_cast<std::uint32_t>(command_->subcommands.index_of(subcommand_->command_->name));
+		level.help_requested = help_requested_ ? 1 : 0;
+		level.version_requested = version_requested_ ? 1 : 0;
+		level.chained = next_ == nullptr ? detail::snapshot_none : static_cast<std::uint32_t>(parent->subcommands.index_of(next_->command_->name));
+		out.write(&level, sizeof(level));
+
+		const std::size_t table = out.position();
+		out.zeros(command_->bit_count() * sizeof(std::uint32_t));
+
+		auto record = [&](std::uint32_t bit) {
+			out.align();
+			const auto offset = static_cast<std::uint32_t>(out.position());
+			out.write_at(table + bit * sizeof(offset), &offset, sizeof(offset));
+		};
+		for (const auto &[name, flag]: command_->flags) {
+			if (test(flag.bit)) {
+				record(flag.bit);
+				flag.storage.snapshot(slot(flag.offset), out);
+			}
+		}
+		for (const auto &pos: command_->positionals) {
+			if (test(pos.bit)) {
+				record(pos.bit);
+				pos.storage.snapshot(slot(pos.offset), out);
+			}
+		}
+
+		if (subcommand_ != nullptr) {
+			out.align();
+			const auto next = static_cast<std::uint32_t>(out.position());
+			out.write_at(start + offsetof(detail::SnapshotLevel, next), &next, sizeof(next));
+			subcommand_->write_snapshot(out, command_);
+		}
+		if (next_ != nullptr) {
+			out.align();
+			const auto chained = static_cast<std::uint32_t>(out.position());
+			out.write_at(start + offsetof(detail::SnapshotLevel, chained_next), &chained, sizeof(chained));
+			next_->write_snapshot(out, parent);
+		}
+	}
+
+	Result<std::size_t> ParseResult::serialize(std::span<std::byte> out) const {
+		if (command_ == nullptr) {
+			return Result<std::size_t>::err(Error::snapshot_error("the result is empty"));
+		}
+
+		detail::SnapshotWriter writer(out);
+		writer.zeros(sizeof(detail::SnapshotHeader));
+		write_snapshot(writer, nullptr);
+		writer.align();
+
+		if (! writer.fits()) {
+			return Result<std::size_t>::err(Error::snapshot_error("buffer too small; see serialized_size()"));
+		}
+		if (writer.position() > ~std::uint32_t{0}) {
+			return Result<std::size_t>::err(Error::snapshot_error("result larger than 4 GiB"));
+		}
+
+		detail::SnapshotHeader header{};
+		header.magic = detail::snapshot_magic;
+		header.version = detail::snapshot_version;
+		header.size = static_cast<std::uint32_t>(writer.position());
+		header.spec_hash = command_->hash;
+		writer.write_at(0, &header, sizeof(header));
+		return Result<std::size_t>::ok(writer.position());
+	}
+
+	std::size_t ParseResult::serialized_size() const {
+		if (command_ == nullptr) {
+			return 0;
+		}
+
+		detail::SnapshotWriter writer({});
+		writer.zeros(sizeof(detail::SnapshotHeader));
+		write_snapshot(writer, nullptr);
+		writer.align();
+		return writer.position();
+	}
+
+	Result<ParseResultView> ParseResultView::from_bytes(const ParserSpec &spec, std::span<const std::byte> bytes) {
+		auto invalid = [](std::string_view reason) {
+			return Result<ParseResultView>::err(Error::snapshot_error(reason));
+		};
+
+		if (reinterpret_cast<std::uintptr_t>(bytes.data()) % detail::snapshot_alignment != 0) {
+			return invalid("buffer is not aligned to 16 bytes");
+		}
+		if (bytes.size() < sizeof(detail::SnapshotHeader)) {
+			return invalid("truncated header");
+		}
+
+		detail::SnapshotHeader header;
+		std::memcpy(&header, bytes.data(), sizeof(header));
+		if (header.magic != detail::snapshot_magic) {
+			return invalid("not a snapshot");
+		}
+		if (header.version != detail::snapshot_version) {
+			return invalid("unsupported version");
+		}
+		if (header.size > bytes.size() || header.size < sizeof(header)) {
+			return invalid("truncated data");
+		}
+		if (header.spec_hash != spec.hash()) {
+			return invalid("written by a different parser definition");
+		}
+
+		const auto data = bytes.first(header.size);
+		if (auto checked = check_level(*spec.root_, nullptr, data, sizeof(header)); ! checked) {
+			return Result<ParseResultView>::err(checked.error());
+		}
+		return Result<ParseResultView>::ok(ParseResultView(spec.root_.get(), nullptr, data.data(), sizeof(header)));
+	}
+
+	Result<void> ParseResultView::check_level(const detail::SpecCommand &command, const detail::SpecCommand *parent, std::span<const std::byte> bytes, std::size_t offset) {
+		auto invalid = [](std::string_view reason) {
+			return Result<void>::err(Error::snapshot_error(reason));
+		};
+		auto fits = [&](std::size_t at, std::size_t size) {
+			return at <= bytes.size() && size <= bytes.size() - at;
+		};
+
+		if (offset % detail::snapshot_alignment != 0 || ! fits(offset, sizeof(detail::SnapshotLevel))) {
+			return invalid("bad level offset");
+		}
+		detail::SnapshotLevel level;
+		std::memcpy(&level, bytes.data() + offset, sizeof(level));
+		if (level.entry_count != command.bit_count() || ! fits(offset + sizeof(level), level.entry_count * sizeof(std::uint32_t))) {
+			return invalid("level does not match the parser definition");
+		}
+
+		for (std::uint32_t bit = 0; bit < level.entry_count; ++bit) {
+			std::uint32_t at;
+			std::memcpy(&at, bytes.data() + offset + sizeof(level) + bit * sizeof(at), sizeof(at));
+			if (at == 0) {
+				continue;
+			}
+			if (at % detail::snapshot_alignment != 0 || ! fits(at, sizeof(detail::SnapshotEntry))) {
+				return invalid("bad entry offset");
+			}
+
+			detail::SnapshotEntry entry;
+			std::memcpy(&entry, bytes.data() + at, sizeof(entry));
+			const bool multi = bit < command.flags.size() && command.flags.at(bit).value.multi;
+			if (! multi && entry.count != 1) {
+				return invalid("single value with a repeat count");
+			}
+
+			const std::size_t values = at + sizeof(entry);
+			if (entry.kind == detail::SnapshotKind::Raw) {
+				if (! fits(values, std::size_t(entry.count) * entry.value_size)) {
+					return invalid("truncated value");
+				}
+			} else if (entry.kind == detail::SnapshotKind::Text) {
+				if (! fits(values, std::size_t(entry.count) * sizeof(detail::SnapshotText))) {
+					return invalid("truncated value table");
+				}
+				for (std::uint32_t i = 0; i < entry.count; ++i) {
+					detail::SnapshotText where;
+					std::memcpy(&where, bytes.data() + values + i * sizeof(where), sizeof(where));
+					if (! fits(at + std::size_t(where.offset), where.size)) {
+						return invalid("truncated text value");
+					}
+				}
+			} else {
+				return invalid("unknown entry kind");
+			}
+		}
+
+		if (level.selected == detail::snapshot_none) {
+			if (level.next != 0) {
+				return invalid("subcommand level without a selection");
+			}
+		} else if (level.selected >= command.subcommands.size() || level.next <= offset) {
+			return invalid("bad subcommand selection");
+		} else if (auto checked = check_level(*command.subcommands.at(level.selected).value, &command, bytes, level.next); ! checked) {
+			return checked;
+		}
+
+		if (level.chained == detail::snapshot_none) {
+			return level.chained_next == 0 ? Result<void>::ok() : invalid("chained level without a selection");
+		}
+		if (parent == nullptr || level.chained >= parent->subcommands.size() || level.chained_next <= offset) {
+			return invalid("bad chained subcommand");
+		}
+		return check_level(*parent->subcommands.at(level.chained).value, parent, bytes, level.chained_next);
+	}
+
+	bool ParseResultView::has(std::string_view flag_name) const {
+		const auto *flag = command_->flags.find(flag_name);
+		return flag != nullptr && (entry(flag->bit) != nullptr || flag->default_fallback);
+	}
+
+	std::optional<std::string_view> ParseResultView::get_selected_subcommand() const {
+		if (level().selected == detail::snapshot_none) {
+			return std::nullopt;
+		}
+		return command_->subcommands.at(level().selected).key;
+	}
+
+	std::optional<ParseResultView> ParseResultView::get_subcommand() const {
+		if (level().selected == detail::snapshot_none) {
+			return std::nullopt;
+		}
+		return ParseResultView(command_->subcommands.at(level().selected).value.get(), command_, bytes_, level().next);
+	}
+
+	std::optional<ParseResultView> ParseResultView::get_next_subcommand() const {
+		if (level().chained == detail::snapshot_none) {
+			return std::nullopt;
+		}
+		return ParseResultView(parent_->subcommands.at(level().chained).value.get(), parent_, bytes_, level().chained_next);
+	}
+
+}// namespace cli
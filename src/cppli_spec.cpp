@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <cppli_error.hpp>
+#include <cppli_response_file.hpp>
+#include <cppli_spec.hpp>
+#include <cppli_tokenizer.hpp>
+#include <stdexcept>
+#include <utility>
+
+namespace cli {
+
+	namespace detail {
+
+		namespace {
+			constexpr std::uint64_t mix(std::uint64_t hash, std::uint64_t value) noexcept {
+				hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+				return hash;
+			}
+		}// namespace
+
+		std::size_t SpecCommand::reserve_slot(std::size_t size, std::size_t align) {
+			if (align > alignof(std::max_align_t)) {
+				throw std::logic_error("Over-aligned flag value types are not supported by ParserSpec");
+			}
+			const std::size_t offset = (block_size + align - 1) / align * align;
+			block_size = offset + size;
+			return offset;
+		}
+
+		void SpecCommand::add_flag(const std::string &long_name, const FlagStorage &flag) {
+			SpecFlag spec_flag;
+			spec_flag.storage = flag.clone();
+			spec_flag.offset = reserve_slot(flag.value_size(), flag.value_align());
+			spec_flag.multi = flag.is_multi();
+			spec_flag.default_fallback = spec_flag.multi && flag.has_default();
+
+			const auto index = static_cast<std::uint32_t>(flags.size());
+			flags.insert_or_assign(long_name, std::move(spec_flag));
+			short_names.add(flag.get_short_name(), index);
+		}
+
+		void SpecCommand::add_positional(const PositionalStorage &pos) {
+			SpecPositional spec_pos;
+			spec_pos.storage = pos.clone();
+			spec_pos.offset = reserve_slot(pos.value_size(), pos.value_align());
+			if (! positional_index.contains(pos.get_name())) {
+				positional_index.insert_or_assign(pos.get_name(), static_cast<std::uint32_t>(positionals.size()));
+			}
+			positionals.push_back(std::move(spec_pos));
+		}
+
+		void SpecCommand::finish() {
+			required.assign((bit_count() + 63) / 64, 0);
+
+			std::uint32_t bit = 0;
+			for (auto &[name, flag]: flags) {
+				flag.bit = bit;
+				if (flag.storage.is_required() && ! flag.default_fallback) {
+					required[bit / 64] |= std::uint64_t{1} << (bit % 64);
+				}
+				++bit;
+			}
+			for (auto &pos: positionals) {
+				pos.bit = bit;
+				if (pos.storage.is_required()) {
+					required[bit / 64] |= std::uint64_t{1} << (bit % 64);
+				}
+				++bit;
+			}
+
+			flag_names = NameTrie(flags);
+			subcommand_names = NameTrie(subcommands);
+
+			presence_offset = (block_size + alignof(std::uint64_t) - 1) / alignof(std::uint64_t) * alignof(std::uint64_t);
+			allocation_size = presence_offset + required.size() * sizeof(std::uint64_t);
+
+			hash = mix(hash_name(name), (is_root ? 1 : 0) | (rest ? 2 : 0) | (chain ? 4 : 0));
+			for (const auto &[long_name, flag]: flags) {
+				hash = mix(hash, hash_name(long_name));
+				hash = mix(hash, hash_name(flag.storage.get_short_name()));
+				hash = mix(hash, flag.storage.value_size() << 16 | flag.storage.value_align() << 2 | (flag.multi ? 2 : 0) | (flag.storage.is_boolean() ? 1 : 0));
+			}
+			for (const auto &pos: positionals) {
+				hash = mix(hash, hash_name(pos.storage.get_name()));
+				hash = mix(hash, pos.storage.value_size() << 16 | pos.storage.value_align());
+			}
+			for (const auto &[sub_name, sub]: subcommands) {
+				hash = mix(hash, sub->hash);
+			}
+		}
+
+		void SpecCommand::add_memory(MemoryStats &stats) const {
+			stats.strings += heap_bytes(name);
+			for (const auto &[long_name, flag]: flags) {
+				stats.strings += heap_bytes(long_name);
+				flag.storage.add_memory(stats);
+			}
+			for (const auto &pos: positionals) {
+				pos.storage.add_memory(stats);
+			}
+			for (const auto &entry: positional_index) {
+				stats.strings += heap_bytes(entry.key);
+			}
+
+			stats.tables += flags.heap_bytes() + short_names.heap_bytes() + heap_bytes(required);
+			stats.tables += positionals.capacity() * sizeof(SpecPositional) + positional_index.heap_bytes() + subcommands.heap_bytes();
+			stats.tables += flag_names.heap_bytes() + subcommand_names.heap_bytes();
+
+			for (const auto &[sub_name, sub]: subcommands) {
+				MemoryStats child;
+				sub->add_memory(child);
+				stats.strings += heap_bytes(sub_name);
+				stats.subcommands += sizeof(SpecCommand) + child.total();
+				stats.function_targets += child.function_targets;
+			}
+		}
+
+	}// namespace detail
+
+	ParseResult::ParseResult(const detail::SpecCommand *command, std::pmr::memory_resource *resource)
+		: command_(command), resource_(resource),
+		  block_(static_cast<std::byte *>(resource->allocate(command->allocation_size, alignof(std::max_align_t)))),
+		  present_(reinterpret_cast<std::uint64_t *>(block_ + command->presence_offset)) {
+		std::fill_n(present_, command_->required.size(), std::uint64_t{0});
+
+		for (const auto &[name, flag]: command_->flags) {
+			if (flag.storage.default_into(slot(flag.offset), resource_)) {
+				set(flag.bit);
+			}
+		}
+	}
+
+	ParseResult::ParseResult(ParseResult &&other) noexcept
+		: command_(std::exchange(other.command_, nullptr)), resource_(other.resource_),
+		  block_(std::exchange(other.block_, nullptr)), present_(std::exchange(other.present_, nullptr)),
+		  subcommand_(std::exchange(other.subcommand_, nullptr)), next_(std::exchange(other.next_, nullptr)), rest_(std::exchange(other.rest_, nullptr)),
+		  rest_size_(std::exchange(other.rest_size_, 0)), rest_bytes_(std::exchange(other.rest_bytes_, 0)),
+		  help_requested_(other.help_requested_), version_requested_(other.version_requested_) {
+	}
+
+	ParseResult &ParseResult::operator=(ParseResult &&other) noexcept {
+		if (this != &other) {
+			release();
+			command_ = std::exchange(other.command_, nullptr);
+			resource_ = other.resource_;
+			block_ = std::exchange(other.block_, nullptr);
+			present_ = std::exchange(other.present_, nullptr);
+			subcommand_ = std::exchange(other.subcommand_, nullptr);
+			next_ = std::exchange(other.next_, nullptr);
+			rest_ = std::exchange(other.rest_, nullptr);
+			rest_size_ = std::exchange(other.rest_size_, 0);
+			rest_bytes_ = std::exchange(other.rest_bytes_, 0);
+			help_requested_ = other.help_requested_;
+			version_requested_ = other.version_requested_;
+		}
+		return *this;
+	}
+
+	ParseResult::~ParseResult() {
+		release();
+	}
+
+	ParseResult &ParseResult::select_subcommand(const detail::SpecCommand *command) {
+		void *memory = resource_->allocate(sizeof(ParseResult), alignof(ParseResult));
+		subcommand_ = ::new (memory) ParseResult(command, resource_);
+		return *subcommand_;
+	}
+
+	ParseResult &ParseResult::chain_subcommand(const detail::SpecCommand *command) {
+		void *memory = resource_->allocate(sizeof(ParseResult), alignof(ParseResult));
+		next_ = ::new (memory) ParseResult(command, resource_);
+		return *next_;
+	}
+
+	void ParseResult::capture_rest(std::span<const std::string_view> tokens) {
+		if (tokens.empty()) {
+			return;
+		}
+
+		rest_bytes_ = tokens.size() * sizeof(std::string_view);
+		for (const std::string_view token: tokens) {
+			rest_bytes_ += token.size();
+		}
+
+		rest_ = static_cast<std::string_view *>(resource_->allocate(rest_bytes_, alignof(std::string_view)));
+		char *text = reinterpret_cast<char *>(rest_ + tokens.size());
+		for (const std::string_view token: tokens) {
+			::new (rest_ + rest_size_++) std::string_view(text, token.size());
+			text = std::copy(token.begin(), token.end(), text);
+		}
+	}
+
+	void ParseResult::release() noexcept {
+		if (command_ == nullptr) {
+			return;
+		}
+
+		if (subcommand_ != nullptr) {
+			std::destroy_at(subcommand_);
+			resource_->deallocate(subcommand_, sizeof(ParseResult), alignof(ParseResult));
+			subcommand_ = nullptr;
+		}
+
+		if (next_ != nullptr) {
+			std::destroy_at(next_);
+			resource_->deallocate(next_, sizeof(ParseResult), alignof(ParseResult));
+			next_ = nullptr;
+		}
+
+		if (rest_ != nullptr) {
+			resource_->deallocate(rest_, rest_bytes_, alignof(std::string_view));
+			rest_ = nullptr;
+			rest_size_ = 0;
+			rest_bytes_ = 0;
+		}
+
+		for (const auto &[name, flag]: command_->flags) {
+			if (test(flag.bit)) {
+				flag.storage.destroy_value(slot(flag.offset));
+			}
+		}
+		for (const auto &pos: command_->positionals) {
+			if (test(pos.bit)) {
+				pos.storage.destroy_value(slot(pos.offset));
+			}
+		}
+
+		resource_->deallocate(block_, command_->allocation_size, alignof(std::max_align_t));
+		block_ = nullptr;
+		present_ = nullptr;
+		command_ = nullptr;
+	}
+
+	MemoryStats ParseResult::memory_stats() const {
+		MemoryStats stats;
+		if (command_ == nullptr) {
+			return stats;
+		}
+
+		stats.values += command_->allocation_size + rest_bytes_;
+		for (const auto &[name, flag]: command_->flags) {
+			if (test(flag.bit)) {
+				stats.values += flag.storage.value_memory(slot(flag.offset));
+			}
+		}
+		for (const auto &pos: command_->positionals) {
+			if (test(pos.bit)) {
+				stats.values += pos.storage.value_memory(slot(pos.offset));
+			}
+		}
+
+		if (subcommand_ != nullptr) {
+			stats.subcommands += sizeof(ParseResult) + subcommand_->memory_stats().total();
+		}
+		if (next_ != nullptr) {
+			stats.subcommands += sizeof(ParseResult) + next_->memory_stats().total();
+		}
+		return stats;
+	}
+
+	bool ParseResult::has(std::string_view flag_name) const {
+		if (command_ == nullptr) {
+			return false;
+		}
+
+		const auto *flag = command_->flags.find(flag_name);
+		return flag != nullptr && (test(flag->bit) || flag->default_fallback);
+	}
+
+	std::optional<std::string_view> ParseResult::get_selected_subcommand() const {
+		if (subcommand_ == nullptr) {
+			return std::nullopt;
+		}
+		return subcommand_->command_->name;
+	}
+
+	Result<ParseResult> ParserSpec::parse(int argc, char **argv) const {
+		if (argc <= 1) {
+			return parse(std::span<const std::string_view>{});
+		}
+		return parse(std::span<const char *const>(argv + 1, static_cast<size_t>(argc) - 1));
+	}
+
+	Result<ParseResult> ParserSpec::parse(const std::vector<std::string> &args) const {
+		std::vector<std::string_view> views(args.begin(), args.end());
+		return parse(std::span<const std::string_view>(views));
+	}
+
+	Result<ParseResult> ParserSpec::parse(std::span<const char *const> args) const {
+		std::vector<std::string_view> views(args.begin(), args.end());
+		return parse(std::span<const std::string_view>(views));
+	}
+
+	Result<ParseResult> ParserSpec::parse(std::span<const std::string_view> args) const {
+		return parse(args, std::pmr::get_default_resource());
+	}
+
+	Result<ParseResult> ParserSpec::parse(std::span<const std::string_view> args, std::pmr::memory_resource *resource) const {
+		// Owns any mapped @file contents that args points into after expansion.
+		detail::ResponseFileExpander response_files(resource);
+		auto expanded = response_files.expand(args);
+		if (! expanded) {
+			return Result<ParseResult>::err(expanded.error());
+		}
+		args = expanded.value();
+
+		ParseResult result(root_.get(), resource);
+
+		auto consumed = parse_command(*root_, result, args, 0);
+		if (! consumed) {
+			return Result<ParseResult>::err(consumed.error());
+		}
+
+		if (result.help_requested_ || result.version_requested_) {
+			return Result<ParseResult>::ok(std::move(result));
+		}
+
+		// Mirrors Parser::parse: when a subcommand is selected, each subcommand
+		// of the chain and, as Subcommand::validate_requirements does, the
+		// subcommands selected below it are validated instead of the root
+		// level, before the subcommand count.
+		if (result.subcommand_ == nullptr) {
+			if (auto counted = validate_subcommand_count(result); ! counted) {
+				return Result<ParseResult>::err(counted.error());
+			}
+			if (auto validation = validate_requirements(result); ! validation) {
+				return Result<ParseResult>::err(validation.error());
+			}
+			return Result<ParseResult>::ok(std::move(result));
+		}
+
+		for (const ParseResult *chained = result.subcommand_; chained != nullptr; chained = chained->next_) {
+			for (const ParseResult *level = chained; level != nullptr; level = level->subcommand_) {
+				if (auto validation = validate_requirements(*level); ! validation) {
+					return Result<ParseResult>::err(validation.error());
+				}
+			}
+		}
+		if (auto counted = validate_subcommand_count(result); ! counted) {
+			return Result<ParseResult>::err(counted.error());
+		}
+
+		return Result<ParseResult>::ok(std::move(result));
+	}
+
+	Result<void> ParserSpec::validate_subcommand_count(const ParseResult &result) {
+		const int required = result.command_->required_subcommand_count;
+		if (required == 0) {
+			return Result<void>::ok();
+		}
+		if (result.subcommand_ == nullptr) {
+			return Result<void>::err(Error(ErrorCode::MissingRequiredFlag, "A subcommand is required"));
+		}
+
+		size_t given = 0;
+		for (const ParseResult *chained = result.subcommand_; chained != nullptr; chained = chained->next_) {
+			++given;
+		}
+		if (required > 0 && given != static_cast<size_t>(required)) {
+			return Result<void>::err(Error::subcommand_count(static_cast<size_t>(required), given));
+		}
+		return Result<void>::ok();
+	}
+
+	MemoryStats ParserSpec::memory_stats() const {
+		MemoryStats stats;
+		root_->add_memory(stats);
+		return stats;
+	}
+
+	BatchResult ParserSpec::parse_batch(std::span<const std::vector<std::string_view>> inputs, Executor &executor) const {
+		BatchResult batch;
+		batch.results.resize(inputs.size());
+		batch.errors.resize(inputs.size());
+
+		// A few chunks per worker keeps threads busy when input lengths vary
+		// without paying per-input scheduling cost.
+		constexpr size_t chunks_per_worker = 4;
+		const size_t chunk_count = std::min(inputs.size(), std::max<size_t>(1, executor.concurrency()) * chunks_per_worker);
+		if (chunk_count == 0) {
+			return batch;
+		}
+		const size_t chunk_size = (inputs.size() + chunk_count - 1) / chunk_count;
+
+		std::atomic<size_t> failures{0};
+		executor.bulk_execute(chunk_count, [&](size_t chunk) {
+			const size_t begin = chunk * chunk_size;
+			const size_t end = std::min(inputs.size(), begin + chunk_size);
+			size_t local_failures = 0;
+
+			for (size_t i = begin; i < end; ++i) {
+				auto parsed = parse(std::span<const std::string_view>(inputs[i]));
+				if (parsed) {
+					batch.results[i] = std::move(parsed.value());
+				} else {
+					batch.errors[i] = parsed.error();
+					++local_failures;
+				}
+			}
+
+			failures.fetch_add(local_failures, std::memory_order_relaxed);
+		});
+
+		batch.failures = failures.load(std::memory_order_relaxed);
+		return batch;
+	}
+
+	Result<size_t> ParserSpec::parse_command(const detail::SpecCommand &command, ParseResult &result, std::span<const std::string_view> args, size_t start_index) {
+		// One frozen level of the shared tokenizer; values go into result's slots.
+		struct Handler {
+			const detail::SpecCommand &command;
+			ParseResult &result;
+			std::span<const std::string_view> args;
+			size_t pos_index = 0;
+			bool at_rest = false;///< stopped at the first token of the rest positional
+			std::vector<std::uint32_t> from_environment;///< bits of repeatable flags holding environment values
+
+			/**
+			 * @brief Mirrors detail::apply_environment: set_env variables rank above defaults and below the command line.
+			 */
+			Result<void> apply_environment() {
+				for (const auto &[name, flag]: command.flags) {
+					const std::string &variable = flag.storage.get_env_name();
+					if (variable.empty()) {
+						continue;
+					}
+					const char *value = std::getenv(variable.c_str());
+					if (value == nullptr) {
+						continue;
+					}
+					auto stored = flag.storage.parse_into(result.slot(flag.offset), value, result.test(flag.bit), result.resource_);
+					if (! stored) {
+						return stored;
+					}
+					result.set(flag.bit);
+					if (flag.multi) {
+						from_environment.push_back(flag.bit);
+					}
+				}
+				return Result<void>::ok();
+			}
+
+			detail::FlagMatch<detail::SpecFlag> find_long(std::string_view name) const {
+				const auto found = detail::lookup_name(command.flags, command.abbreviations ? &command.flag_names : nullptr, name);
+				if (found.index == detail::NameTable<detail::SpecFlag>::npos) {
+					return {{}, nullptr, found.ambiguous};
+				}
+				const auto &entry = command.flags.at(found.index);
+				return {entry.key, &entry.value};
+			}
+
+			detail::FlagMatch<detail::SpecFlag> find_short(std::string_view name) const {
+				const auto index = command.short_names.find(name);
+				if (index == detail::ShortNameIndex::npos) {
+					return {};
+				}
+				const auto &entry = command.flags.at(index);
+				return {entry.key, &entry.value};
+			}
+
+			static bool is_boolean(const detail::SpecFlag &flag) noexcept {
+				return flag.storage.is_boolean();
+			}
+
+			bool fallthrough() const noexcept {
+				return command.fallthrough;
+			}
+
+			std::string_view suggest_long(std::string_view name) const {
+				return detail::closest_name(command.flags, command.flag_names, name);
+			}
+
+			Result<void> set_flag(std::string_view name, const detail::SpecFlag &flag, std::string_view value) {
+				if (name == "help") {
+					result.help_requested_ = true;
+				}
+				if (command.is_root && name == "version") {
+					result.version_requested_ = true;
+				}
+				if (flag.multi && std::erase(from_environment, flag.bit) > 0) {
+					// Command-line values replace the environment's, as with TypedFlag::set_value_from.
+					flag.storage.destroy_value(result.slot(flag.offset));
+					result.clear(flag.bit);
+				}
+
+				auto stored = flag.storage.parse_into(result.slot(flag.offset), value, result.test(flag.bit), result.resource_);
+				if (stored) {
+					result.set(flag.bit);
+				}
+				return stored;
+			}
+
+			Result<bool> positional(std::string_view arg) {
+				if (pos_index >= command.positionals.size()) {
+					if (command.rest) {
+						at_rest = true;
+						return Result<bool>::ok(false);
+					}
+					if (command.is_root) {
+						if (const auto near = detail::closest_name(command.subcommands, command.subcommand_names, arg); ! near.empty()) {
+							return Result<bool>::err(Error::unknown_subcommand(arg, near));
+						}
+						return Result<bool>::err(Error::too_many_positionals());
+					}
+					return Result<bool>::ok(false);
+				}
+
+				const auto &pos = command.positionals[pos_index];
+				auto stored = pos.storage.parse_into(result.slot(pos.offset), arg, result.test(pos.bit), result.resource_);
+				if (! stored) {
+					return Result<bool>::err(stored.error());
+				}
+				result.set(pos.bit);
+				++pos_index;
+				return Result<bool>::ok(true);
+			}
+
+			Result<std::optional<size_t>> subcommand(std::string_view arg, size_t next_index) {
+				using Outcome = Result<std::optional<size_t>>;
+
+				const auto found = detail::lookup_name(command.subcommands, command.abbreviations ? &command.subcommand_names : nullptr, arg);
+				if (found.index == detail::NameTable<std::unique_ptr<detail::SpecCommand>>::npos) {
+					return Outcome::ok(std::nullopt);
+				}
+
+				const detail::SpecCommand *sub = command.subcommands.at(found.index).value.get();
+				ParseResult *sub_result = &result.select_subcommand(sub);
+
+				// With chaining, a token that ends one subcommand's arguments may start the next.
+				while (true) {
+					auto consumed = parse_command(*sub, *sub_result, args, next_index);
+					if (! consumed) {
+						return Outcome::err(consumed.error());
+					}
+
+					if (sub_result->help_requested_) {
+						result.help_requested_ = true;
+						return Outcome::ok(args.size());
+					}
+
+					const size_t end = consumed.value();
+					if (! command.chain || end >= args.size()) {
+						return Outcome::ok(end);
+					}
+					const auto next = detail::lookup_name(command.subcommands, command.abbreviations ? &command.subcommand_names : nullptr, args[end]);
+					if (next.index == detail::NameTable<std::unique_ptr<detail::SpecCommand>>::npos) {
+						return Outcome::ok(end);
+					}
+
+					const auto &entry = command.subcommands.at(next.index);
+					for (const ParseResult *chained = result.subcommand_; chained != nullptr; chained = chained->next_) {
+						if (chained->command_ == entry.value.get()) {
+							return Outcome::err(Error::repeated_subcommand(entry.key));
+						}
+					}
+					sub = entry.value.get();
+					sub_result = &sub_result->chain_subcommand(sub);
+					next_index = end + 1;
+				}
+			}
+		};
+
+		Handler handler{command, result, args, 0, false, {}};
+		if (auto env = handler.apply_environment(); ! env) {
+			return Result<size_t>::err(env.error());
+		}
+
+		auto consumed = detail::run_tokenizer(args, start_index, handler);
+		if (consumed && handler.at_rest) {
+			// args may view a response file that is unmapped when parse() returns.
+			result.capture_rest(args.subspan(consumed.value()));
+			return Result<size_t>::ok(args.size());
+		}
+		return consumed;
+	}
+
+	Result<void> ParserSpec::validate_requirements(const ParseResult &result) {
+		const auto &command = *result.command_;
+
+		bool satisfied = true;
+		for (size_t word = 0; word < command.required.size() && satisfied; ++word) {
+			satisfied = (command.required[word] & ~result.present_[word]) == 0;
+		}
+		if (satisfied) {
+			return Result<void>::ok();
+		}
+
+		// Something is missing: report it as Parser does, flags in name order first.
+		const auto missing = [&](std::uint32_t bit) {
+			return (command.required[bit / 64] >> (bit % 64) & 1u) != 0 && ! result.test(bit);
+		};
+		for (const auto &[name, flag]: command.flags.sorted()) {
+			if (missing(flag.bit)) {
+				return Result<void>::err(Error::missing_required_flag(name));
+			}
+		}
+		for (const auto &pos: command.positionals) {
+			if (missing(pos.bit)) {
+				return Result<void>::err(Error::missing_required_positional(pos.storage.get_name()));
+			}
+		}
+
+		return Result<void>::ok();
+	}
+
+}// namespace cli
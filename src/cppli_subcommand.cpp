@@ -1,68 +1,35 @@
 #include <cppli.hpp>
+#include <cppli_config.hpp>
+#include <cppli_help.hpp>
 #include <cppli_subcommand.hpp>
+#include <cppli_tokenizer.hpp>
 #include <iostream>
-#include <sstream>
 #include <string>
 
-#ifdef _WIN32
-#include <io.h>
-#include <stdio.h>
-#else
-#include <unistd.h>
-#endif
-
 namespace cli {
 
-	namespace {
-		class ColorGuard {
-		  public:
-			ColorGuard(std::ostream &os, const char *color) : os_(os) {
-				if (is_tty())
-					os_ << color;
-			}
-
-			~ColorGuard() {
-				if (is_tty())
-					os_ << "\033[0m";
-			}
-
-		  private:
-			std::ostream &os_;
-
-			static bool is_tty() {
-				static bool checked = false;
-				static bool is_terminal = false;
-				if (! checked) {
-#ifdef _WIN32
-					is_terminal = _isatty(_fileno(stdout)) != 0;
-#else
-					is_terminal = isatty(fileno(stdout)) == 1;
-#endif
-					checked = true;
-				}
-				return is_terminal;
-			}
-		};
-
-		constexpr const char *RESET = "\033[0m";
-		constexpr const char *BOLD = "\033[1m";
-		constexpr const char *GREEN = "\033[32m";
-		constexpr const char *YELLOW = "\033[33m";
-		constexpr const char *RED = "\033[31m";
-	}// namespace
-
-	Subcommand::Subcommand(std::string name, std::string description, Parser *parent, Subcommand *parent_subcommand)
+	Subcommand::Subcommand(std::string name, detail::HelpText description, Parser *parent, Subcommand *parent_subcommand)
 		: name_(std::move(name)), description_(std::move(description)), parent_(parent),
-		  parent_subcommand_(parent_subcommand) {
+		  parent_subcommand_(parent_subcommand), short_index_(std::make_unique<detail::ShortNameIndex>()),
+		  presence_(std::make_unique<detail::CommandPresence>()) {
 	}
 
-	Subcommand &Subcommand::add_subcommand(std::string name, std::string description) {
+	Subcommand &Subcommand::add_subcommand(std::string name, detail::HelpText description) {
 		auto subcmd = std::make_unique<Subcommand>(name, std::move(description), parent_, this);
 		auto *ptr = subcmd.get();
-		subcommands_[name] = std::move(subcmd);
+		subcommands_.insert_or_assign(std::move(name), std::move(subcmd));
+		++revision_;
 		return *ptr;
 	}
 
+	Subcommand &Subcommand::add_lazy_subcommand(std::string name, detail::HelpText description, SubcommandFactory factory) {
+		auto subcmd = std::make_unique<Subcommand>(name, std::move(description), parent_, this);
+		subcmd->factory_ = std::move(factory);
+		subcommands_.insert_or_assign(std::move(name), std::move(subcmd));
+		++revision_;
+		return *this;
+	}
+
 	Subcommand &Subcommand::set_callback(std::function<void()> callback) {
 		callback_ = std::move(callback);
 		return *this;
@@ -73,8 +40,17 @@ namespace cli {
 		return *this;
 	}
 
-	Subcommand &Subcommand::add_example(std::string description, std::string command) {
+	Subcommand &Subcommand::add_example([[maybe_unused]] detail::HelpText description, [[maybe_unused]] detail::HelpText command) {
+#ifndef CPPLI_MINIMAL
 		examples_.push_back({std::move(description), std::move(command)});
+		++revision_;
+#endif
+		return *this;
+	}
+
+	Subcommand &Subcommand::add_rest_positional(std::string name) {
+		rest_name_ = std::move(name);
+		++revision_;
 		return *this;
 	}
 
@@ -84,8 +60,7 @@ namespace cli {
 	}
 
 	bool Subcommand::has(std::string_view flag_name) const {
-		auto it = flags_.find(std::string(flag_name));
-		return it != flags_.end() && it->second.has_value();
+		return presence_->flags.present(flags_.index_of(flag_name));
 	}
 
 	std::optional<std::string> Subcommand::get_selected_subcommand() const {
@@ -93,276 +68,315 @@ namespace cli {
 	}
 
 	Subcommand *Subcommand::get_subcommand(std::string_view name) {
-		auto it = subcommands_.find(std::string(name));
-		return it != subcommands_.end() ? it->second.get() : nullptr;
+		auto *sub = subcommands_.find(name);
+		if (sub == nullptr) {
+			return nullptr;
+		}
+		(*sub)->materialize();
+		return sub->get();
 	}
 
-	Result<size_t> Subcommand::parse_args(const std::vector<std::string> &args, size_t start_index) {
-		short_to_long_.clear();
-		for (const auto &[name, storage]: flags_) {
-			const auto s_name = storage.get_short_name();
-			if (! s_name.empty()) {
-				short_to_long_[s_name] = name;
-			}
+	void Subcommand::materialize() {
+		if (! factory_) {
+			return;
 		}
+		// Moved out first so a factory that looks itself up does not run twice.
+		auto factory = std::move(factory_);
+		factory_ = nullptr;
+		factory(*this);
+	}
 
-		size_t pos_index = 0;
-		bool after_double_dash = false;
-		size_t i = start_index;
-
-		while (i < args.size()) {
-			const auto &arg = args[i];
-
-			if (arg == "--") {
-				after_double_dash = true;
-				++i;
-				continue;
-			}
+	Result<size_t> Subcommand::parse_args(std::span<const std::string_view> args, size_t start_index, const detail::ParseTrace *parent_trace) {
+		materialize();
+		const auto trace = detail::make_trace(observer_, parent_trace, name_);
+		const detail::ParseTrace *trace_ptr = trace ? &*trace : nullptr;
+		return detail::traced(trace_ptr, ParseStage::Subcommand, {}, [&] {
+			return parse_tokens(args, start_index, trace_ptr);
+		});
+	}
 
-			if (! after_double_dash && ! arg.empty() && arg[0] != '-') {
-				auto sub_it = subcommands_.find(arg);
-				if (sub_it != subcommands_.end()) {
-					selected_subcommand_ = arg;
-					auto &subcommand = *sub_it->second;
+	Result<size_t> Subcommand::parse_tokens(std::span<const std::string_view> args, size_t start_index, const detail::ParseTrace *trace) {
+		rest_ = {};
 
-					auto result = subcommand.parse_args(args, i + 1);
-					if (! result) {
-						return Result<size_t>::err(result.error());
-					}
+		// One level of the shared tokenizer; stops where this subcommand's arguments end.
+		struct Handler {
+			Subcommand &command;
+			std::span<const std::string_view> args;
+			const detail::ParseTrace *trace;
+			size_t pos_index = 0;
+			bool at_rest = false;///< stopped at the first token of the rest positional
 
-					subcommand.parsed_ = true;
-					if (subcommand.help_requested_) {
-						help_requested_ = true;
-					}
+			bool abbreviations() const noexcept {
+				return command.parent_ != nullptr && command.parent_->abbreviations_allowed();
+			}
 
-					return Result<size_t>::ok(result.value());
+			detail::FlagMatch<FlagStorage> find_long(std::string_view name) const {
+				const auto *abbreviations = this->abbreviations() ? &command.flag_names_.get(command.flags_) : nullptr;
+				const auto found = detail::lookup_name(command.flags_, abbreviations, name);
+				if (found.index == detail::NameTable<FlagStorage>::npos) {
+					return {{}, nullptr, found.ambiguous};
 				}
+				const auto &entry = command.flags_.at(found.index);
+				return {entry.key, &entry.value};
 			}
 
-			if (after_double_dash || (arg.empty() || arg[0] != '-')) {
-				if (pos_index >= positionals_.size()) {
-					return Result<size_t>::ok(i);
+			detail::FlagMatch<FlagStorage> find_short(std::string_view name) const {
+				const auto index = command.short_index_->find(name);
+				if (index == detail::ShortNameIndex::npos) {
+					return {};
 				}
+				const auto &entry = command.flags_.at(index);
+				return {entry.key, &entry.value};
+			}
 
-				auto result = positionals_[pos_index].set_value(arg);
-				if (! result) {
-					return Result<size_t>::err(result.error());
-				}
-				++pos_index;
-				++i;
-				continue;
+			static bool is_boolean(const FlagStorage &flag) noexcept {
+				return flag.is_boolean();
 			}
 
-			std::string flag_name;
-			std::string flag_value;
-			bool has_value = false;
-
-			if (arg.starts_with("--")) {
-				size_t eq_pos = arg.find('=');
-				if (eq_pos != std::string::npos) {
-					flag_name = arg.substr(2, eq_pos - 2);
-					flag_value = arg.substr(eq_pos + 1);
-					has_value = true;
-				} else {
-					flag_name = arg.substr(2);
-				}
-			} else if (arg.starts_with("-")) {
-				std::string short_name = arg.substr(1);
-				auto it = short_to_long_.find(short_name);
-				if (it != short_to_long_.end()) {
-					flag_name = it->second;
-				} else {
-					if (fallthrough_) {
-						// Unknown flag with fallthrough - let parent handle it
-						return Result<size_t>::ok(i);
-					}
-					return Result<size_t>::err(Error::unknown_flag(arg));
-				}
+			bool fallthrough() const noexcept {
+				return command.fallthrough_;
 			}
 
-			if (flag_name == "help") {
-				help_requested_ = true;
+			std::string_view suggest_long(std::string_view name) const {
+				return detail::closest_name(command.flags_, command.flag_names_.get(command.flags_), name);
 			}
 
-			auto flag_it = flags_.find(flag_name);
-			if (flag_it == flags_.end()) {
-				if (fallthrough_) {
-					return Result<size_t>::ok(i);
+			Result<void> set_flag(std::string_view name, const FlagStorage &flag, std::string_view value) const {
+				if (name == "help") {
+					command.help_requested_ = true;
 				}
-				return Result<size_t>::err(Error::unknown_flag(arg));
+				return flag.set_value(value, trace);
 			}
 
-			bool is_boolean_flag = flag_it->second.is_boolean();
+			Result<bool> positional(std::string_view arg) {
+				if (pos_index >= command.positionals_.size()) {
+					at_rest = command.rest_name_.has_value();
+					return Result<bool>::ok(false);
+				}
+				auto result = command.positionals_[pos_index].set_value(arg, trace);
+				if (! result) {
+					return Result<bool>::err(result.error());
+				}
+				++pos_index;
+				return Result<bool>::ok(true);
+			}
 
-			if (! has_value && i + 1 < args.size() && ! args[i + 1].starts_with("-")) {
-				std::string_view next_arg = args[i + 1];
+			Result<std::optional<size_t>> subcommand(std::string_view arg, size_t next_index) {
+				using Outcome = Result<std::optional<size_t>>;
 
-				if (! is_boolean_flag) {
-					flag_value = args[++i];
-					has_value = true;
-				} else {
-					if (next_arg == "true" || next_arg == "false" || next_arg == "1" || next_arg == "0" ||
-						next_arg == "yes" || next_arg == "no" || next_arg == "on" || next_arg == "off") {
-						flag_value = args[++i];
-						has_value = true;
-					}
+				const auto *abbreviations = this->abbreviations() ? &command.subcommand_names_.get(command.subcommands_) : nullptr;
+				const auto found = detail::lookup_name(command.subcommands_, abbreviations, arg);
+				if (found.index == detail::NameTable<std::unique_ptr<Subcommand>>::npos) {
+					return Outcome::ok(std::nullopt);
 				}
-			}
 
-			if (! has_value && is_boolean_flag) {
-				flag_value = "true";
-				has_value = true;
-			}
+				const auto &entry = command.subcommands_.at(found.index);
+				command.selected_subcommand_ = entry.key;
+				auto &subcommand = *entry.value;
 
-			if (! has_value) {
-				return Result<size_t>::err(Error::missing_flag_value(flag_name));
-			}
+				auto result = subcommand.parse_args(args, next_index, trace);
+				if (! result) {
+					return Outcome::err(result.error());
+				}
 
-			auto result = flag_it->second.set_value(flag_value);
-			if (! result) {
-				return Result<size_t>::err(result.error());
+				subcommand.parsed_ = true;
+				if (subcommand.help_requested_) {
+					command.help_requested_ = true;
+				}
+
+				return Outcome::ok(result.value());
 			}
+		};
 
-			++i;
+		if (auto env = detail::apply_environment(flags_, trace); ! env) {
+			return Result<size_t>::err(env.error());
 		}
 
-		return Result<size_t>::ok(i);
+		Handler handler{*this, args, trace};
+		auto consumed = detail::run_tokenizer(args, start_index, handler);
+		if (consumed && handler.at_rest) {
+			rest_ = args.subspan(consumed.value());
+			return Result<size_t>::ok(args.size());
+		}
+		return consumed;
 	}
 
 	Result<void> Subcommand::validate_requirements() const {
-		for (const auto &[name, flag]: flags_) {
-			if (flag.is_required() && ! flag.has_value()) {
-				return Result<void>::err(Error::missing_required_flag(name));
+		if (! presence_->satisfied()) {
+			// Something is missing: find it the way users see it, flags in name order first.
+			for (const auto &[name, flag]: flags_.sorted()) {
+				if (flag.is_required() && ! flag.has_value()) {
+					return Result<void>::err(Error::missing_required_flag(name));
+				}
 			}
-		}
 
-		for (const auto &pos: positionals_) {
-			if (pos.is_required() && ! pos.has_value()) {
-				return Result<void>::err(Error::missing_required_positional(pos.get_name()));
+			for (const auto &pos: positionals_) {
+				if (pos.is_required() && ! pos.has_value()) {
+					return Result<void>::err(Error::missing_required_positional(pos.get_name()));
+				}
 			}
 		}
 
+		if (selected_subcommand_.has_value()) {
+			if (const auto *sub = subcommands_.find(*selected_subcommand_); sub != nullptr) {
+				return (*sub)->validate_requirements();
+			}
+		}
 		return Result<void>::ok();
 	}
 
-	std::string Subcommand::format_flag_for_help(const FlagStorage &flag, const std::string &long_name) const {
-		std::ostringstream oss;
+	MemoryStats Subcommand::memory_stats() const {
+		MemoryStats stats;
+		for (const auto &[name, flag]: flags_) {
+			stats.strings += detail::heap_bytes(name);
+			flag.add_memory(stats);
+		}
+		for (const auto &pos: positionals_) {
+			pos.add_memory(stats);
+		}
+		for (const auto &entry: positional_index_) {
+			stats.strings += detail::heap_bytes(entry.key);
+		}
 
-		oss << "    ";
-		std::string short_name = flag.get_short_name();
-		if (! short_name.empty()) {
-			oss << "-" << short_name << ", ";
-		} else {
-			oss << "    ";
+		stats.tables += flags_.heap_bytes() + sizeof(detail::ShortNameIndex) + short_index_->heap_bytes();
+		stats.tables += sizeof(detail::CommandPresence) + presence_->heap_bytes();
+		stats.tables += positionals_.capacity() * sizeof(PositionalStorage) + positional_index_.heap_bytes() + subcommands_.heap_bytes();
+		stats.tables += flag_names_.heap_bytes() + subcommand_names_.heap_bytes();
+
+		stats.strings += detail::heap_bytes(name_) + detail::heap_bytes(description_) + detail::heap_bytes(rest_name_);
+		stats.strings += help_cache_[0].heap_bytes() + help_cache_[1].heap_bytes();
+#ifndef CPPLI_MINIMAL
+		stats.strings += examples_.capacity() * sizeof(Example);
+		for (const auto &example: examples_) {
+			stats.strings += detail::heap_bytes(example.description) + detail::heap_bytes(example.command);
 		}
+#endif
 
-		oss << "--" << long_name;
+		stats.values += detail::heap_bytes(selected_subcommand_);
+		detail::count_function(stats, callback_);
+		detail::count_function(stats, factory_);
 
-		if (flag.is_required()) {
-			oss << " (required)";
+		for (const auto &[name, sub]: subcommands_) {
+			stats.strings += detail::heap_bytes(name);
+			const MemoryStats child = sub->memory_stats();
+			stats.subcommands += sizeof(Subcommand) + child.total();
+			stats.function_targets += child.function_targets;
 		}
+		return stats;
+	}
+
+	std::unique_ptr<detail::SpecCommand> Subcommand::freeze() const {
+		auto command = std::make_unique<detail::SpecCommand>();
+		command->name = name_;
+		command->fallthrough = fallthrough_;
+		command->rest = rest_name_.has_value();
+		command->abbreviations = parent_ != nullptr && parent_->abbreviations_allowed();
 
-		return oss.str();
+		for (const auto &[name, flag]: flags_) {
+			command->add_flag(name, flag);
+		}
+		for (const auto &pos: positionals_) {
+			command->add_positional(pos);
+		}
+		for (const auto &[name, sub]: subcommands_) {
+			sub->materialize();
+			command->subcommands.insert_or_assign(name, sub->freeze());
+		}
+		command->finish();
+
+		return command;
 	}
 
 	std::string Subcommand::get_command_chain() const {
-		std::vector<std::string> chain;
+		std::vector<const std::string *> chain;
 
 		const Subcommand *current = this;
 		while (current != nullptr) {
-			chain.push_back(current->name_);
+			chain.push_back(&current->name_);
 			current = current->parent_subcommand_;
 		}
 
 		if (parent_ != nullptr) {
-			chain.push_back(parent_->app_name());
+			chain.push_back(&parent_->app_name());
 		}
 
-		std::reverse(chain.begin(), chain.end());
-
-		std::ostringstream oss;
-
-		for (size_t i = 0; i < chain.size(); ++i) {
-			if (i > 0) {
-				oss << " ";
+		std::string result;
+		for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+			if (! result.empty()) {
+				result += ' ';
 			}
-
-			oss << chain[i];
+			result += **it;
 		}
 
-		return oss.str();
+		return result;
 	}
 
 	std::string Subcommand::generate_help(bool full_chain) const {
-		std::ostringstream oss;
-		std::string command_name = full_chain ? get_command_chain() : name_;
+		return help_text(full_chain);
+	}
 
-		{
-			ColorGuard guard(oss, BOLD);
-			oss << command_name;
-		}
-		oss << "\n";
+	const std::string &Subcommand::help_text(bool full_chain) const {
+		return help_cache_[full_chain ? 1 : 0].get(revision_ + short_index_->revision(), [this, full_chain](std::string &out) {
+			render_help(out, full_chain);
+		});
+	}
 
+	void Subcommand::render_help(std::string &out, bool full_chain) const {
+		detail::append_styled(out, detail::ansi_bold, full_chain ? get_command_chain() : name_);
+		out += '\n';
+
+#ifndef CPPLI_MINIMAL
 		if (! description_.empty()) {
-			oss << description_ << "\n";
+			out += description_;
+			out += '\n';
 		}
+#endif
 
-		oss << "\nUSAGE:\n";
-		oss << "    " << name_ << " [OPTIONS]";
-
-		for (const auto &pos: positionals_) {
-			if (pos.is_required()) {
-				oss << " <" << pos.get_name() << ">";
-			} else {
-				oss << " [" << pos.get_name() << "]";
-			}
-		}
+		out += "\nUSAGE:\n    ";
+		out += name_;
+		out += " [OPTIONS]";
+		detail::append_usage_positionals(out, positionals_);
+		detail::append_usage_rest(out, rest_name_);
 
 		if (! subcommands_.empty()) {
-			oss << " [SUBCOMMAND]";
+			out += " [SUBCOMMAND]";
 		}
+		out += "\n\n";
 
-		oss << "\n\n";
-
-		if (! flags_.empty()) {
-			oss << "OPTIONS:\n";
-			for (const auto &[name, flag]: flags_) {
-				oss << format_flag_for_help(flag, name) << "\n";
-				std::string desc = flag.get_description();
-				if (! desc.empty()) {
-					oss << "        " << desc << "\n";
-				}
-			}
-			oss << "\n";
-		}
+#ifndef CPPLI_MINIMAL
+		detail::append_options(out, flags_);
 
 		if (! subcommands_.empty()) {
-			oss << "SUBCOMMANDS:\n";
-			for (const auto &[name, sub]: subcommands_) {
-				oss << "    " << name;
-				if (! sub->description_.empty()) {
-					oss << " - " << sub->description_;
-				}
-				oss << "\n";
-			}
-			oss << "\n";
+			detail::append_subcommand_list(out, subcommands_);
 		}
 
-		if (! examples_.empty()) {
-			oss << "EXAMPLES:\n";
-			for (const auto &example: examples_) {
-				oss << "  " << example.description << "\n";
-				oss << "    $ ";
-				ColorGuard guard(oss, GREEN);
-				oss << example.command << "\n\n";
-			}
-		}
-
-		return oss.str();
+		detail::append_examples(out, examples_);
+#endif
 	}
 
 	void Subcommand::print_help(std::ostream &os, bool full_chain) const {
-		os << generate_help(full_chain);
+		const std::string &text = help_text(full_chain);
+		os.write(text.data(), static_cast<std::streamsize>(text.size()));
+	}
+
+	void Subcommand::write_help(std::FILE *stream, bool full_chain) const {
+		detail::write_text(stream, help_text(full_chain));
+	}
+
+	void Subcommand::reset() {
+		for (const auto &[name, flag]: flags_) {
+			flag.reset();
+		}
+		for (const auto &pos: positionals_) {
+			pos.reset();
+		}
+		for (const auto &[name, sub]: subcommands_) {
+			sub->reset();
+		}
+		selected_subcommand_.reset();
+		rest_ = {};
+		parsed_ = false;
+		help_requested_ = false;
 	}
 
 	void Subcommand::invoke_callback() const {
@@ -1,10 +1,253 @@
+#include <array>
 #include <charconv>
+#include <cmath>
 #include <cppli_error.hpp>
 #include <cppli_types.hpp>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <system_error>
 
 namespace cli {
+	namespace {
+		/**
+		 * @brief A number split into integer digits and fraction digits, e.g. "1.25" -> {1, 25, 100}.
+		 */
+		struct DecimalNumber {
+			std::uint64_t whole = 0;
+			std::uint64_t fraction = 0;
+			std::uint64_t fraction_scale = 1;///< 10^(fraction digits kept)
+		};
+
+		constexpr bool is_digit(char c) noexcept {
+			return c >= '0' && c <= '9';
+		}
+
+		constexpr char to_lower(char c) noexcept {
+			return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+		}
+
+		bool iequals(std::string_view a, std::string_view b) noexcept {
+			if (a.size() != b.size()) {
+				return false;
+			}
+			for (std::size_t i = 0; i < a.size(); ++i) {
+				if (to_lower(a[i]) != to_lower(b[i])) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Read a non-negative decimal number from the front of str and advance past it.
+		 *
+		 * Fraction digits beyond the 18th are ignored. Returns false if there are
+		 * no digits before or after the point, or the integer part overflows.
+		 */
+		bool consume_decimal(std::string_view &str, DecimalNumber &number) {
+			const char *begin = str.data();
+			const char *end = begin + str.size();
+
+			const char *cursor = begin;
+			const bool has_whole_digits = cursor != end && is_digit(*cursor);
+			if (has_whole_digits) {
+				auto [ptr, ec] = std::from_chars(cursor, end, number.whole);
+				if (ec != std::errc()) {
+					return false;
+				}
+				cursor = ptr;
+			}
+
+			bool has_fraction_digits = false;
+			if (cursor != end && *cursor == '.') {
+				++cursor;
+				while (cursor != end && is_digit(*cursor)) {
+					if (number.fraction_scale < 1'000'000'000'000'000'000ULL) {
+						number.fraction = number.fraction * 10 + static_cast<std::uint64_t>(*cursor - '0');
+						number.fraction_scale *= 10;
+					}
+					has_fraction_digits = true;
+					++cursor;
+				}
+			}
+
+			if (! has_whole_digits && ! has_fraction_digits) {
+				return false;
+			}
+
+			str.remove_prefix(static_cast<std::size_t>(cursor - begin));
+			return true;
+		}
+
+		/**
+		 * @brief number * unit, rounded to the nearest integer; false on overflow.
+		 */
+		bool scale_decimal(const DecimalNumber &number, std::uint64_t unit, std::uint64_t &out) {
+			constexpr auto max = std::numeric_limits<std::uint64_t>::max();
+			if (unit != 0 && number.whole > max / unit) {
+				return false;
+			}
+			std::uint64_t result = number.whole * unit;
+
+			if (number.fraction != 0) {
+				const long double part = std::round(static_cast<long double>(number.fraction) / static_cast<long double>(number.fraction_scale) * static_cast<long double>(unit));
+				if (part >= static_cast<long double>(max - result)) {
+					return false;
+				}
+				result += static_cast<std::uint64_t>(part);
+			}
+
+			out = result;
+			return true;
+		}
+
+		struct Unit {
+			std::string_view name;
+			std::uint64_t scale;
+		};
+
+		constexpr std::array<Unit, 9> duration_units{{
+			{"ns", 1},
+			{"us", 1'000},
+			{"\u00b5s", 1'000},
+			{"ms", 1'000'000},
+			{"s", 1'000'000'000},
+			{"m", 60'000'000'000},
+			{"min", 60'000'000'000},
+			{"h", 3'600'000'000'000},
+			{"d", 86'400'000'000'000},
+		}};
+
+		constexpr std::uint64_t kib = 1024;
+
+		constexpr std::array<Unit, 20> byte_units{{
+			{"b", 1},
+			{"k", kib},
+			{"kib", kib},
+			{"kb", 1'000},
+			{"m", kib * kib},
+			{"mib", kib * kib},
+			{"mb", 1'000'000},
+			{"g", kib * kib * kib},
+			{"gib", kib * kib * kib},
+			{"gb", 1'000'000'000},
+			{"t", kib * kib * kib * kib},
+			{"tib", kib * kib * kib * kib},
+			{"tb", 1'000'000'000'000},
+			{"p", kib * kib * kib * kib * kib},
+			{"pib", kib * kib * kib * kib * kib},
+			{"pb", 1'000'000'000'000'000},
+			{"e", kib * kib * kib * kib * kib * kib},
+			{"eib", kib * kib * kib * kib * kib * kib},
+			{"eb", 1'000'000'000'000'000'000},
+			{"", 1},
+		}};
+	}// namespace
+
+	namespace detail {
+		Result<std::chrono::nanoseconds> parse_duration(std::string_view str, std::int64_t bare_unit_ns) {
+			using Nanos = std::chrono::nanoseconds;
+			const auto invalid = [] {
+				return Result<Nanos>::err(Error(ErrorCode::InvalidFlagValue, "Invalid duration format"));
+			};
+			const auto out_of_range = [] {
+				return Result<Nanos>::err(Error(ErrorCode::InvalidFlagValue, "Duration out of range"));
+			};
+
+			bool negative = false;
+			if (! str.empty() && (str.front() == '-' || str.front() == '+')) {
+				negative = str.front() == '-';
+				str.remove_prefix(1);
+			}
+			if (str.empty()) {
+				return invalid();
+			}
+
+			constexpr auto max = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+			std::uint64_t total = 0;
+			bool first = true;
+			while (! str.empty()) {
+				DecimalNumber number;
+				if (! consume_decimal(str, number)) {
+					return invalid();
+				}
+
+				std::size_t unit_length = 0;
+				while (unit_length < str.size() && ! is_digit(str[unit_length]) && str[unit_length] != '.') {
+					++unit_length;
+				}
+				const std::string_view unit_name = str.substr(0, unit_length);
+				str.remove_prefix(unit_length);
+
+				std::uint64_t unit = 0;
+				if (unit_name.empty()) {
+					if (! first || ! str.empty() || bare_unit_ns <= 0) {
+						return Result<Nanos>::err(Error(ErrorCode::InvalidFlagValue, "Missing duration unit"));
+					}
+					unit = static_cast<std::uint64_t>(bare_unit_ns);
+				} else {
+					for (const auto &candidate: duration_units) {
+						if (candidate.name == unit_name) {
+							unit = candidate.scale;
+							break;
+						}
+					}
+					if (unit == 0) {
+						return Result<Nanos>::err(Error(ErrorCode::InvalidFlagValue, "Unknown duration unit"));
+					}
+				}
+
+				std::uint64_t component = 0;
+				if (! scale_decimal(number, unit, component) || component > max - total) {
+					return out_of_range();
+				}
+				total += component;
+				first = false;
+			}
+
+			const auto count = static_cast<std::int64_t>(total);
+			return Result<Nanos>::ok(Nanos(negative ? -count : count));
+		}
+
+		Result<std::uint64_t> parse_byte_size(std::string_view str) {
+			DecimalNumber number;
+			if (! consume_decimal(str, number)) {
+				return Result<std::uint64_t>::err(Error(ErrorCode::InvalidFlagValue, "Invalid byte size format"));
+			}
+
+			for (const auto &unit: byte_units) {
+				if (iequals(unit.name, str)) {
+					std::uint64_t bytes = 0;
+					if (! scale_decimal(number, unit.scale, bytes)) {
+						return Result<std::uint64_t>::err(Error(ErrorCode::InvalidFlagValue, "Byte size out of range"));
+					}
+					return Result<std::uint64_t>::ok(bytes);
+				}
+			}
+
+			return Result<std::uint64_t>::err(Error(ErrorCode::InvalidFlagValue, "Unknown byte size unit"));
+		}
+
+		std::pair<std::uint64_t, std::string_view> byte_size_parts(std::uint64_t bytes) noexcept {
+			static constexpr std::array<std::string_view, 6> suffixes = {"KiB", "MiB", "GiB", "TiB", "PiB", "EiB"};
+
+			std::string_view suffix;
+			for (std::size_t i = 0; i < suffixes.size() && bytes != 0 && bytes % kib == 0; ++i) {
+				bytes /= kib;
+				suffix = suffixes[i];
+			}
+			return {bytes, suffix};
+		}
+
+		std::string byte_size_to_string(std::uint64_t bytes) {
+			const auto [count, suffix] = byte_size_parts(bytes);
+			std::string text = to_chars_string(count);
+			text += suffix;
+			return text;
+		}
+	}// namespace detail
+
 	Result<int> ValueConverter<int>::from_string(std::string_view str) {
 		int value{};
 		auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
@@ -134,3 +134,52 @@ TEST_CASE("Result copy and move semantics", "[error][result]") {
 		REQUIRE(result2.value() == 42);
 	}
 }
+
+TEST_CASE("Error lazy formatting", "[error]") {
+	SECTION("Arguments are kept and rendered on demand") {
+		auto err = Error::invalid_flag_value("port", "abc");
+		REQUIRE(err.argument(0) == "port");
+		REQUIRE(err.argument(1) == "abc");
+		REQUIRE(err.argument(2).empty());
+		REQUIRE(err.message() == "Invalid value for --port: abc");
+	}
+
+	SECTION("format_to writes into a caller buffer") {
+		auto err = Error::unknown_flag("--bogus");
+		char buffer[64];
+		char *end = err.format_to(buffer);
+		REQUIRE(std::string_view(buffer, end) == "Unknown flag: --bogus");
+	}
+
+	SECTION("Long arguments survive copies and the source going away") {
+		Error copy;
+		{
+			std::string value(200, 'x');
+			auto err = Error::invalid_flag_value("path", value);
+			copy = err;
+		}
+		REQUIRE(copy.argument(1) == std::string(200, 'x'));
+		REQUIRE_THAT(copy.message(), ContainsSubstring("--path: xxx"));
+	}
+
+	SECTION("Spilled arguments are shared by copies and released by moves") {
+		auto err = Error::config_error("settings.ini:12", "unknown key 'colour' (did you mean 'color'?)");
+		Error copy = err;
+		Error moved = std::move(err);
+		REQUIRE(err.argument(0).empty());
+		copy = moved;
+		moved = Error::unknown_flag("-x");
+		REQUIRE(copy.argument(0) == "settings.ini:12");
+		REQUIRE(moved.message() == "Unknown flag: -x");
+	}
+
+	SECTION("Errors and results stay small") {
+		STATIC_REQUIRE(sizeof(Error) <= 5 * sizeof(void *));
+		STATIC_REQUIRE(sizeof(Result<int>) <= sizeof(Error) + sizeof(void *));
+	}
+
+	SECTION("Custom messages are not treated as templates") {
+		Error err(ErrorCode::ValidationFailed, "expected {} braces");
+		REQUIRE(err.message() == "expected {} braces");
+	}
+}
@@ -0,0 +1,41 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cppli.hpp>
+
+using namespace cli;
+
+TEST_CASE("Minimal build", "[minimal]") {
+	SECTION("Parsing is unchanged") {
+		Parser parser("myapp", "My application");
+		parser.add_flag<int>("port", "Port number").set_short_name("p").set_default_value(80);
+		parser.add_flag<bool>("verbose", "Verbose output");
+		parser.add_positional<std::string>("file", "Input file");
+		parser.add_example("Serve a file", "myapp -p 8080 index.html");
+
+		std::vector<std::string> args = {"-p", "8080", "--verbose", "index.html"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(parser.get<int>("port") == 8080);
+		REQUIRE(parser.get<bool>("verbose") == true);
+		REQUIRE(parser.get_positional<std::string>(0) == "index.html");
+	}
+
+	SECTION("Descriptions are not stored") {
+		Parser parser("myapp");
+		auto &flag = parser.add_flag<int>("port", "Port number");
+		auto &pos = parser.add_positional<std::string>("file", "Input file");
+		auto &sub = parser.add_subcommand("serve", "Start the server");
+		REQUIRE(flag.description().empty());
+		REQUIRE(pos.description().empty());
+		REQUIRE(sub.description().empty());
+	}
+
+	SECTION("Help is the usage line only") {
+		Parser parser("myapp", "My application", "1.0");
+		parser.add_flag<int>("port", "Port number").set_required();
+		parser.add_positional<std::string>("file", "Input file");
+		parser.add_subcommand("serve", "Start the server");
+		parser.add_example("Serve a file", "myapp --port 8080 index.html");
+
+		const std::string help = parser.generate_help();
+		REQUIRE(help == "myapp v1.0\n\nUSAGE:\n    myapp [OPTIONS] <file> [SUBCOMMAND]\n\n");
+	}
+}
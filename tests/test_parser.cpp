@@ -1,6 +1,16 @@
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 #include <cppli.hpp>
+#include <cppli_response_file.hpp>
+#include <cppli_tokenizer.hpp>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
 
 using namespace cli;
 using Catch::Matchers::ContainsSubstring;
@@ -448,3 +458,1172 @@ TEST_CASE("Parser edge cases", "[parser]") {
 		REQUIRE(parser.get<bool>("active") == true);
 	}
 }
+
+TEST_CASE("Parser zero-copy parse overloads", "[parser]") {
+	SECTION("Parse from a span of string views") {
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port number").set_short_name("p");
+		parser.add_flag<std::string>("output", "Output file");
+		parser.add_positional<std::string>("input", "Input file");
+
+		std::vector<std::string_view> args = {"-p", "8080", "--output=out.txt", "in.txt"};
+		auto result = parser.parse(std::span<const std::string_view>(args));
+		REQUIRE(result.has_value());
+		REQUIRE(parser.get<int>("port") == 8080);
+		REQUIRE(parser.get<std::string>("output") == "out.txt");
+		REQUIRE(parser.get_positional<std::string>(0) == "in.txt");
+	}
+
+	SECTION("Parse from a span of C strings") {
+		Parser parser("myapp");
+		parser.add_flag<bool>("verbose", "Verbose").set_short_name("v");
+		parser.add_positional<std::string>("input", "Input file");
+
+		const char *args[] = {"-v", "in.txt"};
+		auto result = parser.parse(std::span<const char *const>(args));
+		REQUIRE(result.has_value());
+		REQUIRE(parser.get<bool>("verbose") == true);
+		REQUIRE(parser.get_positional<std::string>(0) == "in.txt");
+	}
+
+	SECTION("argc/argv skips the program name") {
+		Parser parser("myapp");
+		parser.add_flag<int>("count", "Count");
+
+		char prog[] = "myapp";
+		char flag[] = "--count";
+		char value[] = "3";
+		char *argv[] = {prog, flag, value, nullptr};
+		auto result = parser.parse(3, argv);
+		REQUIRE(result.has_value());
+		REQUIRE(parser.get<int>("count") == 3);
+	}
+
+	SECTION("Subcommand arguments are parsed from views") {
+		Parser parser("myapp");
+		auto &build = parser.add_subcommand("build", "Build the project");
+		build.add_flag<std::string>("target", "Build target").set_short_name("t");
+
+		std::vector<std::string_view> args = {"build", "-t", "release"};
+		auto result = parser.parse(std::span<const std::string_view>(args));
+		REQUIRE(result.has_value());
+		REQUIRE(parser.get_selected_subcommand() == "build");
+		REQUIRE(build.get<std::string>("target") == "release");
+	}
+}
+
+TEST_CASE("Parser flag table", "[parser]") {
+	SECTION("Lookup stays correct with many flags") {
+		Parser parser("myapp");
+		for (int i = 0; i < 300; ++i) {
+			parser.add_flag<int>("flag-" + std::to_string(i), "Generated flag");
+		}
+
+		std::vector<std::string> args = {"--flag-0", "0", "--flag-150", "150", "--flag-299=299"};
+		auto result = parser.parse(args);
+		REQUIRE(result.has_value());
+		REQUIRE(parser.get<int>("flag-0") == 0);
+		REQUIRE(parser.get<int>("flag-150") == 150);
+		REQUIRE(parser.get<int>("flag-299") == 299);
+		REQUIRE_FALSE(parser.has("flag-1"));
+		REQUIRE_FALSE(parser.has("flag-300"));
+	}
+
+	SECTION("Re-adding a flag replaces it") {
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port number").set_default_value(1);
+		parser.add_flag<int>("port", "Port number").set_default_value(2);
+		REQUIRE(parser.get<int>("port") == 2);
+	}
+
+	SECTION("Requirements follow values across parses") {
+		Parser parser("myapp");
+		for (int i = 0; i < 70; ++i) {
+			parser.add_flag<int>("flag-" + std::to_string(i), "Generated flag");
+		}
+		parser.add_flag<int>("flag-65", "Generated flag").set_required();
+		parser.add_positional<std::string>("file", "Input file");
+
+		std::vector<std::string> args = {"--flag-65", "1", "in.txt"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(parser.has("flag-65"));
+
+		parser.reset();
+		REQUIRE_FALSE(parser.has("flag-65"));
+		std::vector<std::string> missing_flag = {"in.txt"};
+		auto result = parser.parse(missing_flag);
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::MissingRequiredFlag);
+
+		parser.reset();
+		std::vector<std::string> missing_positional = {"--flag-65", "1"};
+		result = parser.parse(missing_positional);
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::MissingRequiredPositional);
+	}
+
+	SECTION("A default satisfies a required flag until it is replaced") {
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port number").set_required().set_default_value(80);
+		std::vector<std::string> none;
+		REQUIRE(parser.parse(none).has_value());
+
+		parser.add_flag<int>("port", "Port number").set_required();
+		parser.reset();
+		auto result = parser.parse(none);
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::MissingRequiredFlag);
+	}
+
+	SECTION("Help lists flags and subcommands alphabetically") {
+		Parser parser("myapp");
+		parser.add_flag<bool>("zeta", "Last");
+		parser.add_flag<bool>("alpha", "First");
+		parser.add_subcommand("push", "Push changes");
+		parser.add_subcommand("fetch", "Fetch changes");
+
+		std::string help = parser.generate_help();
+		REQUIRE(help.find("--alpha") < help.find("--zeta"));
+		REQUIRE(help.find("fetch") < help.find("push"));
+	}
+}
+
+TEST_CASE("Parser type-erased storage", "[parser]") {
+	SECTION("Positional with wrong type returns nullopt") {
+		Parser parser("myapp");
+		parser.add_positional<int>("count", "Count");
+
+		std::vector<std::string> args = {"5"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(parser.get_positional<int>(0) == 5);
+		REQUIRE_FALSE(parser.get_positional<std::string>(0).has_value());
+		REQUIRE_FALSE(parser.get_positional<std::string>("count").has_value());
+	}
+
+	SECTION("Flag references survive later registrations") {
+		Parser parser("myapp");
+		auto &first = parser.add_flag<int>("first", "First flag");
+		for (int i = 0; i < 100; ++i) {
+			parser.add_flag<bool>("extra-" + std::to_string(i), "Extra flag");
+		}
+
+		std::vector<std::string> args = {"--first", "7"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(first.value() == 7);
+	}
+}
+
+TEST_CASE("Parser short-name index", "[parser]") {
+	SECTION("Renaming a short name takes effect immediately") {
+		Parser parser("myapp");
+		auto &flag = parser.add_flag<int>("count", "Count").set_short_name("c");
+		flag.set_short_name("n");
+
+		std::vector<std::string> old_name = {"-c", "1"};
+		REQUIRE(parser.parse(old_name).error().code() == ErrorCode::UnknownFlag);
+
+		std::vector<std::string> new_name = {"-n", "2"};
+		REQUIRE(parser.parse(new_name).has_value());
+		REQUIRE(parser.get<int>("count") == 2);
+	}
+
+	SECTION("Multi-character short names") {
+		Parser parser("myapp");
+		parser.add_flag<bool>("no-color", "Disable color").set_short_name("nc");
+
+		std::vector<std::string> args = {"-nc"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(parser.get<bool>("no-color") == true);
+	}
+
+	SECTION("Replacing a flag drops its old short name") {
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port").set_short_name("p");
+		parser.add_flag<int>("port", "Port");
+
+		std::vector<std::string> args = {"-p", "1"};
+		REQUIRE(parser.parse(args).error().code() == ErrorCode::UnknownFlag);
+	}
+
+	SECTION("Subcommand short names") {
+		Parser parser("myapp");
+		auto &sub = parser.add_subcommand("run", "Run");
+		sub.add_flag<int>("jobs", "Jobs").set_short_name("j");
+		sub.add_help_flag();
+
+		std::vector<std::string> args = {"run", "-j", "4"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(sub.get<int>("jobs") == 4);
+	}
+}
+
+namespace {
+	std::string write_response_file(const std::string &name, const std::string &contents) {
+		const auto path = std::filesystem::temp_directory_path() / name;
+		std::ofstream(path, std::ios::binary) << contents;
+		return path.string();
+	}
+}// namespace
+
+TEST_CASE("Parser response files", "[parser]") {
+	SECTION("Tokens from @file are parsed in place") {
+		const std::string path = write_response_file("cppli_test_args.txt", "--port 8080\n--name 'hello world'\n");
+
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port");
+		parser.add_flag<std::string>("name", "Name");
+		parser.add_flag<bool>("verbose", "Verbose");
+
+		std::vector<std::string> args = {"@" + path, "--verbose"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(parser.get<int>("port") == 8080);
+		REQUIRE(parser.get<std::string>("name") == "hello world");
+		REQUIRE(parser.get<bool>("verbose") == true);
+	}
+
+	SECTION("Subcommands and nested response files") {
+		const std::string inner = write_response_file("cppli_test_inner.txt", "-j 4");
+		const std::string outer = write_response_file("cppli_test_outer.txt", "run @" + inner);
+
+		Parser parser("myapp");
+		auto &sub = parser.add_subcommand("run", "Run");
+		sub.add_flag<int>("jobs", "Jobs").set_short_name("j");
+
+		std::vector<std::string> args = {"@" + outer};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(parser.get_selected_subcommand() == "run");
+		REQUIRE(sub.get<int>("jobs") == 4);
+	}
+
+	SECTION("Unreadable files and arguments after -- stay literal") {
+		Parser parser("myapp");
+		parser.add_positional<std::string>("first", "First", false);
+		parser.add_positional<std::string>("second", "Second", false);
+
+		std::vector<std::string> args = {"@/nonexistent/cppli_missing", "--", "@also_literal"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(parser.get_positional<std::string>(0) == "@/nonexistent/cppli_missing");
+		REQUIRE(parser.get_positional<std::string>(1) == "@also_literal");
+	}
+
+	SECTION("Self-referencing response file is an error") {
+		const std::string path = (std::filesystem::temp_directory_path() / "cppli_test_loop.txt").string();
+		write_response_file("cppli_test_loop.txt", "@" + path);
+
+		Parser parser("myapp");
+		std::vector<std::string> args = {"@" + path};
+		auto result = parser.parse(args);
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::ResponseFileError);
+	}
+
+	SECTION("Shell-style quoting") {
+		std::pmr::deque<std::pmr::string> scratch;
+		const std::string_view text = R"(plain 'single quoted' "double \"esc\"" back\ slash mix'ed'"up" "")";
+		detail::ResponseFileTokenizer tokenizer(text, scratch);
+
+		std::vector<std::string> tokens;
+		while (auto token = tokenizer.next()) {
+			tokens.emplace_back(*token);
+		}
+
+		REQUIRE(tokens == std::vector<std::string>{"plain", "single quoted", "double \"esc\"", "back slash", "mixedup", ""});
+		REQUIRE(scratch.size() == 3);
+	}
+}
+
+TEST_CASE("Parser repeatable flags", "[parser]") {
+	SECTION("Occurrences and comma-separated values append") {
+		Parser parser("myapp");
+		parser.add_flag<std::string>("include", "Include path").set_short_name("I").set_multi();
+
+		std::vector<std::string> args = {"-I", "a", "--include=b,c", "--include", "d"};
+		REQUIRE(parser.parse(args).has_value());
+
+		const auto values = parser.get_all<std::string>("include");
+		REQUIRE(std::vector<std::string>(values.begin(), values.end()) == std::vector<std::string>{"a", "b", "c", "d"});
+		REQUIRE(parser.get<std::string>("include") == "d");
+	}
+
+	SECTION("Default is used only when absent") {
+		Parser parser("myapp");
+		parser.add_flag<int>("level", "Level").set_multi().set_default_value(1);
+
+		REQUIRE(parser.parse(std::vector<std::string>{}).has_value());
+		REQUIRE(parser.get_all<int>("level").size() == 1);
+		REQUIRE(parser.get_all<int>("level")[0] == 1);
+
+		Parser given("myapp");
+		given.add_flag<int>("level", "Level").set_multi().set_default_value(1);
+		REQUIRE(given.parse(std::vector<std::string>{"--level", "2,3"}).has_value());
+		REQUIRE(given.get_all<int>("level").size() == 2);
+		REQUIRE(given.get_all<int>("level")[0] == 2);
+	}
+
+	SECTION("Each value is converted and validated") {
+		Parser parser("myapp");
+		parser.add_flag<int>("id", "Id").set_multi().set_choices({1, 2});
+
+		auto bad_type = parser.parse(std::vector<std::string>{"--id", "1,x"});
+		REQUIRE(bad_type.error().code() == ErrorCode::InvalidFlagValue);
+
+		Parser choices("myapp");
+		choices.add_flag<int>("id", "Id").set_multi().set_choices({1, 2});
+		auto bad_choice = choices.parse(std::vector<std::string>{"--id", "1,3"});
+		REQUIRE(bad_choice.error().code() == ErrorCode::ValidationFailed);
+	}
+
+	SECTION("Delimiter can be changed or disabled") {
+		Parser parser("myapp");
+		parser.add_flag<std::string>("tag", "Tag").set_multi().set_delimiter('\0');
+		parser.add_flag<std::string>("path", "Path").set_multi().set_delimiter(':');
+
+		REQUIRE(parser.parse(std::vector<std::string>{"--tag", "a,b", "--path", "x:y"}).has_value());
+		REQUIRE(parser.get_all<std::string>("tag").size() == 1);
+		REQUIRE(parser.get_all<std::string>("path").size() == 2);
+	}
+
+	SECTION("Non-repeatable flags and wrong types give an empty span") {
+		Parser parser("myapp");
+		parser.add_flag<std::string>("name", "Name");
+		parser.add_flag<int>("n", "N").set_multi();
+
+		REQUIRE(parser.parse(std::vector<std::string>{"--name", "a", "--n", "1"}).has_value());
+		REQUIRE(parser.get_all<std::string>("name").empty());
+		REQUIRE(parser.get_all<std::string>("n").empty());
+		REQUIRE(parser.get_all<int>("missing").empty());
+	}
+
+	SECTION("Help marks repeatable flags") {
+		Parser parser("myapp");
+		parser.add_flag<std::string>("include", "Include path").set_multi();
+		REQUIRE_THAT(parser.generate_help(), ContainsSubstring("--include (repeatable)"));
+	}
+}
+
+TEST_CASE("Parser cached help output", "[parser]") {
+	SECTION("Help is re-rendered after the definition changes") {
+		Parser parser("myapp");
+		auto &port = parser.add_flag<int>("port", "Port number");
+		std::string before = parser.generate_help();
+		REQUIRE(parser.generate_help() == before);
+
+		port.set_short_name("p");
+		REQUIRE_THAT(parser.generate_help(), ContainsSubstring("-p, --port"));
+		port.set_required();
+		REQUIRE_THAT(parser.generate_help(), ContainsSubstring("--port (required)"));
+
+		parser.add_positional<std::string>("file", "Input file");
+		parser.add_example("Serve", "myapp -p 80 index.html");
+		parser.add_subcommand("serve", "Start serving");
+		parser.require_subcommand();
+
+		std::string help = parser.generate_help();
+		REQUIRE_THAT(help, ContainsSubstring("<file>"));
+		REQUIRE_THAT(help, ContainsSubstring("myapp -p 80 index.html"));
+		REQUIRE_THAT(help, ContainsSubstring("<SUBCOMMAND>"));
+	}
+
+	SECTION("format_to and write_help produce the same text as generate_help") {
+		Parser parser("myapp", "Test application", "1.0.0");
+		parser.add_flag<std::string>("output", "Output file").set_short_name("o");
+		parser.add_help_flag();
+		auto &sub = parser.add_subcommand("build", "Build it");
+		sub.add_flag<bool>("release", "Release mode");
+
+		std::string formatted;
+		parser.format_to(std::back_inserter(formatted));
+		REQUIRE(formatted == parser.generate_help());
+
+		std::string sub_formatted;
+		sub.format_to(std::back_inserter(sub_formatted), false);
+		REQUIRE(sub_formatted == sub.generate_help(false));
+
+		std::FILE *file = std::tmpfile();
+		REQUIRE(file != nullptr);
+		parser.write_help(file);
+		std::rewind(file);
+		std::string written(formatted.size() + 1, '\0');
+		written.resize(std::fread(written.data(), 1, written.size(), file));
+		std::fclose(file);
+		REQUIRE(written == formatted);
+	}
+
+	SECTION("Subcommand help tracks its own changes") {
+		Parser parser("myapp");
+		auto &sub = parser.add_subcommand("build", "Build it");
+		REQUIRE_THAT(sub.generate_help(), ContainsSubstring("myapp build"));
+
+		sub.add_flag<std::string>("target", "Target").set_multi();
+		sub.add_subcommand("clean", "Clean first");
+		std::string help = sub.generate_help();
+		REQUIRE_THAT(help, ContainsSubstring("--target (repeatable)"));
+		REQUIRE_THAT(help, ContainsSubstring("clean - Clean first"));
+	}
+}
+
+TEST_CASE("Parser enum choices", "[parser]") {
+	enum class Mode { Fast, Safe };
+
+	Parser parser("myapp");
+	parser.add_flag<Mode>("mode", "Mode").set_choices<Mode>({{"fast", Mode::Fast}, {"safe", Mode::Safe}});
+
+	REQUIRE(parser.parse(std::vector<std::string>{"--mode", "safe"}).has_value());
+	REQUIRE(parser.get<Mode>("mode") == Mode::Safe);
+
+	auto spec = parser.freeze();
+	std::vector<std::string_view> args = {"--mode=fast"};
+	auto result = spec.parse(args);
+	REQUIRE(result.has_value());
+	REQUIRE(result.value().get<Mode>("mode") == Mode::Fast);
+
+	std::vector<std::string_view> bad = {"--mode", "slow"};
+	REQUIRE_FALSE(spec.parse(bad).has_value());
+}
+
+TEST_CASE("Parser observer", "[parser]") {
+	SECTION("ParseStats counts conversions and rejected values") {
+		Parser parser("myapp");
+		parser.add_flag<int>("count", "Count").set_validator([](const int &v) {
+			return v > 0 ? Result<void>::ok() : Result<void>::err(Error::validation_failed("--count", "must be positive"));
+		});
+		parser.add_positional<std::string>("input", "Input");
+
+		ParseStats stats;
+		parser.set_observer(&stats);
+
+		REQUIRE(parser.parse(std::vector<std::string>{"--count", "3", "in.txt"}).has_value());
+		REQUIRE(stats[ParseStage::Parse].count == 1);
+		REQUIRE(stats[ParseStage::Convert].count == 2);
+		REQUIRE(stats[ParseStage::Validate].count == 1);// the positional has no validator
+		REQUIRE(stats[ParseStage::Requirements].count == 1);
+		REQUIRE(stats.validation_failures() == 0);
+
+		stats.reset();
+		REQUIRE_FALSE(parser.parse(std::vector<std::string>{"--count", "0"}).has_value());
+		REQUIRE(stats[ParseStage::Validate].failures == 1);
+		REQUIRE(stats[ParseStage::Parse].failures == 1);
+		REQUIRE(stats.validation_failures() == 1);
+	}
+
+	SECTION("Subcommands report to the parent observer unless they have their own") {
+		Parser parser("myapp");
+		bool ran = false;
+		auto &build = parser.add_subcommand("build", "Build it").set_callback([&] { ran = true; });
+		build.add_flag<int>("jobs", "Jobs");
+
+		ParseStats stats;
+		parser.set_observer(&stats);
+		REQUIRE(parser.parse(std::vector<std::string>{"build", "--jobs", "4"}).has_value());
+		REQUIRE(ran);
+		REQUIRE(stats[ParseStage::Subcommand].count == 1);
+		REQUIRE(stats[ParseStage::Convert].count == 1);
+		REQUIRE(stats[ParseStage::Callback].count == 1);
+
+		ParseStats own;
+		build.set_observer(&own);
+		stats.reset();
+		REQUIRE(parser.parse(std::vector<std::string>{"build", "--jobs", "4"}).has_value());
+		REQUIRE(stats[ParseStage::Parse].count == 1);
+		REQUIRE(stats[ParseStage::Convert].count == 0);
+		REQUIRE(own[ParseStage::Convert].count == 1);
+		REQUIRE(own[ParseStage::Callback].count == 1);
+	}
+
+	SECTION("Custom observers see command names and allocation deltas") {
+		// Pretends each conversion allocates five times, so enclosing stages see the delta.
+		struct Recorder : ParseObserver {
+			std::uint64_t counter = 0;
+			std::vector<std::string> names;
+			std::uint64_t parse_allocations = 0;
+
+			void on_stage_end(const ParseEvent &event) override {
+				names.push_back(std::string(to_string(event.stage)) + ":" + std::string(event.command) + ":" + std::string(event.name));
+				if (event.stage == ParseStage::Convert) {
+					counter += 5;
+				} else if (event.stage == ParseStage::Parse) {
+					parse_allocations = event.allocations;
+				}
+			}
+			std::uint64_t allocation_count() const noexcept override {
+				return counter;
+			}
+		};
+
+		Parser parser("myapp");
+		parser.add_flag<int>("level", "Level");
+		parser.add_flag<int>("depth", "Depth");
+		Recorder recorder;
+		parser.set_observer(&recorder);
+
+		REQUIRE(parser.parse(std::vector<std::string>{"--level", "2", "--depth", "3"}).has_value());
+		REQUIRE(std::ranges::count(recorder.names, std::string("convert:myapp:level")) == 1);
+		REQUIRE(std::ranges::count(recorder.names, std::string("convert:myapp:depth")) == 1);
+		REQUIRE(recorder.names.back() == "parse:myapp:");
+		REQUIRE(recorder.parse_allocations == 10);
+	}
+}
+
+TEST_CASE("Parser lazy subcommands", "[parser]") {
+	int built = 0;
+	Parser parser("myapp");
+	parser.add_lazy_subcommand("build", "Build it", [&](Subcommand &build) {
+		++built;
+		build.add_flag<int>("jobs", "Jobs").set_default_value(1);
+		build.add_lazy_subcommand("docs", "Build the docs", [&](Subcommand &docs) {
+			++built;
+			docs.add_flag<bool>("open", "Open in a browser");
+		});
+	});
+	parser.add_lazy_subcommand("clean", "Remove outputs", [&](Subcommand &) { ++built; });
+
+	SECTION("Help lists lazy subcommands without defining them") {
+		std::string help = parser.generate_help();
+		REQUIRE_THAT(help, ContainsSubstring("build - Build it"));
+		REQUIRE_THAT(help, ContainsSubstring("clean - Remove outputs"));
+		REQUIRE(built == 0);
+	}
+
+	SECTION("Only the selected path is defined") {
+		REQUIRE(parser.parse(std::vector<std::string>{"build", "--jobs", "4"}).has_value());
+		REQUIRE(built == 1);
+		REQUIRE(parser.get_selected_subcommand() == "build");
+		REQUIRE(parser.get_subcommand("build")->get<int>("jobs") == 4);
+
+		REQUIRE(parser.parse(std::vector<std::string>{"build", "docs", "--open"}).has_value());
+		REQUIRE(built == 2);
+		REQUIRE(parser.get_subcommand("build")->get_subcommand("docs")->has("open"));
+	}
+
+	SECTION("get_subcommand and freeze define the subcommand once") {
+		auto *clean = parser.get_subcommand("clean");
+		REQUIRE(clean != nullptr);
+		REQUIRE(built == 1);
+		REQUIRE(parser.get_subcommand("clean") == clean);
+		REQUIRE(built == 1);
+
+		auto spec = parser.freeze();
+		REQUIRE(built == 3);
+		std::vector<std::string_view> args = {"build", "docs", "--open"};
+		auto result = spec.parse(args);
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().get_subcommand()->get_selected_subcommand() == "docs");
+	}
+}
+
+TEST_CASE("Parser completion", "[parser]") {
+	enum class Mode { Fast, Safe };
+
+	int built = 0;
+	Parser parser("my-app");
+	parser.add_completion();
+	parser.add_flag<bool>("verbose", "Verbose").set_short_name("v");
+	parser.add_flag<std::string>("color", "Color").set_choices({"auto", "always", "never"});
+	parser.add_subcommand("build", "Build it").add_flag<Mode>("mode", "Mode").set_short_name("m").set_choices<Mode>({{"fast", Mode::Fast}, {"safe", Mode::Safe}});
+	parser.add_lazy_subcommand("bench", "Benchmarks", [&](Subcommand &bench) {
+		++built;
+		bench.add_flag<int>("runs", "Runs");
+	});
+	parser.add_lazy_subcommand("clean", "Clean", [&](Subcommand &) { ++built; });
+
+	auto complete = [&](std::vector<std::string_view> words) {
+		return parser.complete(words);
+	};
+
+	SECTION("Subcommand names, flags and choices") {
+		REQUIRE(complete({"b"}) == std::vector<std::string>{"bench", "build"});
+		REQUIRE(complete({""}) == std::vector<std::string>{"bench", "build", "clean"});
+		REQUIRE(complete({"--c"}) == std::vector<std::string>{"--color"});
+		REQUIRE(complete({"-"}) == std::vector<std::string>{"--color", "--verbose", "-v"});
+		REQUIRE(complete({"--color", "a"}) == std::vector<std::string>{"always", "auto"});
+		REQUIRE(complete({"--color=n"}) == std::vector<std::string>{"--color=never"});
+		REQUIRE(complete({"-v", "build", "-m", ""}) == std::vector<std::string>{"fast", "safe"});
+		REQUIRE(complete({"build", "--mode=s"}) == std::vector<std::string>{"--mode=safe"});
+		REQUIRE(complete({"--", ""}).empty());
+		REQUIRE(built == 0);
+	}
+
+	SECTION("Only lazy subcommands on the typed path are defined") {
+		REQUIRE(complete({"bench", "--r"}) == std::vector<std::string>{"--runs"});
+		REQUIRE(built == 1);
+	}
+
+	SECTION("parse() answers __complete when enabled") {
+		REQUIRE(parser.parse(std::vector<std::string>{"__complete", "cl"}).has_value());
+		REQUIRE(parser.completion_requested());
+		REQUIRE(parser.parse(std::vector<std::string>{"-v"}).has_value());
+		REQUIRE_FALSE(parser.completion_requested());
+	}
+
+	SECTION("Scripts call back into the binary") {
+		REQUIRE_THAT(parser.completion_script(CompletionShell::Bash), ContainsSubstring("complete -o default -F _my_app_complete my-app"));
+		REQUIRE_THAT(parser.completion_script(CompletionShell::Zsh), ContainsSubstring("my-app __complete"));
+		REQUIRE_THAT(parser.completion_script(CompletionShell::Fish), ContainsSubstring("complete -c my-app -f"));
+	}
+}
+
+TEST_CASE("Parser reset", "[parser]") {
+	Parser parser("myapp");
+	parser.add_flag<int>("level", "Level").set_default_value(1);
+	parser.add_flag<std::string>("name", "Name");
+	parser.add_flag<std::string>("tag", "Tag").set_multi();
+	parser.add_positional<std::string>("input", "Input", false);
+	auto &build = parser.add_subcommand("build", "Build it");
+	build.add_flag<bool>("release", "Release");
+
+	REQUIRE(parser.parse(std::vector<std::string>{"--level", "3", "--name", "x", "--tag", "a", "--tag", "b", "in.txt"}).has_value());
+	const std::string *tags = parser.get_all<std::string>("tag").data();
+
+	parser.reset();
+	REQUIRE(parser.get<int>("level") == 1);
+	REQUIRE_FALSE(parser.has("name"));
+	REQUIRE(parser.get_all<std::string>("tag").empty());
+	REQUIRE_FALSE(parser.get_positional<std::string>(0).has_value());
+
+	REQUIRE(parser.parse(std::vector<std::string>{"--tag", "c", "--tag", "d", "build", "--release"}).has_value());
+	REQUIRE(parser.get_all<std::string>("tag").data() == tags);// storage reused
+	REQUIRE(parser.get_selected_subcommand() == "build");
+	REQUIRE(build.parsed());
+	REQUIRE(build.has("release"));
+
+	parser.reset();
+	REQUIRE_FALSE(parser.get_selected_subcommand().has_value());
+	REQUIRE_FALSE(build.parsed());
+	REQUIRE_FALSE(build.has("release"));
+}
+
+TEST_CASE("Parser tokenizer", "[parser]") {
+	SECTION("Tokens are classified in one pass") {
+		using detail::TokenKind;
+		STATIC_REQUIRE(detail::classify_token("file.txt").kind == TokenKind::Positional);
+		STATIC_REQUIRE(detail::classify_token("-").kind == TokenKind::Positional);
+		STATIC_REQUIRE(detail::classify_token("--").kind == TokenKind::DoubleDash);
+		STATIC_REQUIRE(detail::classify_token("--name").name == "name");
+		STATIC_REQUIRE(detail::classify_token("--name=a=b").kind == TokenKind::LongWithValue);
+		STATIC_REQUIRE(detail::classify_token("--name=a=b").value == "a=b");
+		STATIC_REQUIRE(detail::classify_token("-abc").kind == TokenKind::Short);
+		STATIC_REQUIRE(detail::classify_token("-abc").name == "abc");
+		STATIC_REQUIRE(detail::is_bool_literal("off"));
+		STATIC_REQUIRE_FALSE(detail::is_bool_literal("maybe"));
+	}
+
+	auto make_parser = [] {
+		Parser parser("myapp");
+		parser.add_flag<bool>("all", "All").set_short_name("a");
+		parser.add_flag<bool>("verbose", "Verbose").set_short_name("v");
+		parser.add_flag<int>("port", "Port").set_short_name("p");
+		parser.add_flag<bool>("debug", "Debug").set_short_name("dbg");
+		parser.add_positional<std::string>("input", "Input", false);
+		return parser;
+	};
+
+	SECTION("Short flags can be bundled") {
+		Parser parser = make_parser();
+		REQUIRE(parser.parse(std::vector<std::string>{"-av", "-p8080"}).has_value());
+		REQUIRE(parser.get<bool>("all") == true);
+		REQUIRE(parser.get<bool>("verbose") == true);
+		REQUIRE(parser.get<int>("port") == 8080);
+	}
+
+	SECTION("A value flag at the end of a bundle takes the next token") {
+		Parser parser = make_parser();
+		REQUIRE(parser.parse(std::vector<std::string>{"-vp", "9000", "-"}).has_value());
+		REQUIRE(parser.get<bool>("verbose") == true);
+		REQUIRE(parser.get<int>("port") == 9000);
+		REQUIRE(parser.get_positional<std::string>(0) == "-");
+	}
+
+	SECTION("Multi-letter short names win over bundling") {
+		Parser parser = make_parser();
+		REQUIRE(parser.parse(std::vector<std::string>{"-dbg"}).has_value());
+		REQUIRE(parser.get<bool>("debug") == true);
+		REQUIRE_FALSE(parser.has("all"));
+	}
+
+	SECTION("Unknown letters in a bundle are rejected") {
+		Parser parser = make_parser();
+		auto result = parser.parse(std::vector<std::string>{"-avx"});
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::UnknownFlag);
+
+		Parser missing = make_parser();
+		auto no_value = missing.parse(std::vector<std::string>{"-vp"});
+		REQUIRE_FALSE(no_value.has_value());
+		REQUIRE(no_value.error().code() == ErrorCode::MissingFlagValue);
+	}
+
+	SECTION("Subcommands and frozen specs share the tokenizer") {
+		Parser parser("myapp");
+		auto &run = parser.add_subcommand("run", "Run");
+		run.add_flag<bool>("quiet", "Quiet").set_short_name("q");
+		run.add_flag<int>("jobs", "Jobs").set_short_name("j");
+
+		REQUIRE(parser.parse(std::vector<std::string>{"run", "-qj4"}).has_value());
+		REQUIRE(run.get<int>("jobs") == 4);
+		REQUIRE(run.get<bool>("quiet") == true);
+
+		auto spec = parser.freeze();
+		std::vector<std::string_view> args = {"run", "-qj", "8"};
+		auto result = spec.parse(args);
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().get_subcommand()->get<int>("jobs") == 8);
+	}
+}
+
+TEST_CASE("Parser value dumps", "[parser]") {
+	enum class Mode { Fast, Safe };
+
+	Parser parser("myapp");
+	parser.add_flag<int>("port", "Port").set_default_value(80);
+	parser.add_flag<std::string>("name", "Name");
+	parser.add_flag<bool>("verbose", "Verbose");
+	parser.add_flag<double>("ratio", "Ratio");
+	parser.add_flag<std::chrono::milliseconds>("timeout", "Timeout").set_default_value(std::chrono::milliseconds(250));
+	parser.add_flag<std::string>("tag", "Tag").set_multi();
+	parser.add_flag<std::string>("unset", "Never given");
+	parser.add_positional<std::string>("input", "Input", false);
+	auto &build = parser.add_subcommand("build", "Build");
+	build.add_flag<Mode>("mode", "Mode").set_choices<Mode>({{"fast", Mode::Fast}, {"safe", Mode::Safe}});
+	build.add_flag<ByteSize>("cache", "Cache size").set_default_value({4 << 20});
+
+	REQUIRE(parser.parse(std::vector<std::string>{"--name", "say \"hi\"", "--verbose", "--ratio", "0.5", "--tag", "a", "--tag", "b", "in.txt", "build", "--mode", "safe"}).has_value());
+
+	SECTION("name=value lines include the selected subcommand") {
+		std::string out;
+		parser.dump_values(std::back_inserter(out));
+		REQUIRE(out == "port=80\nname=say \"hi\"\nverbose=true\nratio=0.5\ntimeout=250ms\ntag=a,b\ninput=in.txt\nbuild.mode=safe\nbuild.cache=4MiB\n");
+	}
+
+	SECTION("JSON nests the subcommand and types the values") {
+		std::string out;
+		parser.dump_values_json(std::back_inserter(out));
+		REQUIRE(out == R"({"port":80,"name":"say \"hi\"","verbose":true,"ratio":0.5,"timeout":"250ms","tag":["a","b"],"input":"in.txt","build":{"mode":"safe","cache":"4MiB"}})");
+	}
+
+	SECTION("Writes into a caller buffer and from a subcommand") {
+		char buffer[256];
+		const char *end = parser.dump_values(buffer);
+		REQUIRE(std::string_view(buffer, end).starts_with("port=80\n"));
+
+		std::string sub;
+		build.dump_values_json(std::back_inserter(sub));
+		REQUIRE(sub == R"({"mode":"safe","cache":"4MiB"})");
+	}
+}
+
+TEST_CASE("Parser rest positional", "[parser]") {
+	SECTION("Tokens after -- are captured as views into the arguments") {
+		Parser parser("myapp");
+		parser.add_flag<bool>("verbose", "Verbose").set_short_name("v");
+		parser.add_positional<std::string>("target", "Target");
+		parser.add_rest_positional("command");
+
+		const std::vector<std::string_view> args = {"-v", "box", "--", "make", "-j8", "--keep-going"};
+		REQUIRE(parser.parse(std::span<const std::string_view>(args)).has_value());
+		REQUIRE(parser.get_positional<std::string>("target") == "box");
+
+		const auto rest = parser.get_rest();
+		REQUIRE(rest.size() == 3);
+		REQUIRE(rest.data() == args.data() + 3);
+		REQUIRE(rest[1] == "-j8");
+		REQUIRE_FALSE(parser.has("keep-going"));
+		REQUIRE_THAT(parser.generate_help(), ContainsSubstring("<target> [-- command...]"));
+
+		parser.reset();
+		REQUIRE(parser.get_rest().empty());
+	}
+
+	SECTION("The first surplus positional starts the rest, flags included") {
+		Parser parser("myapp");
+		parser.add_flag<bool>("verbose", "Verbose").set_short_name("v");
+		parser.add_rest_positional("command");
+
+		const std::vector<std::string> args = {"ls", "-v", "/tmp"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE_FALSE(parser.has("verbose"));
+		REQUIRE(parser.get_rest().size() == 3);
+		REQUIRE(parser.get_rest()[0] == "ls");
+
+		REQUIRE(parser.parse(std::vector<std::string>{"-v"}).has_value());
+		REQUIRE(parser.get_rest().empty());
+	}
+
+	SECTION("Subcommands capture their own rest") {
+		Parser parser("myapp");
+		auto &run = parser.add_subcommand("run", "Run a command");
+		run.add_flag<std::string>("env", "Environment");
+		run.add_rest_positional("command");
+
+		const char *argv[] = {"run", "--env", "prod", "--", "echo", "hi"};
+		REQUIRE(parser.parse(std::span<const char *const>(argv)).has_value());
+		REQUIRE(run.get<std::string>("env") == "prod");
+		REQUIRE(run.get_rest().size() == 2);
+		REQUIRE(run.get_rest()[0].data() == argv[4]);
+		REQUIRE(parser.get_rest().empty());
+	}
+
+	SECTION("Without a rest positional surplus tokens are still an error") {
+		Parser parser("myapp");
+		auto result = parser.parse(std::vector<std::string>{"extra"});
+		REQUIRE(result.error().code() == ErrorCode::TooManyPositionals);
+	}
+
+	SECTION("Positional names are indexed") {
+		Parser parser("myapp");
+		parser.add_positional<std::string>("input", "Input");
+		parser.add_positional<int>("count", "Count", false);
+		parser.add_positional<std::string>("input", "Shadowed", false);
+
+		REQUIRE(parser.parse(std::vector<std::string>{"a", "3", "b"}).has_value());
+		REQUIRE(parser.get_positional<int>("count") == 3);
+		REQUIRE(parser.get_positional<std::string>("input") == "a");
+		REQUIRE_FALSE(parser.get_positional<std::string>("missing").has_value());
+	}
+}
+
+namespace {
+	void set_test_env(const char *name, const char *value) {
+#ifdef _WIN32
+		_putenv_s(name, value == nullptr ? "" : value);
+#else
+		if (value == nullptr) {
+			unsetenv(name);
+		} else {
+			setenv(name, value, 1);
+		}
+#endif
+	}
+}// namespace
+
+TEST_CASE("Parser config files and environment", "[parser]") {
+	SECTION("Config values fill flags and subcommand sections") {
+		const std::string path = write_response_file("cppli_test_config.ini",
+			"\xEF\xBB\xBF# service settings\n"
+			"port = 8080\n"
+			"name = \"hello world\"\n"
+			"tag = a,b\n"
+			"tag = c\n"
+			"\n"
+			"[build]\n"
+			"; nested section below\n"
+			"release = true\n"
+			"[remote.add]\n"
+			"url = 'https://example.com'\n");
+
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port");
+		parser.add_flag<std::string>("name", "Name");
+		parser.add_flag<std::string>("tag", "Tag").set_multi();
+		auto &build = parser.add_subcommand("build", "Build");
+		build.add_flag<bool>("release", "Release");
+		auto &remote = parser.add_subcommand("remote", "Remotes");
+		remote.add_subcommand("add", "Add a remote").add_flag<std::string>("url", "URL");
+
+		REQUIRE(parser.load_config(path).has_value());
+		REQUIRE(parser.get<int>("port") == 8080);
+		REQUIRE(parser.get<std::string>("name") == "hello world");
+		const auto tags = parser.get_all<std::string>("tag");
+		REQUIRE(std::vector<std::string>(tags.begin(), tags.end()) == std::vector<std::string>{"a", "b", "c"});
+		REQUIRE(build.get<bool>("release") == true);
+		REQUIRE(remote.get_subcommand("add")->get<std::string>("url") == "https://example.com");
+
+		std::vector<std::string> args = {"--port", "9000", "--tag", "x"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(parser.get<int>("port") == 9000);
+		REQUIRE(parser.get_all<std::string>("tag").size() == 1);// the command line replaces the file's tags
+		REQUIRE(parser.get<std::string>("name") == "hello world");
+
+		parser.reset();
+		REQUIRE_FALSE(parser.get<int>("port").has_value());
+	}
+
+	SECTION("The environment ranks between the command line and the file") {
+		const std::string path = write_response_file("cppli_test_env.ini", "port = 8080\nhost = file\n");
+
+		Parser parser("myapp");
+		auto &port = parser.add_flag<int>("port", "Port").set_env("CPPLI_TEST_PORT");
+		parser.add_flag<std::string>("host", "Host").set_env("CPPLI_TEST_HOST").set_default_value("default");
+		parser.add_flag<int>("jobs", "Jobs").set_env("CPPLI_TEST_UNSET").set_default_value(1);
+		set_test_env("CPPLI_TEST_PORT", "7000");
+		set_test_env("CPPLI_TEST_HOST", "env");
+		set_test_env("CPPLI_TEST_UNSET", nullptr);
+
+		REQUIRE(parser.load_config(path).has_value());
+		std::vector<std::string> args = {"--host", "cli"};
+		REQUIRE(parser.parse(args).has_value());
+		REQUIRE(parser.get<int>("port") == 7000);
+		REQUIRE(port.source() == ValueSource::Environment);
+		REQUIRE(parser.get<std::string>("host") == "cli");
+		REQUIRE(parser.get<int>("jobs") == 1);
+
+		set_test_env("CPPLI_TEST_PORT", "not-a-number");
+		parser.reset();
+		REQUIRE_FALSE(parser.parse(std::vector<std::string>{}).has_value());
+		set_test_env("CPPLI_TEST_PORT", nullptr);
+		set_test_env("CPPLI_TEST_HOST", nullptr);
+	}
+
+	SECTION("Errors name the file and line") {
+		const std::string path = write_response_file("cppli_test_bad.ini", "port = 80\n\nbogus = 1\n");
+
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port");
+
+		auto result = parser.load_config(path);
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::ConfigError);
+		REQUIRE_THAT(result.error().message(), ContainsSubstring("cppli_test_bad.ini:3"));
+		REQUIRE_THAT(result.error().message(), ContainsSubstring("unknown option 'bogus'"));
+
+		const std::string malformed = write_response_file("cppli_test_malformed.ini", "[build\n");
+		REQUIRE_THAT(parser.load_config(malformed).error().message(), ContainsSubstring("without ']'"));
+		REQUIRE(parser.load_config(path + ".missing").error().code() == ErrorCode::ConfigError);
+	}
+}
+
+TEST_CASE("Parser chained subcommands", "[parser]") {
+	struct Tool {
+		Parser parser{"tool"};
+		std::vector<std::string> order;
+		Subcommand &fetch = parser.add_subcommand("fetch", "Fetch");
+		Subcommand &build = parser.add_subcommand("build", "Build");
+		Subcommand &push = parser.add_subcommand("push", "Push");
+
+		Tool() {
+			parser.chain_subcommands();
+			fetch.add_positional<std::string>("remote", "Remote");
+			build.add_flag<bool>("release", "Release");
+			fetch.set_callback([this] { order.push_back("fetch"); });
+			build.set_callback([this] { order.push_back("build"); });
+			push.set_callback([this] { order.push_back("push"); });
+		}
+	};
+
+	SECTION("Each subcommand takes its own arguments and callbacks run in order") {
+		Tool tool;
+		std::vector<std::string> args = {"fetch", "origin", "build", "--release", "push"};
+		REQUIRE(tool.parser.parse(args).has_value());
+		REQUIRE(tool.fetch.get_positional<std::string>(0) == "origin");
+		REQUIRE(tool.build.get<bool>("release") == true);
+		REQUIRE(tool.parser.get_selected_subcommand() == "fetch");
+		REQUIRE(tool.parser.get_selected_subcommands() == std::vector<std::string_view>{"fetch", "build", "push"});
+		REQUIRE(tool.order == std::vector<std::string>{"fetch", "build", "push"});
+		REQUIRE(tool.parser.callbacks().done());
+
+		std::string dump;
+		tool.parser.dump_values(std::back_inserter(dump));
+		REQUIRE_THAT(dump, ContainsSubstring("fetch.remote=origin\n"));
+		REQUIRE_THAT(dump, ContainsSubstring("build.release=true\n"));
+	}
+
+	SECTION("No callback runs when a later subcommand fails") {
+		Tool tool;
+		tool.push.add_flag<int>("retries", "Retries").set_required();
+		REQUIRE_FALSE(tool.parser.parse(std::vector<std::string>{"fetch", "origin", "push"}).has_value());
+		REQUIRE(tool.order.empty());
+	}
+
+	SECTION("Repeats and require_subcommand counts are checked") {
+		Tool tool;
+		auto repeated = tool.parser.parse(std::vector<std::string>{"build", "build"});
+		REQUIRE_FALSE(repeated.has_value());
+		REQUIRE(repeated.error().code() == ErrorCode::SubcommandChainError);
+
+		tool.parser.reset();
+		tool.parser.require_subcommand(2);
+		auto counted = tool.parser.parse(std::vector<std::string>{"build"});
+		REQUIRE_FALSE(counted.has_value());
+		REQUIRE(counted.error().message() == "Expected 2 subcommands, got 1");
+		tool.parser.reset();
+		REQUIRE(tool.parser.parse(std::vector<std::string>{"build", "push"}).has_value());
+	}
+
+	SECTION("Without chaining the first subcommand takes the rest") {
+		Tool tool;
+		tool.parser.chain_subcommands(false);
+		REQUIRE(tool.parser.parse(std::vector<std::string>{"build", "push"}).has_value());
+		REQUIRE(tool.order == std::vector<std::string>{"build"});
+	}
+
+	SECTION("An executor runs concurrent neighbours in one stage") {
+		Parser parser("tool");
+		parser.chain_subcommands();
+		ThreadExecutor pool(2);
+		parser.set_executor(&pool);
+
+		std::mutex mutex;
+		std::condition_variable both;
+		int fetched = 0;
+		bool built_after_fetches = false;
+		auto fetch = [&] {
+			std::unique_lock lock(mutex);
+			++fetched;
+			both.notify_all();
+			both.wait(lock, [&] { return fetched == 2; });// deadlocks unless both fetches run at once
+		};
+		parser.add_subcommand("fetch-a", "Fetch A").set_concurrent().set_callback(fetch);
+		parser.add_subcommand("fetch-b", "Fetch B").set_concurrent().set_callback(fetch);
+		parser.add_subcommand("build", "Build").set_callback([&] {
+			std::lock_guard lock(mutex);
+			built_after_fetches = fetched == 2;
+		});
+
+		REQUIRE(parser.parse(std::vector<std::string>{"fetch-a", "fetch-b", "build"}).has_value());
+		parser.callbacks().wait();
+		REQUIRE(parser.callbacks().done());
+		REQUIRE(built_after_fetches);
+	}
+
+	SECTION("wait() rethrows a callback's exception and skips later stages") {
+		Parser parser("tool");
+		parser.chain_subcommands();
+		ThreadExecutor pool(1);
+		parser.set_executor(&pool);
+
+		bool pushed = false;
+		parser.add_subcommand("build", "Build").set_callback([] { throw std::runtime_error("build failed"); });
+		parser.add_subcommand("push", "Push").set_callback([&] { pushed = true; });
+
+		REQUIRE(parser.parse(std::vector<std::string>{"build", "push"}).has_value());
+		REQUIRE_THROWS_AS(parser.callbacks().wait(), std::runtime_error);
+		REQUIRE_FALSE(pushed);
+	}
+}
+
+TEST_CASE("Parser abbreviations and suggestions", "[parser]") {
+	SECTION("Unknown long flags suggest the nearest name") {
+		Parser parser("myapp");
+		parser.add_flag<bool>("verbose", "Verbose output");
+		parser.add_flag<int>("port", "Port number");
+
+		auto result = parser.parse(std::vector<std::string>{"--verbsoe"});
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::UnknownFlag);
+		REQUIRE(result.error().message() == "Unknown flag: --verbsoe (did you mean --verbose?)");
+
+		parser.reset();
+		result = parser.parse(std::vector<std::string>{"--prot=80"});
+		REQUIRE(result.error().message() == "Unknown flag: --prot=80 (did you mean --port?)");
+
+		parser.reset();
+		result = parser.parse(std::vector<std::string>{"--quiet"});
+		REQUIRE(result.error().message() == "Unknown flag: --quiet");
+	}
+
+	SECTION("Prefixes are rejected unless abbreviations are allowed") {
+		Parser parser("myapp");
+		parser.add_flag<bool>("verbose", "Verbose output");
+		REQUIRE_FALSE(parser.parse(std::vector<std::string>{"--verb"}).has_value());
+
+		parser.reset();
+		parser.allow_abbreviations();
+		REQUIRE(parser.parse(std::vector<std::string>{"--verb"}).has_value());
+		REQUIRE(parser.get<bool>("verbose") == true);
+	}
+
+	SECTION("Ambiguous prefixes fail and exact names win") {
+		Parser parser("myapp");
+		parser.allow_abbreviations();
+		parser.add_flag<std::string>("ver", "Version pin");
+		parser.add_flag<bool>("verbose", "Verbose output");
+		parser.add_flag<bool>("verify", "Verify checksums");
+
+		REQUIRE(parser.parse(std::vector<std::string>{"--ver", "1.2"}).has_value());
+		REQUIRE(parser.get<std::string>("ver") == "1.2");
+
+		parser.reset();
+		auto result = parser.parse(std::vector<std::string>{"--veri"});
+		REQUIRE(result.has_value());
+		REQUIRE(parser.get<bool>("verify") == true);
+
+		parser.reset();
+		result = parser.parse(std::vector<std::string>{"--verb=false", "--ve"});
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().message() == "Ambiguous flag: --ve matches more than one flag");
+	}
+
+	SECTION("Subcommands accept prefixes and suggest names") {
+		Parser parser("git");
+		auto &remote = parser.add_subcommand("remote", "Manage remotes");
+		remote.add_flag<bool>("verbose", "Verbose output");
+		remote.add_subcommand("add", "Add a remote");
+		parser.add_subcommand("rebase", "Rebase commits");
+
+		auto result = parser.parse(std::vector<std::string>{"remtoe"});
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::UnknownSubcommand);
+		REQUIRE(result.error().message() == "Unknown subcommand: remtoe (did you mean remote?)");
+
+		parser.reset();
+		result = parser.parse(std::vector<std::string>{"remote", "--verbsoe"});
+		REQUIRE(result.error().message() == "Unknown flag: --verbsoe (did you mean --verbose?)");
+
+		parser.reset();
+		parser.allow_abbreviations();
+		REQUIRE_FALSE(parser.parse(std::vector<std::string>{"re"}).has_value());
+
+		parser.reset();
+		REQUIRE(parser.parse(std::vector<std::string>{"rem", "--verb", "a"}).has_value());
+		REQUIRE(parser.get_selected_subcommand() == "remote");
+		REQUIRE(remote.get<bool>("verbose") == true);
+		REQUIRE(remote.get_selected_subcommand() == "add");
+	}
+
+	SECTION("Suggestions stay current as flags are added") {
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port number");
+		REQUIRE(parser.parse(std::vector<std::string>{"--hots"}).error().message() == "Unknown flag: --hots");
+
+		parser.reset();
+		parser.add_flag<std::string>("host", "Host name");
+		REQUIRE(parser.parse(std::vector<std::string>{"--hots"}).error().message() == "Unknown flag: --hots (did you mean --host?)");
+	}
+
+	SECTION("Suggestions search many names") {
+		Parser parser("myapp");
+		for (int i = 0; i < 300; ++i) {
+			parser.add_flag<int>("option-" + std::to_string(i), "Generated flag");
+		}
+		for (int i = 0; i < 250; ++i) {
+			parser.add_subcommand("command-" + std::to_string(i), "Generated subcommand");
+		}
+
+		REQUIRE(parser.parse(std::vector<std::string>{"--optoin-123"}).error().message() == "Unknown flag: --optoin-123 (did you mean --option-123?)");
+		parser.reset();
+		REQUIRE(parser.parse(std::vector<std::string>{"comand-42"}).error().message() == "Unknown subcommand: comand-42 (did you mean command-42?)");
+	}
+}
+
+TEST_CASE("Parser memory stats", "[parser]") {
+	SECTION("Categories grow with what the parser holds") {
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port number");
+		const MemoryStats base = parser.memory_stats();
+		REQUIRE(base.flags > 0);
+		REQUIRE(base.tables > 0);
+		REQUIRE(base.choices == 0);
+		REQUIRE(base.subcommands == 0);
+		REQUIRE(base.function_targets == 0);
+		REQUIRE(base.total() == base.flags + base.tables + base.strings + base.choices + base.values + base.subcommands);
+
+		parser.add_flag<std::string>("mode", std::string(200, 'd')).set_choices({"fast", "slow", "balanced"});
+		const MemoryStats more = parser.memory_stats();
+		REQUIRE(more.strings >= base.strings + 200);
+		REQUIRE(more.choices > 0);
+		REQUIRE(more.flags > base.flags);
+	}
+
+	SECTION("Subcommands and function targets are counted over the tree") {
+		Parser parser("git");
+		parser.add_flag<int>("jobs", "Job count").set_validator([](const int &jobs) { return jobs > 0 ? Result<void>::ok() : Result<void>::err(Error::validation_failed("jobs", "must be positive")); });
+		auto &remote = parser.add_subcommand("remote", "Manage remotes");
+		remote.add_flag<bool>("verbose", "Verbose output");
+		remote.set_callback([] {});
+
+		const MemoryStats stats = parser.memory_stats();
+		REQUIRE(stats.function_targets == 2);
+		REQUIRE(stats.subcommands >= sizeof(Subcommand) + remote.memory_stats().total());
+		REQUIRE(remote.memory_stats().function_targets == 1);
+		REQUIRE(parser.freeze().memory_stats().function_targets == 1);
+	}
+}
@@ -0,0 +1,113 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include <cppli_schema.hpp>
+#include <cppli_tokenizer.hpp>
+
+using namespace cli;
+
+using ServerSchema = Schema<Flag<"port", int, "Port number">{'p'}, Flag<"verbose", bool>{'v'}, Flag<"host", std::string>{}, Flag<"ratio", double>{'r'}>;
+
+TEST_CASE("Schema parsing", "[schema]") {
+	SECTION("Long, short and inline values") {
+		ServerSchema schema;
+		std::vector<std::string_view> args = {"-p", "8080", "--host=localhost", "-v", "--ratio", "0.5"};
+		auto result = schema.parse(std::span<const std::string_view>(args));
+		REQUIRE(result.has_value());
+		REQUIRE(schema.get<"port">() == 8080);
+		REQUIRE(schema.get<"host">() == "localhost");
+		REQUIRE(schema.get<"verbose">() == true);
+		REQUIRE(schema.get<"ratio">() == 0.5);
+	}
+
+	SECTION("Unset flags have no value") {
+		ServerSchema schema;
+		auto result = schema.parse(std::span<const std::string_view>{});
+		REQUIRE(result.has_value());
+		REQUIRE_FALSE(schema.has<"port">());
+		REQUIRE_FALSE(schema.get<"host">().has_value());
+	}
+
+	SECTION("Positionals are collected as views") {
+		ServerSchema schema;
+		std::vector<std::string_view> args = {"a.txt", "-v", "false", "--", "-b.txt"};
+		auto result = schema.parse(std::span<const std::string_view>(args));
+		REQUIRE(result.has_value());
+		REQUIRE(schema.get<"verbose">() == false);
+		REQUIRE(schema.positionals().size() == 2);
+		REQUIRE(schema.positionals()[0] == "a.txt");
+		REQUIRE(schema.positionals()[1] == "-b.txt");
+	}
+
+	SECTION("Unknown flags are rejected") {
+		ServerSchema schema;
+		std::vector<std::string_view> args = {"--bogus"};
+		auto result = schema.parse(std::span<const std::string_view>(args));
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::UnknownFlag);
+
+		std::vector<std::string_view> short_args = {"-x"};
+		REQUIRE(schema.parse(std::span<const std::string_view>(short_args)).error().code() == ErrorCode::UnknownFlag);
+	}
+
+	SECTION("Short flags bundle like they do for a Parser") {
+		ServerSchema schema;
+		std::vector<std::string_view> args = {"-vp8080", "-r", "0.25"};
+		auto result = schema.parse(std::span<const std::string_view>(args));
+		REQUIRE(result.has_value());
+		REQUIRE(schema.get<"verbose">() == true);
+		REQUIRE(schema.get<"port">() == 8080);
+		REQUIRE(schema.get<"ratio">() == 0.25);
+		REQUIRE(detail::is_bool_literal("off"));
+	}
+
+	SECTION("Missing value is reported") {
+		ServerSchema schema;
+		std::vector<std::string_view> args = {"--port"};
+		auto result = schema.parse(std::span<const std::string_view>(args));
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::MissingFlagValue);
+	}
+}
+
+TEST_CASE("Schema reuses TypedFlag options", "[schema]") {
+	SECTION("Required flag") {
+		ServerSchema schema;
+		schema.flag<"port">().set_required();
+		auto result = schema.parse(std::span<const std::string_view>{});
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::MissingRequiredFlag);
+		REQUIRE_THAT(result.error().message(), Catch::Matchers::ContainsSubstring("port"));
+	}
+
+	SECTION("Default value and choices") {
+		ServerSchema schema;
+		schema.flag<"port">().set_default_value(80).set_choices({80, 443});
+		REQUIRE(schema.get<"port">() == 80);
+
+		std::vector<std::string_view> args = {"--port", "8080"};
+		auto result = schema.parse(std::span<const std::string_view>(args));
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::ValidationFailed);
+	}
+
+	SECTION("Flag metadata comes from the declaration") {
+		ServerSchema schema;
+		REQUIRE(schema.flag<"port">().long_name() == "port");
+		REQUIRE(schema.flag<"port">().short_name() == "p");
+		REQUIRE(schema.flag<"port">().description() == "Port number");
+	}
+}
+
+TEST_CASE("Schema perfect hash", "[schema]") {
+	SECTION("Every declared name resolves to its own index") {
+		constexpr std::array<std::string_view, 6> names = {"alpha", "beta", "gamma", "delta", "epsilon", "zeta"};
+		constexpr std::array<char, 6> shorts = {'a', 'b', '\0', 'd', '\0', 'z'};
+		constexpr detail::SchemaIndex<6> index{names, shorts};
+
+		STATIC_REQUIRE(index.find("gamma") == 2);
+		STATIC_REQUIRE(index.find("zeta") == 5);
+		STATIC_REQUIRE(index.find("omega") == 6);
+		STATIC_REQUIRE(index.find_short('d') == 3);
+		STATIC_REQUIRE(index.find_short('g') == 6);
+	}
+}
@@ -0,0 +1,623 @@
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include <cppli.hpp>
+#include <memory_resource>
+#include <stdexcept>
+#include <thread>
+
+using namespace cli;
+
+namespace {
+	/**
+	 * @brief Counts live bytes and allocations passed to the upstream resource.
+	 */
+	class CountingResource : public std::pmr::memory_resource {
+	  public:
+		std::size_t allocations = 0;
+		std::size_t live_bytes = 0;
+
+	  private:
+		void *do_allocate(std::size_t bytes, std::size_t align) override {
+			++allocations;
+			live_bytes += bytes;
+			return std::pmr::new_delete_resource()->allocate(bytes, align);
+		}
+
+		void do_deallocate(void *p, std::size_t bytes, std::size_t align) override {
+			live_bytes -= bytes;
+			std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+			return this == &other;
+		}
+	};
+
+	void set_test_env(const char *name, const char *value) {
+#ifdef _WIN32
+		_putenv_s(name, value == nullptr ? "" : value);
+#else
+		if (value == nullptr) {
+			unsetenv(name);
+		} else {
+			setenv(name, value, 1);
+		}
+#endif
+	}
+
+	Parser make_parser() {
+		Parser parser("myapp");
+		parser.add_flag<int>("port", "Port number").set_short_name("p").set_default_value(80);
+		parser.add_flag<std::string>("host", "Host name").set_required();
+		parser.add_flag<bool>("verbose", "Verbose").set_short_name("v");
+		parser.add_positional<std::string>("input", "Input file", false);
+
+		auto &build = parser.add_subcommand("build", "Build the project");
+		build.add_flag<std::string>("target", "Build target").set_required();
+		build.add_positional<int>("jobs", "Job count", false);
+		return parser;
+	}
+}// namespace
+
+TEST_CASE("ParserSpec parse results", "[spec]") {
+	const ParserSpec spec = make_parser().freeze();
+
+	SECTION("Values, defaults and positionals") {
+		std::vector<std::string> args = {"--host", "example.com", "-v", "in.txt"};
+		auto result = spec.parse(args);
+		REQUIRE(result.has_value());
+
+		const auto &parsed = result.value();
+		REQUIRE(parsed.get<std::string>("host") == "example.com");
+		REQUIRE(parsed.get<int>("port") == 80);
+		REQUIRE(parsed.get<bool>("verbose") == true);
+		REQUIRE(parsed.get_positional<std::string>(0) == "in.txt");
+		REQUIRE(parsed.get_positional<std::string>("input") == "in.txt");
+		REQUIRE_FALSE(parsed.get<int>("host").has_value());
+		REQUIRE_FALSE(parsed.has("missing"));
+	}
+
+	SECTION("Results are independent of each other") {
+		std::vector<std::string> first_args = {"--host=a", "-p", "1"};
+		std::vector<std::string> second_args = {"--host=b"};
+		auto first = spec.parse(first_args);
+		auto second = spec.parse(second_args);
+		REQUIRE(first.has_value());
+		REQUIRE(second.has_value());
+		REQUIRE(first.value().get<int>("port") == 1);
+		REQUIRE(second.value().get<int>("port") == 80);
+		REQUIRE(second.value().get<std::string>("host") == "b");
+	}
+
+	SECTION("Errors are reported per parse") {
+		std::vector<std::string> args = {"-v"};
+		auto result = spec.parse(args);
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::MissingRequiredFlag);
+		REQUIRE_THAT(result.error().message(), Catch::Matchers::ContainsSubstring("host"));
+
+		std::vector<std::string> bad = {"--host", "x", "--port", "abc"};
+		REQUIRE(spec.parse(bad).error().code() == ErrorCode::InvalidFlagValue);
+	}
+
+	SECTION("Subcommand results are nested") {
+		std::vector<std::string> args = {"build", "--target", "release", "8"};
+		auto result = spec.parse(args);
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().get_selected_subcommand() == "build");
+
+		const auto *build = result.value().get_subcommand();
+		REQUIRE(build != nullptr);
+		REQUIRE(build->get<std::string>("target") == "release");
+		REQUIRE(build->get_positional<int>(0) == 8);
+
+		std::vector<std::string> missing = {"build"};
+		REQUIRE(spec.parse(missing).error().code() == ErrorCode::MissingRequiredFlag);
+	}
+
+	SECTION("Abbreviations and suggestions are frozen with the spec") {
+		std::vector<std::string> typo = {"--hots", "x"};
+		REQUIRE(spec.parse(typo).error().message() == "Unknown flag: --hots (did you mean --host?)");
+		std::vector<std::string> prefix = {"--ho", "x"};
+		REQUIRE(spec.parse(prefix).error().code() == ErrorCode::UnknownFlag);
+
+		const ParserSpec abbreviating = make_parser().allow_abbreviations().freeze();
+		std::vector<std::string> args = {"--ho", "x", "bui", "--tar", "debug", "1"};
+		auto result = abbreviating.parse(args);
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().get<std::string>("host") == "x");
+		REQUIRE(result.value().get_selected_subcommand() == "build");
+		REQUIRE(result.value().get_subcommand()->get<std::string>("target") == "debug");
+	}
+}
+
+TEST_CASE("ParserSpec isolation from the Parser", "[spec]") {
+	SECTION("Parsing a spec leaves the parser untouched") {
+		Parser parser = make_parser();
+		const ParserSpec spec = parser.freeze();
+
+		std::vector<std::string> args = {"--host", "spec-only"};
+		REQUIRE(spec.parse(args).has_value());
+		REQUIRE_FALSE(parser.has("host"));
+	}
+
+	SECTION("Spec outlives the parser") {
+		std::optional<ParserSpec> spec;
+		{
+			Parser parser = make_parser();
+			spec = parser.freeze();
+		}
+
+		std::vector<std::string> args = {"--host", "h"};
+		auto result = spec->parse(args);
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().get<std::string>("host") == "h");
+	}
+}
+
+TEST_CASE("ParserSpec concurrent parsing", "[spec]") {
+	const ParserSpec spec = make_parser().freeze();
+
+	std::vector<int> seen(8, -1);
+	std::vector<std::thread> workers;
+	for (int t = 0; t < 8; ++t) {
+		workers.emplace_back([&spec, &seen, t] {
+			int last = -1;
+			for (int i = 0; i < 200; ++i) {
+				const std::string port = std::to_string(t * 1000 + i);
+				std::vector<std::string_view> args = {"--host", "h", "--port", port};
+				auto result = spec.parse(std::span<const std::string_view>(args));
+				if (! result || result.value().get<int>("port") != t * 1000 + i) {
+					return;
+				}
+				last = i;
+			}
+			seen[static_cast<size_t>(t)] = last;
+		});
+	}
+	for (auto &worker: workers) {
+		worker.join();
+	}
+
+	for (int last: seen) {
+		REQUIRE(last == 199);
+	}
+}
+
+TEST_CASE("ParserSpec batch parsing", "[spec]") {
+	const ParserSpec spec = make_parser().freeze();
+	ThreadExecutor executor(4);
+
+	SECTION("Results are index-aligned with inputs") {
+		std::vector<std::string> ports;
+		for (int i = 0; i < 1000; ++i) {
+			ports.push_back(std::to_string(i));
+		}
+
+		std::vector<std::vector<std::string_view>> inputs;
+		for (int i = 0; i < 1000; ++i) {
+			if (i % 10 == 0) {
+				inputs.push_back({"--port", ports[static_cast<size_t>(i)]});
+			} else {
+				inputs.push_back({"--host", "h", "--port", ports[static_cast<size_t>(i)]});
+			}
+		}
+
+		auto batch = spec.parse_batch(inputs, executor);
+		REQUIRE(batch.size() == inputs.size());
+		REQUIRE(batch.failures == 100);
+
+		bool all_match = true;
+		for (size_t i = 0; i < inputs.size(); ++i) {
+			if (i % 10 == 0) {
+				all_match = all_match && ! batch.ok(i) && batch.errors[i].code() == ErrorCode::MissingRequiredFlag &&
+							! batch.results[i].has("port");
+			} else {
+				all_match = all_match && batch.ok(i) && batch.results[i].get<int>("port") == static_cast<int>(i);
+			}
+		}
+		REQUIRE(all_match);
+	}
+
+	SECTION("Empty batch") {
+		auto batch = spec.parse_batch({}, executor);
+		REQUIRE(batch.size() == 0);
+		REQUIRE(batch.failures == 0);
+	}
+
+	SECTION("Nested bulk_execute does not deadlock") {
+		ThreadExecutor single(1);
+		std::vector<int> hits(8, 0);
+		single.bulk_execute(2, [&](size_t outer) {
+			single.bulk_execute(4, [&](size_t inner) {
+				hits[outer * 4 + inner] += 1;
+			});
+		});
+		REQUIRE(hits == std::vector<int>(8, 1));
+	}
+
+	SECTION("An exception from fn stops the work and is rethrown after it drains") {
+		ThreadExecutor pool(4);
+		std::atomic<int> calls{0};
+		auto run = [&] {
+			pool.bulk_execute(1000, [&](size_t i) {
+				calls.fetch_add(1);
+				if (i == 3) {
+					throw std::runtime_error("validator failed");
+				}
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			});
+		};
+		REQUIRE_THROWS_AS(run(), std::runtime_error);
+		const int seen = calls.load();
+		REQUIRE(seen < 1000);
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		REQUIRE(calls.load() == seen);
+	}
+}
+
+TEST_CASE("ParserSpec requirements match the Parser", "[spec]") {
+	SECTION("Required flags of nested subcommands are checked on both paths") {
+		Parser parser("git");
+		auto &remote = parser.add_subcommand("remote", "Manage remotes");
+		remote.add_subcommand("add", "Add a remote").add_flag<std::string>("url", "Remote URL").set_required();
+		const ParserSpec spec = parser.freeze();
+
+		const std::vector<std::string> missing = {"remote", "add"};
+		auto from_parser = parser.parse(missing);
+		auto from_spec = spec.parse(missing);
+		REQUIRE_FALSE(from_parser.has_value());
+		REQUIRE_FALSE(from_spec.has_value());
+		REQUIRE(from_parser.error().message() == from_spec.error().message());
+		REQUIRE(from_spec.error().message() == "Required flag missing: --url");
+
+		parser.reset();
+		const std::vector<std::string> given = {"remote", "add", "--url", "https://example.com"};
+		REQUIRE(parser.parse(given).has_value());
+		REQUIRE(spec.parse(given).has_value());
+	}
+
+	SECTION("The first missing flag in name order is reported") {
+		Parser parser("myapp");
+		parser.add_flag<int>("zeta", "Zeta").set_required();
+		parser.add_flag<int>("alpha", "Alpha").set_required();
+		parser.add_flag<int>("mid", "Mid").set_required();
+		parser.add_positional<std::string>("input", "Input");
+		const ParserSpec spec = parser.freeze();
+
+		auto from_parser = parser.parse(std::vector<std::string>{"--zeta", "1"});
+		auto from_spec = spec.parse(std::vector<std::string>{"--zeta", "1"});
+		REQUIRE(from_spec.error().message() == "Required flag missing: --alpha");
+		REQUIRE(from_parser.error().message() == from_spec.error().message());
+
+		parser.reset();
+		const std::vector<std::string> flags_only = {"--zeta", "1", "--alpha", "2", "--mid", "3"};
+		REQUIRE(parser.parse(flags_only).error().message() == spec.parse(flags_only).error().message());
+		REQUIRE(spec.parse(flags_only).error().code() == ErrorCode::MissingRequiredPositional);
+	}
+}
+
+TEST_CASE("ParserSpec environment values", "[spec]") {
+	Parser parser("myapp");
+	parser.add_flag<int>("port", "Port").set_env("CPPLI_SPEC_PORT").set_default_value(80);
+	parser.add_flag<std::string>("tag", "Tag").set_multi().set_env("CPPLI_SPEC_TAGS");
+	auto &build = parser.add_subcommand("build", "Build");
+	build.add_flag<int>("jobs", "Jobs").set_env("CPPLI_SPEC_JOBS");
+	const ParserSpec spec = parser.freeze();
+
+	set_test_env("CPPLI_SPEC_PORT", "99");
+	set_test_env("CPPLI_SPEC_TAGS", "a,b");
+	set_test_env("CPPLI_SPEC_JOBS", "4");
+
+	SECTION("The environment ranks above defaults, like for the Parser") {
+		REQUIRE(parser.parse(std::vector<std::string>{"build"}).has_value());
+		auto result = spec.parse(std::vector<std::string>{"build"});
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().get<int>("port") == 99);
+		REQUIRE(result.value().get<int>("port") == parser.get<int>("port"));
+		REQUIRE(result.value().get_all<std::string>("tag").size() == 2);
+		REQUIRE(result.value().get_subcommand()->get<int>("jobs") == 4);
+	}
+
+	SECTION("The command line replaces environment values") {
+		auto result = spec.parse(std::vector<std::string>{"--port", "1", "--tag", "c", "--tag", "d"});
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().get<int>("port") == 1);
+		const auto tags = result.value().get_all<std::string>("tag");
+		REQUIRE(std::vector<std::string>(tags.begin(), tags.end()) == std::vector<std::string>{"c", "d"});
+	}
+
+	SECTION("Invalid environment values are errors") {
+		set_test_env("CPPLI_SPEC_PORT", "not-a-number");
+		REQUIRE_FALSE(spec.parse(std::vector<std::string>{}).has_value());
+	}
+
+	set_test_env("CPPLI_SPEC_PORT", nullptr);
+	set_test_env("CPPLI_SPEC_TAGS", nullptr);
+	set_test_env("CPPLI_SPEC_JOBS", nullptr);
+}
+
+TEST_CASE("ParserSpec chained subcommands", "[spec]") {
+	Parser parser("tool");
+	parser.chain_subcommands();
+	parser.add_subcommand("fetch", "Fetch").add_positional<std::string>("remote", "Remote", false);
+	parser.add_subcommand("build", "Build").add_flag<bool>("release", "Release build");
+	parser.add_subcommand("push", "Push");
+
+	SECTION("Each subcommand of the chain gets its own result") {
+		const std::vector<std::string> args = {"fetch", "origin", "build", "--release", "push"};
+		REQUIRE(parser.parse(args).has_value());
+
+		const ParserSpec spec = parser.freeze();
+		auto result = spec.parse(args);
+		REQUIRE(result.has_value());
+		size_t chained = 0;
+		for (const ParseResult *sub = result.value().get_subcommand(); sub != nullptr; sub = sub->get_next_subcommand()) {
+			++chained;
+		}
+		REQUIRE(chained == parser.get_selected_subcommands().size());
+		REQUIRE(result.value().get_selected_subcommand() == "fetch");
+		const ParseResult *fetch = result.value().get_subcommand();
+		REQUIRE(fetch->get_positional<std::string>("remote") == "origin");
+		REQUIRE(fetch->get_next_subcommand()->get<bool>("release") == true);
+		REQUIRE(fetch->get_next_subcommand()->get_next_subcommand()->get_next_subcommand() == nullptr);
+	}
+
+	SECTION("Snapshots keep the whole chain") {
+		const ParserSpec spec = parser.freeze();
+		auto result = spec.parse(std::vector<std::string>{"fetch", "origin", "build", "--release"});
+		REQUIRE(result.has_value());
+		std::vector<std::byte> bytes(result.value().serialized_size());
+		REQUIRE(result.value().serialize(bytes).has_value());
+
+		auto view = ParseResultView::from_bytes(spec, bytes);
+		REQUIRE(view.has_value());
+		REQUIRE_FALSE(view.value().get_next_subcommand().has_value());
+		REQUIRE(view.value().get_selected_subcommand() == "fetch");
+		const auto fetch = view.value().get_subcommand();
+		REQUIRE(fetch->get_positional<std::string>("remote") == "origin");
+		const auto build = fetch->get_next_subcommand();
+		REQUIRE(build.has_value());
+		REQUIRE(build->get<bool>("release") == true);
+		REQUIRE_FALSE(build->get_positional<std::string>("remote").has_value());
+		REQUIRE_FALSE(build->get_next_subcommand().has_value());
+	}
+
+	SECTION("Repeats and require_subcommand counts match the Parser") {
+		const ParserSpec chaining = parser.freeze();
+		REQUIRE(chaining.parse(std::vector<std::string>{"build", "build"}).error().code() == ErrorCode::SubcommandChainError);
+
+		parser.require_subcommand(2);
+		const ParserSpec spec = parser.freeze();
+		REQUIRE(spec.parse(std::vector<std::string>{"build"}).error().message() == "Expected 2 subcommands, got 1");
+		REQUIRE(spec.parse(std::vector<std::string>{}).error().code() == ErrorCode::MissingRequiredFlag);
+		REQUIRE(spec.parse(std::vector<std::string>{"build", "push"}).has_value());
+	}
+
+	SECTION("Without chaining a later subcommand name is not another subcommand") {
+		parser.chain_subcommands(false);
+		parser.require_subcommand(1);
+		const ParserSpec spec = parser.freeze();
+		auto result = spec.parse(std::vector<std::string>{"build", "push"});
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().get_subcommand()->get_next_subcommand() == nullptr);
+		REQUIRE_FALSE(spec.parse(std::vector<std::string>{}).has_value());
+	}
+}
+
+TEST_CASE("ParserSpec rest positionals", "[spec]") {
+	Parser parser("myapp");
+	parser.add_flag<bool>("verbose", "Verbose").set_short_name("v");
+	parser.add_positional<std::string>("mode", "Mode");
+	parser.add_rest_positional("cmd");
+	auto &exec = parser.add_subcommand("exec", "Run a command");
+	exec.add_rest_positional("argv");
+	const ParserSpec spec = parser.freeze();
+
+	SECTION("The root captures the same tokens as the Parser") {
+		const std::vector<std::string> args = {"-v", "run", "--", "make", "-j8"};
+		REQUIRE(parser.parse(args).has_value());
+
+		auto result = spec.parse(args);
+		REQUIRE(result.has_value());
+		const auto rest = result.value().get_rest();
+		REQUIRE(std::vector<std::string_view>(rest.begin(), rest.end()) == std::vector<std::string_view>{"make", "-j8"});
+		REQUIRE(std::vector<std::string_view>(rest.begin(), rest.end()) == std::vector<std::string_view>(parser.get_rest().begin(), parser.get_rest().end()));
+		REQUIRE(result.value().get_positional<std::string>("mode") == "run");
+	}
+
+	SECTION("A subcommand captures its own rest, which outlives the arguments") {
+		ParseResult parsed;
+		{
+			auto result = spec.parse(std::vector<std::string>{"exec", "ls", "-la"});
+			REQUIRE(result.has_value());
+			parsed = std::move(result.value());
+		}
+		REQUIRE(parsed.get_rest().empty());
+		const auto rest = parsed.get_subcommand()->get_rest();
+		REQUIRE(std::vector<std::string_view>(rest.begin(), rest.end()) == std::vector<std::string_view>{"ls", "-la"});
+		REQUIRE(parsed.memory_stats().subcommands > sizeof(ParseResult));
+	}
+
+	SECTION("Without a rest positional surplus tokens are still rejected") {
+		Parser plain("myapp");
+		plain.add_positional<std::string>("mode", "Mode");
+		REQUIRE(plain.freeze().parse(std::vector<std::string>{"run", "extra"}).error().code() == ErrorCode::TooManyPositionals);
+		REQUIRE(plain.freeze().hash() != parser.freeze().hash());
+	}
+}
+
+TEST_CASE("ParserSpec repeatable flags", "[spec]") {
+	Parser parser("myapp");
+	parser.add_flag<std::string>("tag", "Tag").set_short_name("t").set_multi();
+	parser.add_flag<int>("level", "Level").set_multi().set_default_value(7).set_required();
+	const ParserSpec spec = parser.freeze();
+
+	SECTION("Values live in the result") {
+		std::vector<std::string> args = {"-t", "a,b", "--tag", "c", "--level", "1"};
+		auto result = spec.parse(args);
+		REQUIRE(result.has_value());
+
+		const auto tags = result.value().get_all<std::string>("tag");
+		REQUIRE(std::vector<std::string>(tags.begin(), tags.end()) == std::vector<std::string>{"a", "b", "c"});
+		REQUIRE(result.value().get<std::string>("tag") == "c");
+		REQUIRE(result.value().get_all<int>("level").size() == 1);
+		REQUIRE(result.value().get_all<int>("level")[0] == 1);
+		REQUIRE(parser.get_all<std::string>("tag").empty());
+	}
+
+	SECTION("Defaults satisfy required repeatable flags") {
+		auto result = spec.parse(std::vector<std::string>{});
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().has("level"));
+		REQUIRE_FALSE(result.value().has("tag"));
+		REQUIRE(result.value().get_all<std::string>("tag").empty());
+		REQUIRE(result.value().get_all<int>("level")[0] == 7);
+	}
+
+	SECTION("Invalid values fail without leaking") {
+		auto result = spec.parse(std::vector<std::string>{"--level", "1,x"});
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::InvalidFlagValue);
+	}
+}
+
+TEST_CASE("ParserSpec memory resources", "[spec]") {
+	Parser parser = make_parser();
+	parser.add_flag<std::pmr::string>("label", "Label");
+	parser.add_flag<std::string>("tag", "Tag").set_multi();
+	const ParserSpec spec = parser.freeze();
+
+	std::vector<std::string_view> args = {"--host", "h", "--label", "a label too long for SSO storage", "--tag", "x,y", "build", "--target", "t"};
+
+	SECTION("Every per-parse allocation goes through the resource and is returned") {
+		CountingResource counting;
+		{
+			auto result = spec.parse(std::span<const std::string_view>(args), &counting);
+			REQUIRE(result.has_value());
+
+			const auto &parsed = result.value();
+			REQUIRE(parsed.get<std::pmr::string>("label") == "a label too long for SSO storage");
+			REQUIRE(parsed.get_all<std::string>("tag").size() == 2);
+			REQUIRE(parsed.get_subcommand()->get<std::string>("target") == "t");
+			REQUIRE(counting.allocations >= 4);
+
+			const MemoryStats stats = parsed.memory_stats();
+			REQUIRE(stats.total() == counting.live_bytes);
+			REQUIRE(stats.subcommands == sizeof(ParseResult) + parsed.get_subcommand()->memory_stats().total());
+			REQUIRE(stats.flags == 0);
+		}
+		REQUIRE(counting.live_bytes == 0);
+		REQUIRE(ParseResult().memory_stats().total() == 0);
+	}
+
+	SECTION("A spec reports the definition it shares") {
+		const MemoryStats stats = spec.memory_stats();
+		REQUIRE(stats.flags > 0);
+		REQUIRE(stats.tables > 0);
+		REQUIRE(stats.values == 0);
+		REQUIRE(stats.subcommands > 0);
+		REQUIRE(ParserSpec(spec).memory_stats().total() == stats.total());
+	}
+
+	SECTION("Monotonic arena can be released between parses") {
+		CountingResource upstream;
+		std::pmr::monotonic_buffer_resource arena(&upstream);
+
+		for (int i = 0; i < 3; ++i) {
+			{
+				auto result = spec.parse(std::span<const std::string_view>(args), &arena);
+				REQUIRE(result.has_value());
+				REQUIRE(result.value().get<int>("port") == 80);
+			}
+			arena.release();
+			REQUIRE(upstream.live_bytes == 0);
+		}
+	}
+}
+
+TEST_CASE("ParseResult snapshots", "[spec]") {
+	Parser parser = make_parser();
+	parser.add_flag<int>("level", "Level").set_multi().set_default_value(7);
+	parser.add_flag<std::string>("tag", "Tag").set_multi();
+	parser.add_flag<std::chrono::milliseconds>("timeout", "Timeout");
+	const ParserSpec spec = parser.freeze();
+
+	auto snapshot = [](const ParseResult &result) {
+		std::vector<std::byte> bytes(result.serialized_size());
+		auto written = result.serialize(bytes);
+		REQUIRE(written.has_value());
+		REQUIRE(written.value() == bytes.size());
+		return bytes;
+	};
+
+	SECTION("Values and the subcommand path round-trip") {
+		auto result = spec.parse(std::vector<std::string>{"--host", "example.com", "--tag", "a", "--tag", "b", "--timeout", "250ms", "-v", "build", "--target", "release", "4"});
+		REQUIRE(result.has_value());
+		const auto bytes = snapshot(result.value());
+
+		auto view = ParseResultView::from_bytes(spec, bytes);
+		REQUIRE(view.has_value());
+		const auto &root = view.value();
+		REQUIRE(root.get<std::string_view>("host") == "example.com");
+		REQUIRE(root.get<std::string>("host") == "example.com");
+		REQUIRE(root.get<int>("port") == 80);
+		REQUIRE(root.get<bool>("verbose") == true);
+		REQUIRE(root.get<std::chrono::milliseconds>("timeout") == std::chrono::milliseconds(250));
+		REQUIRE(root.count("tag") == 2);
+		REQUIRE(root.get_at<std::string_view>("tag", 0) == "a");
+		REQUIRE(root.get<std::string>("tag") == "b");
+		REQUIRE(root.get_all<int>("level").size() == 1);
+		REQUIRE(root.get_all<int>("level")[0] == 7);
+		REQUIRE_FALSE(root.get<int>("host").has_value());
+		REQUIRE_FALSE(root.get_positional<std::string>(0).has_value());
+
+		REQUIRE(root.get_selected_subcommand() == "build");
+		const auto build = root.get_subcommand();
+		REQUIRE(build.has_value());
+		REQUIRE(build->get<std::string>("target") == "release");
+		REQUIRE(build->get_positional<int>("jobs") == 4);
+		REQUIRE_FALSE(build->get_subcommand().has_value());
+	}
+
+	SECTION("Repeatable raw values are viewed in place") {
+		auto result = spec.parse(std::vector<std::string>{"--host", "h", "--level", "1", "--level", "2,3"});
+		REQUIRE(result.has_value());
+		const auto bytes = snapshot(result.value());
+
+		auto view = ParseResultView::from_bytes(spec, bytes);
+		REQUIRE(view.has_value());
+		const auto levels = view.value().get_all<int>("level");
+		REQUIRE(levels.size() == 3);
+		REQUIRE(levels[2] == 3);
+		REQUIRE(reinterpret_cast<const std::byte *>(levels.data()) > bytes.data());
+		REQUIRE(reinterpret_cast<const std::byte *>(levels.data()) < bytes.data() + bytes.size());
+	}
+
+	SECTION("Snapshots from another definition or damaged bytes are rejected") {
+		auto result = spec.parse(std::vector<std::string>{"--host", "h", "in.txt"});
+		REQUIRE(result.has_value());
+		auto bytes = snapshot(result.value());
+
+		Parser other = make_parser();
+		other.add_flag<int>("extra", "Extra");
+		REQUIRE(other.freeze().hash() != spec.hash());
+		REQUIRE(make_parser().freeze().hash() != spec.hash());
+		REQUIRE(ParseResultView::from_bytes(other.freeze(), bytes).error().code() == ErrorCode::SnapshotError);
+
+		REQUIRE_FALSE(ParseResultView::from_bytes(spec, std::span<const std::byte>(bytes).first(bytes.size() - 16)).has_value());
+		bytes[0] = std::byte{0};
+		REQUIRE_FALSE(ParseResultView::from_bytes(spec, bytes).has_value());
+	}
+
+	SECTION("A buffer that is too small is an error") {
+		auto result = spec.parse(std::vector<std::string>{"--host", "h"});
+		REQUIRE(result.has_value());
+		std::vector<std::byte> bytes(result.value().serialized_size() - 1);
+		auto written = result.value().serialize(bytes);
+		REQUIRE_FALSE(written.has_value());
+		REQUIRE(written.error().code() == ErrorCode::SnapshotError);
+		REQUIRE_FALSE(ParseResult().serialize(bytes).has_value());
+	}
+}
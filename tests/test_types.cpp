@@ -1,8 +1,14 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
+#include <chrono>
 #include <cppli_types.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
 
 using namespace cli;
+using Catch::Matchers::ContainsSubstring;
 
 TEST_CASE("ValueConverter<std::string>", "[types][converter]") {
 	SECTION("Converts string successfully") {
@@ -99,6 +105,110 @@ TEST_CASE("ValueConverter<bool>", "[types][converter]") {
 	}
 }
 
+TEST_CASE("ValueConverter for other numeric types", "[types][converter]") {
+	SECTION("64-bit and size types use the full range") {
+		REQUIRE(ValueConverter<std::int64_t>::from_string("-9223372036854775808").value() == INT64_MIN);
+		REQUIRE(ValueConverter<std::uint64_t>::from_string("18446744073709551615").value() == UINT64_MAX);
+		REQUIRE(ValueConverter<std::size_t>::from_string("4096").value() == 4096);
+	}
+
+	SECTION("Rejects signs on unsigned types, overflow and trailing characters") {
+		REQUIRE_FALSE(ValueConverter<std::uint64_t>::from_string("-1").has_value());
+		REQUIRE_FALSE(ValueConverter<std::int64_t>::from_string("9223372036854775808").has_value());
+		auto trailing = ValueConverter<std::uint32_t>::from_string("12abc");
+		REQUIRE_FALSE(trailing.has_value());
+		REQUIRE(trailing.error().code() == ErrorCode::InvalidFlagValue);
+	}
+
+	SECTION("Float parses and renders the shortest form") {
+		REQUIRE(ValueConverter<float>::from_string("0.5").value() == 0.5f);
+		REQUIRE(ValueConverter<float>::to_string(0.1f) == "0.1");
+		REQUIRE(ValueConverter<std::uint64_t>::to_string(42) == "42");
+	}
+}
+
+TEST_CASE("ValueConverter<std::chrono::duration>", "[types][converter]") {
+	using namespace std::chrono_literals;
+
+	SECTION("Accepts units, compound values and fractions") {
+		REQUIRE(ValueConverter<std::chrono::milliseconds>::from_string("250ms").value() == 250ms);
+		REQUIRE(ValueConverter<std::chrono::seconds>::from_string("5m").value() == 300s);
+		REQUIRE(ValueConverter<std::chrono::minutes>::from_string("1h30m").value() == 90min);
+		REQUIRE(ValueConverter<std::chrono::milliseconds>::from_string("1.5s").value() == 1500ms);
+		REQUIRE(ValueConverter<std::chrono::nanoseconds>::from_string("-2us").value() == -2000ns);
+	}
+
+	SECTION("A bare number is in the duration's own unit") {
+		REQUIRE(ValueConverter<std::chrono::seconds>::from_string("30").value() == 30s);
+		REQUIRE(ValueConverter<std::chrono::milliseconds>::from_string("30").value() == 30ms);
+	}
+
+	SECTION("Rejects unknown units, missing units and overflow") {
+		REQUIRE_FALSE(ValueConverter<std::chrono::seconds>::from_string("5 parsecs").has_value());
+		REQUIRE_FALSE(ValueConverter<std::chrono::seconds>::from_string("1h30").has_value());
+		REQUIRE_FALSE(ValueConverter<std::chrono::seconds>::from_string("ms").has_value());
+		REQUIRE_FALSE(ValueConverter<std::chrono::nanoseconds>::from_string("400000d").has_value());
+		REQUIRE_FALSE(ValueConverter<std::chrono::duration<std::int8_t>>::from_string("1000s").has_value());
+	}
+
+	SECTION("Renders with the unit suffix") {
+		REQUIRE(ValueConverter<std::chrono::milliseconds>::to_string(250ms) == "250ms");
+		REQUIRE(ValueConverter<std::chrono::hours>::to_string(2h) == "2h");
+	}
+}
+
+TEST_CASE("ValueConverter<ByteSize>", "[types][converter]") {
+	SECTION("Binary, SI and bare sizes") {
+		REQUIRE(ValueConverter<ByteSize>::from_string("4GiB").value().bytes == 4ULL << 30);
+		REQUIRE(ValueConverter<ByteSize>::from_string("512k").value().bytes == 512 * 1024);
+		REQUIRE(ValueConverter<ByteSize>::from_string("10MB").value().bytes == 10'000'000);
+		REQUIRE(ValueConverter<ByteSize>::from_string("1.5KiB").value().bytes == 1536);
+		REQUIRE(ValueConverter<ByteSize>::from_string("100").value().bytes == 100);
+	}
+
+	SECTION("Rejects unknown units and overflow") {
+		REQUIRE_FALSE(ValueConverter<ByteSize>::from_string("4 lightyears").has_value());
+		REQUIRE_FALSE(ValueConverter<ByteSize>::from_string("GiB").has_value());
+		REQUIRE_FALSE(ValueConverter<ByteSize>::from_string("20EiB").has_value());
+	}
+
+	SECTION("Renders in the largest exact binary unit") {
+		REQUIRE(ValueConverter<ByteSize>::to_string(ByteSize{4ULL << 30}) == "4GiB");
+		REQUIRE(ValueConverter<ByteSize>::to_string(ByteSize{1000}) == "1000");
+	}
+}
+
+TEST_CASE("ValueConverter<std::vector<T>> numeric lists", "[types][converter]") {
+	SECTION("Parses a large list in one pass") {
+		std::string ids;
+		for (int i = 0; i < 100'000; ++i) {
+			if (i > 0) {
+				ids += ',';
+			}
+			ids += std::to_string(i);
+		}
+
+		auto result = ValueConverter<std::vector<std::uint32_t>>::from_string(ids);
+		REQUIRE(result.has_value());
+		REQUIRE(result.value().size() == 100'000);
+		REQUIRE(result.value().back() == 99'999);
+	}
+
+	SECTION("Empty string is an empty list; empty or bad elements fail") {
+		REQUIRE(ValueConverter<std::vector<int>>::from_string("").value().empty());
+		REQUIRE_FALSE(ValueConverter<std::vector<int>>::from_string("1,,2").has_value());
+		REQUIRE_FALSE(ValueConverter<std::vector<int>>::from_string("1,2,").has_value());
+		REQUIRE_FALSE(ValueConverter<std::vector<int>>::from_string("1,x").has_value());
+	}
+
+	SECTION("Works as a flag type") {
+		TypedFlag<std::vector<double>> flag("weights", "Weights");
+		REQUIRE(flag.set_value_from_string("0.5,1.25").has_value());
+		REQUIRE(flag.value()->size() == 2);
+		REQUIRE(ValueConverter<std::vector<double>>::to_string(*flag.value()) == "0.5,1.25");
+	}
+}
+
 TEST_CASE("TypedFlag basic operations", "[types][flag]") {
 	SECTION("Create flag with name and description") {
 		TypedFlag<std::string> flag("output", "Output file");
@@ -182,6 +292,53 @@ TEST_CASE("TypedFlag validation with choices", "[types][flag]") {
 		REQUIRE_FALSE(result.has_value());
 		REQUIRE(result.error().code() == ErrorCode::ValidationFailed);
 	}
+
+	SECTION("Large choice sets are looked up through the hash index") {
+		std::vector<std::string> regions;
+		for (int i = 0; i < 900; ++i) {
+			regions.push_back("region-" + std::to_string(i));
+		}
+		TypedFlag<std::string> flag("region", "Region");
+		flag.set_choices(regions);
+
+		REQUIRE(flag.set_value_from_string("region-0").has_value());
+		REQUIRE(flag.set_value_from_string("region-899").has_value());
+		REQUIRE_FALSE(flag.set_value_from_string("region-900").has_value());
+
+		TypedFlag<int> ports("port", "Port");
+		ports.set_choices({80, 443, 8080, 8443, 3000, 5000, 6000, 7000, 9000, 9090});
+		REQUIRE(ports.parse_value("9090").has_value());
+		REQUIRE_FALSE(ports.parse_value("22").has_value());
+	}
+}
+
+namespace {
+	enum class Level { Low, Medium, High };
+}
+
+TEST_CASE("TypedFlag enum choices", "[types][flag]") {
+	TypedFlag<Level> flag("level", "Level");
+	flag.set_choices<Level>({{"low", Level::Low}, {"medium", Level::Medium}, {"high", Level::High}});
+
+	SECTION("Names parse straight to the enum value") {
+		REQUIRE(flag.set_value_from_string("medium").has_value());
+		REQUIRE(flag.value() == Level::Medium);
+		REQUIRE(flag.parse_value("high").value() == Level::High);
+		REQUIRE(flag.choices().size() == 3);
+		REQUIRE(flag.choice_name(Level::Low) == "low");
+	}
+
+	SECTION("Unknown names fail validation") {
+		auto result = flag.set_value_from_string("2");
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::ValidationFailed);
+	}
+
+	SECTION("Without a mapping an enum parses its underlying value") {
+		TypedFlag<Level> numeric("level", "Level");
+		REQUIRE(numeric.set_value_from_string("2").has_value());
+		REQUIRE(numeric.value() == Level::High);
+	}
 }
 
 TEST_CASE("TypedFlag custom validation", "[types][flag]") {
@@ -212,6 +369,70 @@ TEST_CASE("TypedFlag custom validation", "[types][flag]") {
 	}
 }
 
+TEST_CASE("Built-in validators", "[types][validators]") {
+	static_assert(range<1, 65535>.reject(80) == nullptr);
+	static_assert(std::string_view(range<1, 65535>.reject(0)).ends_with("must be in [1, 65535]"));
+	static_assert((range<1, 1024> && power_of_two).reject(512) == nullptr);
+	static_assert(one_of<"fast", "safe">.reject(std::string_view("safe")) == nullptr);
+
+	SECTION("range reports its bounds") {
+		TypedFlag<int> flag("port", "Port number");
+		flag.set_validator(range<1, 65535>);
+		REQUIRE(flag.set_value_from_string("8080").has_value());
+
+		auto result = flag.set_value_from_string("0");
+		REQUIRE_FALSE(result.has_value());
+		REQUIRE(result.error().code() == ErrorCode::ValidationFailed);
+		REQUIRE(result.error().message() == "Validation failed for port: must be in [1, 65535]");
+	}
+
+	SECTION("Negative bounds") {
+		TypedFlag<int> flag("offset", "Offset");
+		flag.set_validator(range<-10, 10>);
+		REQUIRE(flag.set_value_from_string("-10").has_value());
+		REQUIRE(flag.set_value_from_string("-11").error().message() == "Validation failed for offset: must be in [-10, 10]");
+	}
+
+	SECTION("Composed validators report the first rejection") {
+		TypedFlag<std::size_t> flag("block", "Block size");
+		flag.set_validator(range<512, 65536> && power_of_two);
+		REQUIRE(flag.set_value_from_string("4096").has_value());
+		REQUIRE_THAT(flag.set_value_from_string("256").error().message(), ContainsSubstring("must be in [512, 65536]"));
+		REQUIRE_THAT(flag.set_value_from_string("1000").error().message(), ContainsSubstring("must be a power of two"));
+	}
+
+	SECTION("one_of and non_empty on strings") {
+		TypedFlag<std::string> mode("mode", "Mode");
+		mode.set_validator(one_of<"fast", "safe">);
+		REQUIRE(mode.set_value_from_string("fast").has_value());
+		REQUIRE(mode.set_value_from_string("slow").error().code() == ErrorCode::ValidationFailed);
+
+		TypedPositional<std::string> file("file", "Input file");
+		file.set_validator(non_empty);
+		REQUIRE(file.set_value_from_string("a.txt").has_value());
+		REQUIRE(file.parse_value("").error().message() == "Validation failed for file: must not be empty");
+	}
+
+	SECTION("one_of on integers") {
+		TypedFlag<int> level("level", "Level");
+		level.set_validator(one_of<1, 2, 3>);
+		REQUIRE(level.set_value_from_string("2").has_value());
+		REQUIRE_FALSE(level.set_value_from_string("4").has_value());
+	}
+
+	SECTION("A later set_validator replaces the earlier one") {
+		TypedFlag<int> flag("port", "Port number");
+		flag.set_validator(range<1, 10>);
+		flag.set_validator([](const int &) {
+			return Result<void>::ok();
+		});
+		REQUIRE(flag.set_value_from_string("80").has_value());
+
+		flag.set_validator(range<1, 10>);
+		REQUIRE_FALSE(flag.set_value_from_string("80").has_value());
+	}
+}
+
 TEST_CASE("TypedPositional operations", "[types][positional]") {
 	SECTION("Create positional argument") {
 		TypedPositional<std::string> pos("filename", "Input file", true);